@@ -0,0 +1,553 @@
+/*
+cl_browser.c - paced server browser queries
+Copyright (C) 2026 Xash3D FWGS contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+*/
+
+#include "common.h"
+#include "client.h"
+
+#define BROWSER_HASH_SIZE	1024	// must be power of two
+
+static CVAR_DEFINE_AUTO( cl_browser_rate, "200", FCVAR_ARCHIVE, "server browser queries per second after the first burst, 0 to send all at once" );
+static CVAR_DEFINE_AUTO( cl_browser_burst, "128", FCVAR_ARCHIVE, "server browser queries sent at once when server list arrives, menu pings of them are exact" );
+static CVAR_DEFINE_AUTO( cl_browser_timeout, "1.5", FCVAR_ARCHIVE, "time to wait for server browser query reply" );
+static CVAR_DEFINE_AUTO( cl_browser_retries, "2", FCVAR_ARCHIVE, "how many times resend lost server browser query" );
+
+typedef enum
+{
+	BS_QUEUED = 0,
+	BS_INFLIGHT,
+	BS_REPLIED,
+	BS_LOST,
+} browserstate_t;
+
+typedef struct
+{
+	netadr_t	adr;
+	browserstate_t	state;
+	qboolean	legacy;		// server asked for legacy protocol
+	int	tries;
+	int	lastsend;		// index of last query in sends
+	double	timesend;		// last query time
+	double	ping;
+	int	hashnext;		// -1 is end of chain
+} browserserver_t;
+
+typedef struct
+{
+	int	server;
+	double	timesend;
+} browsersend_t;
+
+static struct
+{
+	browserserver_t	*servers;
+	int		numservers;
+	int		maxservers;
+	int		hash[BROWSER_HASH_SIZE];
+
+	// servers waiting for a query, retries go here too
+	int		*queue;
+	int		queuehead;
+	int		numqueue;
+	int		maxqueue;
+
+	// sent queries in time order, for timeout checks
+	browsersend_t	*sends;
+	int		sendhead;
+	int		numsends;
+	int		maxsends;
+
+	qboolean		started;
+	double		tokens;
+	double		lasttime;
+	double		starttime;
+	double		endtime;
+
+	int		numinflight;
+	int		numreplied;
+	int		numlost;
+	int		numretries;
+	int		numdups;
+	double		pingtotal;
+	double		pingmin;
+	double		pingmax;
+
+	void		(*pfnSendQuery)( const netadr_t *adr, qboolean legacy );
+} browser;
+
+static void CL_BrowserSendQuery( const netadr_t *adr, qboolean legacy )
+{
+	Netchan_OutOfBandPrint( NS_CLIENT, *adr, A2A_INFO" %i", legacy ? PROTOCOL_LEGACY_VERSION : PROTOCOL_VERSION );
+}
+
+static uint CL_BrowserHashAdr( const netadr_t *adr )
+{
+	return COM_HashKey( NET_AdrToString( *adr ), BROWSER_HASH_SIZE );
+}
+
+static browserserver_t *CL_BrowserFindServer( const netadr_t *adr )
+{
+	int i;
+
+	for( i = browser.hash[CL_BrowserHashAdr( adr )]; i != -1; i = browser.servers[i].hashnext )
+	{
+		if( NET_CompareAdr( browser.servers[i].adr, *adr ))
+			return &browser.servers[i];
+	}
+
+	return NULL;
+}
+
+static void CL_BrowserEnqueue( int server )
+{
+	if( browser.numqueue == browser.maxqueue )
+	{
+		browser.maxqueue = Q_max( 256, browser.maxqueue * 2 );
+		browser.queue = Mem_Realloc( host.mempool, browser.queue, sizeof( *browser.queue ) * browser.maxqueue );
+	}
+
+	browser.queue[browser.numqueue++] = server;
+}
+
+static void CL_BrowserQuery( int server, double time )
+{
+	browserserver_t *s = &browser.servers[server];
+	browsersend_t *send;
+
+	if( browser.numsends == browser.maxsends )
+	{
+		browser.maxsends = Q_max( 256, browser.maxsends * 2 );
+		browser.sends = Mem_Realloc( host.mempool, browser.sends, sizeof( *browser.sends ) * browser.maxsends );
+	}
+
+	s->lastsend = browser.numsends;
+	send = &browser.sends[browser.numsends++];
+	send->server = server;
+	send->timesend = time;
+
+	if( s->state != BS_INFLIGHT )
+		browser.numinflight++;
+
+	s->state = BS_INFLIGHT;
+	s->timesend = time;
+	s->tries++;
+
+	browser.pfnSendQuery( &s->adr, s->legacy );
+}
+
+/*
+=================
+CL_BrowserReset
+
+forget previous refresh, called before master server request
+=================
+*/
+void CL_BrowserReset( void )
+{
+	int i;
+
+	browser.numservers = 0;
+	browser.queuehead = browser.numqueue = 0;
+	browser.sendhead = browser.numsends = 0;
+	browser.numinflight = browser.numreplied = browser.numlost = 0;
+	browser.numretries = browser.numdups = 0;
+	browser.pingtotal = browser.pingmin = browser.pingmax = 0.0;
+	browser.started = false;
+
+	for( i = 0; i < BROWSER_HASH_SIZE; i++ )
+		browser.hash[i] = -1;
+}
+
+/*
+=================
+CL_BrowserAddServer
+
+queue server from master server list, duplicates are skipped
+=================
+*/
+void CL_BrowserAddServer( netadr_t adr )
+{
+	browserserver_t *s;
+	uint hash;
+
+	if( CL_BrowserFindServer( &adr ))
+	{
+		browser.numdups++;
+		return;
+	}
+
+	if( browser.numservers == browser.maxservers )
+	{
+		browser.maxservers = Q_max( 256, browser.maxservers * 2 );
+		browser.servers = Mem_Realloc( host.mempool, browser.servers, sizeof( *browser.servers ) * browser.maxservers );
+	}
+
+	// more servers may come after all previous were queried
+	browser.endtime = 0.0;
+
+	hash = CL_BrowserHashAdr( &adr );
+	s = &browser.servers[browser.numservers];
+	memset( s, 0, sizeof( *s ));
+	s->adr = adr;
+	s->state = BS_QUEUED;
+	s->hashnext = browser.hash[hash];
+	browser.hash[hash] = browser.numservers;
+
+	CL_BrowserEnqueue( browser.numservers++ );
+}
+
+static void CL_BrowserPrintStats( void )
+{
+	int replied = browser.numreplied;
+
+	Con_Printf( "%i servers, %i replied, %i lost, %i in flight, %i queued\n",
+		browser.numservers, replied, browser.numlost, browser.numinflight, browser.numqueue - browser.queuehead );
+	Con_Printf( "%i queries, %i retries, %i duplicates skipped\n",
+		browser.numsends, browser.numretries, browser.numdups );
+
+	if( replied )
+	{
+		Con_Printf( "ping min %.f avg %.f max %.f ms\n", browser.pingmin * 1000.0,
+			browser.pingtotal / replied * 1000.0, browser.pingmax * 1000.0 );
+	}
+
+	if( browser.endtime )
+		Con_Printf( "refresh took %.2f seconds\n", browser.endtime - browser.starttime );
+}
+
+/*
+=================
+CL_BrowserRun
+
+send queued queries within rate budget and resend lost ones
+=================
+*/
+static void CL_BrowserRun( double time )
+{
+	double timeout = Q_max( 0.1f, cl_browser_timeout.value );
+	double burst = Q_max( 1.0f, cl_browser_rate.value * 0.25f );
+	int maxtries = Q_max( 0, cl_browser_retries.value ) + 1;
+
+	if( !browser.numservers || browser.endtime )
+		return;
+
+	if( !browser.started )
+	{
+		// first queries of this refresh go in one burst, so menu
+		// measures their pings from the right time
+		browser.started = true;
+		browser.starttime = browser.lasttime = time;
+		browser.tokens = Q_max( burst, cl_browser_burst.value );
+	}
+
+	// check for lost replies, queries are sent with same timeout,
+	// so they expire in order
+	while( browser.sendhead < browser.numsends )
+	{
+		browsersend_t *send = &browser.sends[browser.sendhead];
+		browserserver_t *s = &browser.servers[send->server];
+
+		if( send->timesend + timeout > time )
+			break;
+
+		browser.sendhead++;
+
+		// replied already, or resent later
+		if( s->state != BS_INFLIGHT || s->lastsend != browser.sendhead - 1 )
+			continue;
+
+		browser.numinflight--;
+
+		if( s->tries < maxtries )
+		{
+			s->state = BS_QUEUED;
+			browser.numretries++;
+			CL_BrowserEnqueue( send->server );
+		}
+		else
+		{
+			s->state = BS_LOST;
+			browser.numlost++;
+		}
+	}
+
+	if( cl_browser_rate.value > 0.0f )
+	{
+		// unused part of the first burst is kept
+		if( browser.tokens < burst )
+			browser.tokens = Q_min( browser.tokens + ( time - browser.lasttime ) * cl_browser_rate.value, burst );
+	}
+	else browser.tokens = browser.numqueue - browser.queuehead;
+
+	browser.lasttime = time;
+
+	while( browser.queuehead < browser.numqueue && browser.tokens >= 1.0 )
+	{
+		int server = browser.queue[browser.queuehead++];
+
+		// late reply came while waiting for retry
+		if( browser.servers[server].state != BS_QUEUED )
+			continue;
+
+		CL_BrowserQuery( server, time );
+		browser.tokens -= 1.0;
+	}
+
+	if( browser.queuehead == browser.numqueue && !browser.numinflight )
+	{
+		browser.endtime = time;
+		Con_Reportf( "Server browser: %i of %i servers replied in %.2f seconds, %i retries\n",
+			browser.numreplied, browser.numservers, browser.endtime - browser.starttime, browser.numretries );
+	}
+}
+
+void CL_BrowserFrame( void )
+{
+	CL_BrowserRun( host.realtime );
+}
+
+static qboolean CL_BrowserReplyTime( netadr_t from, double time )
+{
+	browserserver_t *s = CL_BrowserFindServer( &from );
+	double ping;
+
+	if( !s || s->state == BS_REPLIED )
+		return false;
+
+	// late reply to query we considered lost
+	if( s->state == BS_LOST )
+		browser.numlost--;
+	else if( s->state == BS_INFLIGHT )
+		browser.numinflight--;
+
+	ping = time - s->timesend;
+
+	if( !browser.numreplied || ping < browser.pingmin )
+		browser.pingmin = ping;
+	if( ping > browser.pingmax )
+		browser.pingmax = ping;
+
+	browser.pingtotal += ping;
+	browser.numreplied++;
+
+	s->state = BS_REPLIED;
+	s->ping = ping;
+
+	return true;
+}
+
+/*
+=================
+CL_BrowserReply
+
+mark server as replied, unknown servers are ignored
+=================
+*/
+void CL_BrowserReply( netadr_t from )
+{
+	CL_BrowserReplyTime( from, host.realtime );
+}
+
+/*
+=================
+CL_BrowserResendLegacy
+
+server doesn't know our protocol, ask again with legacy one
+=================
+*/
+void CL_BrowserResendLegacy( netadr_t from )
+{
+	browserserver_t *s = CL_BrowserFindServer( &from );
+
+	if( !s || s->state != BS_INFLIGHT || s->legacy )
+	{
+		CL_BrowserSendQuery( &from, true );
+		return;
+	}
+
+	s->legacy = true;
+	s->tries = 0;
+	CL_BrowserQuery( s - browser.servers, host.realtime );
+}
+
+static void CL_BrowserStats_f( void )
+{
+	if( !browser.numservers )
+	{
+		Con_Printf( "no internet servers refresh was made\n" );
+		return;
+	}
+
+	CL_BrowserPrintStats();
+}
+
+void CL_InitServerBrowser( void )
+{
+	Cvar_RegisterVariable( &cl_browser_rate );
+	Cvar_RegisterVariable( &cl_browser_burst );
+	Cvar_RegisterVariable( &cl_browser_timeout );
+	Cvar_RegisterVariable( &cl_browser_retries );
+
+	Cmd_AddCommand( "browser_stats", CL_BrowserStats_f, "print last internet servers refresh statistics" );
+
+	browser.pfnSendQuery = CL_BrowserSendQuery;
+	CL_BrowserReset();
+}
+
+#if XASH_ENGINE_TESTS
+#include "tests.h"
+
+#define TEST_SERVERS	300
+
+static double test_browser_time;
+static int test_browser_queries[TEST_SERVERS];
+static double test_browser_replies[TEST_SERVERS];
+static double test_browser_sends[TEST_SERVERS * 4];
+static int test_browser_numsends;
+
+static void Test_BrowserServerAdr( netadr_t *adr, int i )
+{
+	memset( adr, 0, sizeof( *adr ));
+	NET_NetadrSetType( adr, NA_IP );
+	adr->ip[0] = 10;
+	adr->ip[2] = i >> 8;
+	adr->ip[3] = i & 0xff;
+	adr->port = MSG_BigShort( PORT_SERVER );
+}
+
+// fake server: some lose first query, some never reply
+static void Test_BrowserSendQuery( const netadr_t *adr, qboolean legacy )
+{
+	int i = adr->ip[2] << 8 | adr->ip[3];
+	int tries = ++test_browser_queries[i];
+
+	test_browser_sends[test_browser_numsends++] = test_browser_time;
+
+	if( i % 10 == 7 )
+		return;
+
+	if( i % 10 == 3 && tries == 1 )
+		return;
+
+	test_browser_replies[i] = test_browser_time + 0.02 + ( i % 7 ) * 0.01;
+}
+
+static void Test_ServerBrowser( void )
+{
+	int i, j, numdrops = 0, numdead = 0, maxwindow = 0, numfirst = 0;
+	float oldrate = cl_browser_rate.value;
+	float oldburst = cl_browser_burst.value;
+	float oldtimeout = cl_browser_timeout.value;
+	float oldretries = cl_browser_retries.value;
+	netadr_t adr;
+
+	cl_browser_rate.value = 100;
+	cl_browser_burst.value = 64;
+	cl_browser_timeout.value = 0.5f;
+	cl_browser_retries.value = 2;
+	browser.pfnSendQuery = Test_BrowserSendQuery;
+	test_browser_time = 0.0;
+	test_browser_numsends = 0;
+	memset( test_browser_queries, 0, sizeof( test_browser_queries ));
+	memset( test_browser_replies, 0, sizeof( test_browser_replies ));
+
+	CL_BrowserReset();
+
+	// two masters send overlapping lists
+	for( i = 0; i < TEST_SERVERS; i++ )
+	{
+		Test_BrowserServerAdr( &adr, i );
+		CL_BrowserAddServer( adr );
+	}
+
+	for( i = 0; i < TEST_SERVERS; i += 2 )
+	{
+		Test_BrowserServerAdr( &adr, i );
+		CL_BrowserAddServer( adr );
+	}
+
+	TASSERT_EQi( browser.numservers, TEST_SERVERS );
+	TASSERT_EQi( browser.numdups, TEST_SERVERS / 2 );
+
+	for( ; test_browser_time < 20.0 && !browser.endtime; test_browser_time += 0.01 )
+	{
+		for( i = 0; i < TEST_SERVERS; i++ )
+		{
+			if( test_browser_replies[i] && test_browser_replies[i] <= test_browser_time )
+			{
+				Test_BrowserServerAdr( &adr, i );
+				TASSERT( CL_BrowserReplyTime( adr, test_browser_time ));
+				test_browser_replies[i] = 0.0;
+			}
+		}
+
+		CL_BrowserRun( test_browser_time );
+	}
+
+	TASSERT( browser.endtime != 0.0 );
+
+	for( i = 0; i < TEST_SERVERS; i++ )
+	{
+		if( i % 10 == 7 )
+		{
+			TASSERT_EQi( test_browser_queries[i], 3 );
+			numdead++;
+		}
+		else if( i % 10 == 3 )
+		{
+			TASSERT_EQi( test_browser_queries[i], 2 );
+			numdrops++;
+		}
+		else TASSERT_EQi( test_browser_queries[i], 1 );
+	}
+
+	TASSERT_EQi( browser.numreplied, TEST_SERVERS - numdead );
+	TASSERT_EQi( browser.numlost, numdead );
+	TASSERT_EQi( browser.numinflight, 0 );
+	TASSERT_EQi( browser.numretries, numdrops + numdead * 2 );
+	TASSERT_EQi( browser.numsends, test_browser_numsends );
+	TASSERT( browser.pingmin >= 0.02 - 0.001 );
+	TASSERT( browser.pingmax <= 0.08 + 0.011 );
+
+	// first burst goes out with the list
+	for( i = 0; i < test_browser_numsends && test_browser_sends[i] == 0.0; i++ )
+		numfirst++;
+	TASSERT_EQi( numfirst, 64 );
+
+	// no more than rate plus first burst in any second
+	for( i = 0; i < test_browser_numsends; i++ )
+	{
+		for( j = i; j < test_browser_numsends && test_browser_sends[j] < test_browser_sends[i] + 1.0 - 0.001; j++ );
+		maxwindow = Q_max( maxwindow, j - i );
+	}
+	TASSERT( maxwindow <= 100 + 64 );
+	TASSERT( maxwindow >= 100 );
+
+	// unknown server reply is ignored
+	Test_BrowserServerAdr( &adr, TEST_SERVERS + 1 );
+	TASSERT( !CL_BrowserReplyTime( adr, test_browser_time ));
+
+	cl_browser_rate.value = oldrate;
+	cl_browser_burst.value = oldburst;
+	cl_browser_timeout.value = oldtimeout;
+	cl_browser_retries.value = oldretries;
+	browser.pfnSendQuery = CL_BrowserSendQuery;
+	CL_BrowserReset();
+}
+
+void Test_RunServerBrowser( void )
+{
+	TRUN( Test_ServerBrowser() );
+}
+#endif /* XASH_ENGINE_TESTS */
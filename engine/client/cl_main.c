@@ -1806,6 +1806,7 @@ static void CL_InternetServers_f( void )
 	Con_Printf( "Scanning for servers on the internet area...\n" );
 
 	NET_Config( true, true ); // allow remote
+	CL_BrowserReset();
 
 	CL_SendMasterServerScanRequest();
 }
@@ -1967,10 +1968,12 @@ static void CL_ParseStatusMessage( netadr_t from, sizebuf_t *msg )
 
 	if( len >= magiclen && !Q_strcmp( s + len - magiclen, magic ))
 	{
-		Netchan_OutOfBandPrint( NS_CLIENT, from, A2A_INFO" %i", PROTOCOL_LEGACY_VERSION );
+		CL_BrowserResendLegacy( from );
 		return;
 	}
 
+	CL_BrowserReply( from );
+
 	if( !Info_IsValid( s ))
 	{
 		Con_Printf( "^1Server^7: %s, invalid infostring\n", NET_AdrToString( from ));
@@ -2016,6 +2019,8 @@ static void CL_ParseGoldSrcStatusMessage( netadr_t from, sizebuf_t *msg )
 	connprotocol_t proto;
 	char *replace;
 
+	CL_BrowserReply( from );
+
 	// set to beginning but skip header
 	MSG_SeekToBit( msg, (sizeof( uint32_t ) + sizeof( uint8_t )) << 3, SEEK_SET );
 
@@ -2465,7 +2470,9 @@ static void CL_ServerList( netadr_t from, sizebuf_t *msg )
 		return;
 	}
 
-	// serverlist got from masterserver
+	NET_Config( true, false ); // allow remote
+
+	// serverlist got from masterserver, queries are sent by browser
 	while( MSG_GetNumBitsLeft( msg ) > 8 )
 	{
 		uint8_t addr[16];
@@ -2488,10 +2495,12 @@ static void CL_ServerList( netadr_t from, sizebuf_t *msg )
 		if( !servadr.port )
 			break;
 
-		NET_Config( true, false ); // allow remote
-		Netchan_OutOfBandPrint( NS_CLIENT, servadr, A2A_INFO" %i", PROTOCOL_VERSION );
+		CL_BrowserAddServer( servadr );
 	}
 
+	// send first burst right now
+	CL_BrowserFrame();
+
 	if( cls.internetservers_pending )
 	{
 		UI_ResetPing();
@@ -2734,6 +2743,9 @@ static void CL_ReadNetMessage( void )
 
 	// check requests for time-expire
 	CL_ProcessNetRequests();
+
+	// pace server browser queries
+	CL_BrowserFrame();
 }
 
 /*
@@ -2757,6 +2769,7 @@ static void CL_ReadPackets( void )
 		cls.demotime += host.frametime;
 
 	CL_ReadNetMessage();
+	CL_UpdateNetgraphStats();
 
 	CL_ApplyAddAngle();
 #if 0
@@ -3456,6 +3469,7 @@ static void CL_InitLocal( void )
 	Cmd_AddRestrictedCommand( "localservers", CL_LocalServers_f, "collect info about local servers" );
 	Cmd_AddRestrictedCommand( "internetservers", CL_InternetServers_f, "collect info about internet servers" );
 	Cmd_AddRestrictedCommand( "ui_queryserver", CL_QueryServer_f, "query server info from console" );
+	CL_InitServerBrowser();
 	Cmd_AddCommand ("cd", CL_PlayCDTrack_f, "Play cd-track (not real cd-player of course)" );
 	Cmd_AddCommand ("mp3", CL_PlayCDTrack_f, "Play mp3-track (based on virtual cd-player)" );
 	Cmd_AddCommand ("waveplaylen", CL_WavePlayLen_f, "Get approximate length of wave file");
@@ -46,6 +46,37 @@ static struct packet_latency_t
 	int	choked;
 } netstat_packet_latency[NET_TIMINGS];
 
+// what every sequence adds to the running sums, to take it back once it leaves the window
+static struct packet_sample_t
+{
+	float	latency;	// ms
+	int	msgbytes;
+	byte	haslatency;
+	byte	lost;
+	byte	choked;
+} netstat_samples[MULTIPLAYER_BACKUP];
+
+// aggregates over the last CL_UPDATE_BACKUP incoming sequences, updated on sequence advance
+static struct netstat_s
+{
+	qboolean	initialized;
+	int	backup;		// CL_UPDATE_BACKUP the window was built for
+	int	sequence;		// last accounted incoming sequence
+	int	outgoing;		// last copied outgoing sequence
+
+	int	lost;
+	int	choked;
+	int	latency_count;	// over the last NUM_LATENCY_SAMPLES
+	double	latency_sum;
+	int	maxmsgbytes;
+	qboolean	maxmsgdirty;	// window maximum has left the window
+
+	// since the level start
+	uint	total_packets;
+	uint	total_lost;
+	uint	total_choked;
+} netstat;
+
 static struct cmdinfo_t
 {
 	float	cmd_lerp;
@@ -164,87 +195,218 @@ static void NetGraph_InitColors( void )
 
 /*
 ==========
-NetGraph_GetFrameData
+NetGraph_AddSequence
 
-get frame data info, like chokes, packet losses, also update graph, packet and cmdinfo
+account a new incoming sequence, evicting the one it replaces in the window
 ==========
 */
-static void NetGraph_GetFrameData( float *latency, int *latency_count )
+static void NetGraph_AddSequence( int sequence )
 {
-	int		i, choke_count = 0, loss_count = 0;
-	double		newtime = Sys_DoubleTime();
-	static double	nexttime = 0;
-	float		loss, choke;
+	const frame_t *f = cl.frames + ( sequence & CL_UPDATE_MASK );
+	struct packet_latency_t *p = netstat_packet_latency + ( sequence & NET_TIMINGS_MASK );
+	netbandwidthgraph_t *g = netstat_graph + ( sequence & NET_TIMINGS_MASK );
+	struct packet_sample_t *s = netstat_samples + ( sequence & CL_UPDATE_MASK );
+	const struct packet_sample_t *old = netstat_samples + (( sequence - NUM_LATENCY_SAMPLES ) & CL_UPDATE_MASK );
 
-	*latency_count = 0;
-	*latency = 0.0f;
+	if( old->haslatency )
+	{
+		netstat.latency_sum -= old->latency;
+		netstat.latency_count--;
+	}
 
-	if( newtime >= nexttime )
+	// the slot still holds the sequence that leaves the window
+	netstat.lost -= s->lost;
+	netstat.choked -= s->choked;
+
+	if( s->msgbytes && s->msgbytes >= netstat.maxmsgbytes )
+		netstat.maxmsgdirty = true;
+
+	memset( s, 0, sizeof( *s ));
+
+	p->choked = f->choked;
+	s->choked = f->choked ? 1 : 0;
+
+	if( !f->valid )
 	{
-		// soft fading of net peak usage
-		maxmsgbytes = Q_max( 0, maxmsgbytes - 50 );
-		nexttime = newtime + 0.05;
+		p->latency = 9998; // broken delta
+	}
+	else if( f->receivedtime == -1.0 )
+	{
+		p->latency = 9999; // dropped
+		s->lost = 1;
+	}
+	else if( f->receivedtime == -3.0 )
+	{
+		p->latency = 9997; // skipped
+	}
+	else
+	{
+		int frame_latency = Q_min( 1.0f, f->latency );
+		p->latency = (( frame_latency + 0.1f ) / 1.1f ) * ( net_graphheight.value - NETGRAPH_LERP_HEIGHT - 2 );
+
+		s->latency = 1000.0f * f->latency;
+		s->haslatency = true;
 	}
 
-	for( i = cls.netchan.incoming_sequence - CL_UPDATE_BACKUP + 1; i <= cls.netchan.incoming_sequence; i++ )
+	memcpy( g, &f->graphdata, sizeof( netbandwidthgraph_t ));
+	s->msgbytes = g->msgbytes;
+
+	netstat.lost += s->lost;
+	netstat.choked += s->choked;
+	netstat.total_lost += s->lost;
+	netstat.total_choked += s->choked;
+	netstat.total_packets++;
+
+	if( s->haslatency )
 	{
-		frame_t *f = cl.frames + ( i & CL_UPDATE_MASK );
-		struct packet_latency_t *p = netstat_packet_latency + ( i & NET_TIMINGS_MASK );
-		netbandwidthgraph_t *g = netstat_graph + ( i & NET_TIMINGS_MASK );
+		netstat.latency_sum += s->latency;
+		netstat.latency_count++;
+	}
 
-		p->choked = f->choked;
-		if( p->choked ) choke_count++;
+	// fp error shouldn't accumulate over a long session
+	if( !netstat.latency_count )
+		netstat.latency_sum = 0.0;
 
-		if( !f->valid )
-		{
-			p->latency = 9998; // broken delta
-		}
-		else if( f->receivedtime == -1.0 )
-		{
-			p->latency = 9999; // dropped
-			loss_count++;
-		}
-		else if( f->receivedtime == -3.0 )
-		{
-			p->latency = 9997; // skipped
-		}
-		else
-		{
-			int frame_latency = Q_min( 1.0f, f->latency );
-			p->latency = (( frame_latency + 0.1f ) / 1.1f ) * ( net_graphheight.value - NETGRAPH_LERP_HEIGHT - 2 );
+	if( s->msgbytes > netstat.maxmsgbytes )
+	{
+		netstat.maxmsgbytes = s->msgbytes;
+		netstat.maxmsgdirty = false;
+	}
+}
 
-			if( i > cls.netchan.incoming_sequence - NUM_LATENCY_SAMPLES )
-			{
-				(*latency) += 1000.0f * f->latency;
-				(*latency_count)++;
-			}
-		}
+/*
+==========
+CL_UpdateNetgraphStats
+
+bring the aggregates up to the current sequences, costs only the packets arrived since last call
+==========
+*/
+void CL_UpdateNetgraphStats( void )
+{
+	int	i, first;
+
+	if( cls.state != ca_active )
+	{
+		netstat.initialized = false;
+		return;
+	}
+
+	// new connection, backup change or a gap longer than the window
+	if( !netstat.initialized || netstat.backup != CL_UPDATE_BACKUP
+		|| cls.netchan.incoming_sequence < netstat.sequence
+		|| cls.netchan.incoming_sequence - netstat.sequence >= CL_UPDATE_BACKUP )
+	{
+		if( !netstat.initialized )
+			memset( &netstat, 0, sizeof( netstat ));
+
+		memset( netstat_samples, 0, sizeof( netstat_samples ));
+		netstat.lost = netstat.choked = 0;
+		netstat.latency_count = 0;
+		netstat.latency_sum = 0.0;
+		netstat.maxmsgbytes = 0;
+		netstat.maxmsgdirty = false;
+
+		netstat.initialized = true;
+		netstat.backup = CL_UPDATE_BACKUP;
+		netstat.sequence = cls.netchan.incoming_sequence - CL_UPDATE_BACKUP;
+		netstat.outgoing = cls.netchan.outgoing_sequence - CL_UPDATE_BACKUP;
+	}
+
+	for( i = netstat.sequence + 1; i <= cls.netchan.incoming_sequence; i++ )
+		NetGraph_AddSequence( i );
 
-		memcpy( g, &f->graphdata, sizeof( netbandwidthgraph_t ));
+	netstat.sequence = cls.netchan.incoming_sequence;
 
-		if( g->msgbytes > maxmsgbytes )
-			maxmsgbytes = g->msgbytes;
+	if( netstat.maxmsgdirty )
+	{
+		netstat.maxmsgbytes = 0;
+
+		for( i = 0; i < CL_UPDATE_BACKUP; i++ )
+			netstat.maxmsgbytes = Q_max( netstat.maxmsgbytes, netstat_samples[i].msgbytes );
+
+		netstat.maxmsgdirty = false;
 	}
 
-	if( maxmsgbytes > 1000 )
-		maxmsgbytes = 1000;
+	// the last command may be still filled when we are here, copy it again next time
+	first = Q_max( netstat.outgoing, cls.netchan.outgoing_sequence - CL_UPDATE_BACKUP + 1 );
 
-	for( i = cls.netchan.outgoing_sequence - CL_UPDATE_BACKUP + 1; i <= cls.netchan.outgoing_sequence; i++ )
+	for( i = first; i <= cls.netchan.outgoing_sequence; i++ )
 	{
 		netstat_cmdinfo[i & NET_TIMINGS_MASK].cmd_lerp = cl.commands[i & CL_UPDATE_MASK].frame_lerp;
 		netstat_cmdinfo[i & NET_TIMINGS_MASK].sent = cl.commands[i & CL_UPDATE_MASK].heldback ? false : true;
 		netstat_cmdinfo[i & NET_TIMINGS_MASK].size = cl.commands[i & CL_UPDATE_MASK].sendsize;
 	}
 
+	netstat.outgoing = cls.netchan.outgoing_sequence;
+}
+
+/*
+==========
+NetGraph_GetFrameData
+
+get frame data info, like chokes, packet losses, also update graph, packet and cmdinfo
+==========
+*/
+static void NetGraph_GetFrameData( float *latency, int *latency_count )
+{
+	double		newtime = Sys_DoubleTime();
+	static double	nexttime = 0;
+	float		loss, choke;
+
+	if( newtime >= nexttime )
+	{
+		// soft fading of net peak usage
+		maxmsgbytes = Q_max( 0, maxmsgbytes - 50 );
+		nexttime = newtime + 0.05;
+	}
+
+	CL_UpdateNetgraphStats();
+
+	*latency_count = netstat.latency_count;
+	*latency = netstat.latency_sum;
+
+	if( netstat.maxmsgbytes > maxmsgbytes )
+		maxmsgbytes = netstat.maxmsgbytes;
+
+	if( maxmsgbytes > 1000 )
+		maxmsgbytes = 1000;
+
 	// packet loss
-	loss = 100.0f * (float)loss_count / CL_UPDATE_BACKUP;
+	loss = 100.0f * (float)netstat.lost / CL_UPDATE_BACKUP;
 	packet_loss = PACKETLOSS_AVG_FRAC * packet_loss + ( 1.0f - PACKETLOSS_AVG_FRAC ) * loss;
 
 	// packet choke
-	choke = 100.0f * (float)choke_count / CL_UPDATE_BACKUP;
+	choke = 100.0f * (float)netstat.choked / CL_UPDATE_BACKUP;
 	packet_choke = PACKETCHOKE_AVG_FRAC * packet_choke + ( 1.0f - PACKETCHOKE_AVG_FRAC ) * choke;
 }
 
+/*
+==========
+NetGraph_Stats_f
+
+print the net_graph aggregates, works without drawing for scripted soak tests
+==========
+*/
+static void NetGraph_Stats_f( void )
+{
+	if( cls.state != ca_active )
+	{
+		Con_Printf( "Not connected\n" );
+		return;
+	}
+
+	CL_UpdateNetgraphStats();
+
+	Con_Printf( "sequence: in %i out %i, window %i\n", cls.netchan.incoming_sequence, cls.netchan.outgoing_sequence, CL_UPDATE_BACKUP );
+	Con_Printf( "latency: %.1f ms over %i packets, channel %.1f ms\n",
+		netstat.latency_count ? netstat.latency_sum / netstat.latency_count : 0.0, netstat.latency_count, cls.latency * 1000.0f );
+	Con_Printf( "loss: %.1f%% choke: %.1f%% peak: %i bytes\n",
+		100.0f * netstat.lost / CL_UPDATE_BACKUP, 100.0f * netstat.choked / CL_UPDATE_BACKUP, netstat.maxmsgbytes );
+	Con_Printf( "in: %.2f kb/s out: %.2f kb/s\n",
+		cls.netchan.flow[FLOW_INCOMING].avgkbytespersec, cls.netchan.flow[FLOW_OUTGOING].avgkbytespersec );
+	Con_Printf( "total: %u packets, %u lost, %u choked\n", netstat.total_packets, netstat.total_lost, netstat.total_choked );
+}
+
 /*
 ===========
 NetGraph_DrawTimes
@@ -696,6 +858,7 @@ void CL_InitNetgraph( void )
 	Cvar_RegisterVariable( &net_graphwidth );
 	Cvar_RegisterVariable( &net_graphheight );
 	Cvar_RegisterVariable( &net_graphsolid );
+	Cmd_AddCommand( "net_graphstats", NetGraph_Stats_f, "print latency, loss and choke of the last received packets" );
 	packet_loss = packet_choke = 0.0;
 
 	NetGraph_InitColors();
@@ -649,6 +649,8 @@ static void CL_RemoveCustomization( int nPlayerNum, customization_t *pRemove )
 		if( pRemove != pList )
 			continue;
 
+		COM_ReleaseCustomization( pList );
+
 		if( pList->bInUse && pList->pBuffer )
 			Mem_Free( pList->pBuffer );
 
@@ -715,6 +715,16 @@ dlight_t *CL_GetEntityLight( int number );
 
 //=================================================
 
+//
+// cl_browser.c
+//
+void CL_InitServerBrowser( void );
+void CL_BrowserReset( void );
+void CL_BrowserAddServer( netadr_t adr );
+void CL_BrowserReply( netadr_t from );
+void CL_BrowserResendLegacy( netadr_t from );
+void CL_BrowserFrame( void );
+
 //
 // cl_cmds.c
 //
@@ -975,6 +985,7 @@ void SCR_DrawUserCmd( void );
 // cl_netgraph.c
 //
 void CL_InitNetgraph( void );
+void CL_UpdateNetgraphStats( void );
 void SCR_DrawNetGraph( void );
 
 //
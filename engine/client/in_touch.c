@@ -65,6 +65,9 @@ typedef struct touch_button_s
 	// Double-linked list
 	struct touch_button_s *next;
 	struct touch_button_s *prev;
+
+	// next button in the same name hash bucket, in list order
+	struct touch_button_s *hashnext;
 } touch_button_t;
 
 typedef struct touchdefaultbutton_s
@@ -79,10 +82,24 @@ typedef struct touchdefaultbutton_s
 	int flags;
 } touchdefaultbutton_t;
 
+#define TOUCH_HASH_SIZE	64	// must be power of two
+#define TOUCH_GRID_SIZE	8	// hit-test grid cells per axis
+#define TOUCH_GRID_CELLS	( TOUCH_GRID_SIZE * TOUCH_GRID_SIZE )
+
 typedef struct touchbuttonlist_s
 {
 	touch_button_t *first;
 	touch_button_t *last;
+
+	// exact name lookup
+	touch_button_t *hash[TOUCH_HASH_SIZE];
+
+	// hit-test grid over normalized screen space, every cell keeps
+	// overlapping buttons in list order, last range is the whole list
+	qboolean gridvalid;
+	int gridstart[TOUCH_GRID_CELLS + 2];
+	touch_button_t **gridbuttons;
+	int gridalloc;
 } touchbuttonlist_t;
 
 static struct touch_s
@@ -444,6 +461,8 @@ static void Touch_RoundAll_f( void )
 
 	for( button = touch.list_user.first; button; button = button->next )
 		IN_TouchCheckCoords( &button->x1, &button->y1, &button->x2, &button->y2 );
+
+	touch.list_user.gridvalid = false;
 }
 
 static void Touch_ListButtons_f( void )
@@ -480,11 +499,71 @@ static void Touch_Stroke_f( void )
 	MakeRGBA( touch.scolor, Q_atoi( Cmd_Argv( 2 ) ), Q_atoi( Cmd_Argv( 3 ) ), Q_atoi( Cmd_Argv( 4 ) ), Q_atoi( Cmd_Argv( 5 ) ) );
 }
 
+static uint Touch_HashName( const char *name )
+{
+	return COM_HashKey( name, TOUCH_HASH_SIZE );
+}
+
+static void Touch_LinkButton( touchbuttonlist_t *list, touch_button_t *b )
+{
+	touch_button_t **prev;
+
+	b->next = NULL;
+	b->prev = list->last;
+	if( b->prev )
+		b->prev->next = b;
+	list->last = b;
+
+	if( !list->first )
+		list->first = b;
+
+	// append to the hash chain too, so chains follow list order
+	for( prev = &list->hash[Touch_HashName( b->name )]; *prev; prev = &(*prev)->hashnext );
+	*prev = b;
+	b->hashnext = NULL;
+
+	list->gridvalid = false;
+}
+
+static void Touch_UnlinkButton( touchbuttonlist_t *list, touch_button_t *b )
+{
+	touch_button_t **prev;
+
+	if( b->prev )
+		b->prev->next = b->next;
+	else
+		list->first = b->next;
+
+	if( b->next )
+		b->next->prev = b->prev;
+	else
+		list->last = b->prev;
+
+	for( prev = &list->hash[Touch_HashName( b->name )]; *prev; prev = &(*prev)->hashnext )
+	{
+		if( *prev == b )
+		{
+			*prev = b->hashnext;
+			break;
+		}
+	}
+
+	b->next = b->prev = b->hashnext = NULL;
+	list->gridvalid = false;
+}
+
+static void Touch_BringToFront( touchbuttonlist_t *list, touch_button_t *b )
+{
+	Touch_UnlinkButton( list, b );
+	Touch_LinkButton( list, b );
+}
+
 static touch_button_t *Touch_FindNextNoPattern( touch_button_t *buttons, const char *name, qboolean privileged )
 {
 	touch_button_t *b;
 
-	for( b = buttons; b; b = b->next )
+	// walks the hash chain, not the whole list
+	for( b = buttons; b; b = b->hashnext )
 	{
 		if( !privileged && !FBitSet( b->flags, TOUCH_FL_UNPRIVILEGED ))
 			continue;
@@ -498,16 +577,12 @@ static touch_button_t *Touch_FindNextNoPattern( touch_button_t *buttons, const c
 
 static touch_button_t *Touch_FindButtonNoPattern( touchbuttonlist_t *list, const char *name, qboolean privileged )
 {
-	return Touch_FindNextNoPattern( list->first, name, privileged );
+	return Touch_FindNextNoPattern( list->hash[Touch_HashName( name )], name, privileged );
 }
 
-static touch_button_t *Touch_FindNext( touch_button_t *buttons, const char *name, qboolean privileged )
+static touch_button_t *Touch_FindNextPattern( touch_button_t *buttons, const char *name, qboolean privileged )
 {
 	touch_button_t *b;
-	qboolean has_pattern = Q_strchr( name, '*' ) != NULL;
-
-	if( !has_pattern )
-		return Touch_FindNextNoPattern( buttons, name, privileged );
 
 	for( b = buttons; b; b = b->next )
 	{
@@ -521,10 +596,27 @@ static touch_button_t *Touch_FindNext( touch_button_t *buttons, const char *name
 	return NULL;
 }
 
+/*
+=================
+Touch_FindNext
+
+continues search after previous match
+=================
+*/
+static touch_button_t *Touch_FindNext( touch_button_t *prev, const char *name, qboolean privileged )
+{
+	if( !Q_strchr( name, '*' ))
+		return Touch_FindNextNoPattern( prev->hashnext, name, privileged );
+
+	return Touch_FindNextPattern( prev->next, name, privileged );
+}
 
 static touch_button_t *Touch_FindFirst( touchbuttonlist_t *list, const char *name, qboolean privileged )
 {
-	return Touch_FindNext( list->first, name, privileged );
+	if( !Q_strchr( name, '*' ))
+		return Touch_FindButtonNoPattern( list, name, privileged );
+
+	return Touch_FindNextPattern( list->first, name, privileged );
 }
 
 void Touch_SetClientOnly( byte state )
@@ -566,16 +658,7 @@ static void Touch_RemoveButtonFromList( touchbuttonlist_t *list, const char *nam
 
 	while(( button = Touch_FindFirst( &touch.list_user, name, privileged )))
 	{
-		if( button->prev )
-			button->prev->next = button->next;
-		else
-			list->first = button->next;
-
-		if( button->next )
-			button->next->prev = button->prev;
-		else
-			list->last = button->prev;
-
+		Touch_UnlinkButton( &touch.list_user, button );
 		Mem_Free( button );
 	}
 }
@@ -605,6 +688,8 @@ static void Touch_ClearList( touchbuttonlist_t *list )
 		Mem_Free( remove );
 	}
 	list->first = list->last = NULL;
+	memset( list->hash, 0, sizeof( list->hash ));
+	list->gridvalid = false;
 }
 
 static void Touch_RemoveAll_f( void )
@@ -618,7 +703,7 @@ static void Touch_SetColor( touchbuttonlist_t *list, const char *name, byte *col
 {
 	touch_button_t *b;
 
-	for( b = Touch_FindFirst( list, name, privileged ); b != NULL; b = Touch_FindNext( b->next, name, privileged ))
+	for( b = Touch_FindFirst( list, name, privileged ); b != NULL; b = Touch_FindNext( b, name, privileged ))
 		Vector4Copy( color, b->color );
 }
 
@@ -655,7 +740,7 @@ void Touch_HideButtons( const char *name, byte hide, qboolean privileged )
 {
 	touch_button_t *b;
 
-	for( b = Touch_FindFirst( &touch.list_user, name, privileged ); b != NULL; b = Touch_FindNext( b->next, name, privileged ))
+	for( b = Touch_FindFirst( &touch.list_user, name, privileged ); b != NULL; b = Touch_FindNext( b, name, privileged ))
 	{
 		if( hide )
 			SetBits( b->flags, TOUCH_FL_HIDE );
@@ -696,7 +781,7 @@ static void Touch_FadeButtons( touchbuttonlist_t *list, const char *name, float
 {
 	touch_button_t *b;
 
-	for( b = Touch_FindFirst( list, name, privileged ); b != NULL; b = Touch_FindNext( b->next, name, privileged ))
+	for( b = Touch_FindFirst( list, name, privileged ); b != NULL; b = Touch_FindNext( b, name, privileged ))
 	{
 		if( start >= 0 )
 			b->fade = start;
@@ -818,13 +903,7 @@ static touch_button_t *Touch_AddButton( touchbuttonlist_t *list, const char *nam
 	Touch_SetCommand( b, command );
 
 	b->finger = -1;
-	b->prev = list->last;
-	if( b->prev )
-		b->prev->next = b;
-	list->last = b;
-
-	if( !list->first )
-		list->first = b;
+	Touch_LinkButton( list, b );
 
 	return b;
 }
@@ -972,6 +1051,7 @@ static void Touch_AddButton_f( void )
 			if( button->texture[0] != '#' )
 				button->y2 = button->y1 + (( button->x2 - button->x1 ) / Touch_AspectRatio( )) * aspect;
 			button->aspect = aspect;
+			touch.list_user.gridvalid = false;
 		}
 	}
 }
@@ -1015,6 +1095,7 @@ static void Touch_EnableEdit_f( void )
 			}
 		}
 		touch.config_aspect_ratio = touch.actual_aspect_ratio;
+		touch.list_user.gridvalid = false;
 	}
 }
 
@@ -1097,8 +1178,8 @@ void Touch_Init( void )
 	g_DefaultButtons = NULL;
 	g_DefaultButtonsLength = 0;
 
-	touch.list_edit.first = touch.list_edit.last = NULL;
-	touch.list_user.first = touch.list_user.last = NULL;
+	memset( &touch.list_edit, 0, sizeof( touch.list_edit ));
+	memset( &touch.list_user, 0, sizeof( touch.list_user ));
 
 	// fill default buttons list
 	MakeRGBA( color, 255, 255, 255, 255 );
@@ -1603,6 +1684,7 @@ static void Touch_EditMove( touchEventType type, int fingerID, float x, float y,
 			touch_button_t *b = touch.edit;
 
 			IN_TouchCheckCoords( &b->x1, &b->y1, &b->x2, &b->y2 );
+			touch.list_user.gridvalid = false;
 			IN_TouchEditClear();
 
 			touch.selection = b;
@@ -1622,6 +1704,7 @@ static void Touch_EditMove( touchEventType type, int fingerID, float x, float y,
 			touch.edit->y2 += dy;
 			touch.edit->x1 += dx;
 			touch.edit->x2 += dx;
+			touch.list_user.gridvalid = false;
 		}
 	}
 	else
@@ -1642,6 +1725,7 @@ static void Touch_EditMove( touchEventType type, int fingerID, float x, float y,
 			{
 				touch.edit->y2 += dy;
 				touch.edit->x2 += dx;
+				touch.list_user.gridvalid = false;
 			}
 		}
 	}
@@ -1754,17 +1838,118 @@ static void Touch_Motion( int fingerID, float x, float y, float dx, float dy )
 	}
 }
 
+static int Touch_GridCoord( float v )
+{
+	// out of screen coordinates go to the border cells
+	if( !( v > 0.0f ))
+		return 0;
+
+	if( v >= 1.0f )
+		return TOUCH_GRID_SIZE - 1;
+
+	return Q_min( (int)( v * TOUCH_GRID_SIZE ), TOUCH_GRID_SIZE - 1 );
+}
+
+/*
+=================
+Touch_BuildGrid
+
+sorts buttons into hit-test grid cells, keeping list order in every cell
+=================
+*/
+static void Touch_BuildGrid( touchbuttonlist_t *list )
+{
+	int fill[TOUCH_GRID_CELLS + 1];
+	touch_button_t *b;
+	int i, j, total;
+
+	memset( list->gridstart, 0, sizeof( list->gridstart ));
+
+	// count entries for every cell and for the whole list range
+	for( b = list->first; b; b = b->next )
+	{
+		list->gridstart[TOUCH_GRID_CELLS + 1]++;
+
+		// degenerate button can't pass bounds check
+		if( b->x1 > b->x2 || b->y1 > b->y2 )
+			continue;
+
+		for( j = Touch_GridCoord( b->y1 ); j <= Touch_GridCoord( b->y2 ); j++ )
+		{
+			for( i = Touch_GridCoord( b->x1 ); i <= Touch_GridCoord( b->x2 ); i++ )
+				list->gridstart[j * TOUCH_GRID_SIZE + i + 1]++;
+		}
+	}
+
+	for( i = 1; i < TOUCH_GRID_CELLS + 2; i++ )
+		list->gridstart[i] += list->gridstart[i - 1];
+
+	total = list->gridstart[TOUCH_GRID_CELLS + 1];
+	if( total > list->gridalloc )
+	{
+		list->gridalloc = total + 32;
+		list->gridbuttons = Mem_Realloc( touch.mempool, list->gridbuttons, sizeof( *list->gridbuttons ) * list->gridalloc );
+	}
+
+	memcpy( fill, list->gridstart, sizeof( fill ));
+
+	for( b = list->first; b; b = b->next )
+	{
+		list->gridbuttons[fill[TOUCH_GRID_CELLS]++] = b;
+
+		if( b->x1 > b->x2 || b->y1 > b->y2 )
+			continue;
+
+		for( j = Touch_GridCoord( b->y1 ); j <= Touch_GridCoord( b->y2 ); j++ )
+		{
+			for( i = Touch_GridCoord( b->x1 ); i <= Touch_GridCoord( b->x2 ); i++ )
+				list->gridbuttons[fill[j * TOUCH_GRID_SIZE + i]++] = b;
+		}
+	}
+
+	list->gridvalid = true;
+}
+
+/*
+=================
+Touch_GetButtons
+
+returns buttons in list order that may be hit by the touch,
+or every button if position doesn't matter
+=================
+*/
+static touch_button_t **Touch_GetButtons( touchbuttonlist_t *list, qboolean hittest, float x, float y, int *count )
+{
+	int cell;
+
+	if( !list->gridvalid )
+		Touch_BuildGrid( list );
+
+	if( hittest )
+		cell = Touch_GridCoord( y ) * TOUCH_GRID_SIZE + Touch_GridCoord( x );
+	else cell = TOUCH_GRID_CELLS;
+
+	*count = list->gridstart[cell + 1] - list->gridstart[cell];
+	return list->gridbuttons + list->gridstart[cell];
+}
+
 static qboolean Touch_ButtonPress( touchbuttonlist_t *list, touchEventType type, int fingerID, float x, float y )
 {
-	touch_button_t *button;
+	touch_button_t *button, **buttons;
 	qboolean result = false;
+	int i;
 
 	if( type != event_down && type != event_up )
 		return false;
 
+	// only buttons overlapping touched cell need bounds check
+	buttons = Touch_GetButtons( list, type == event_down, x, y, &i );
+
 	// run from end(front) to start(back)
-	for( button = list->last; button; button = button->prev )
+	while( i-- > 0 )
 	{
+		button = buttons[i];
+
 		// skip invisible buttons
 		if( !Touch_IsVisible( button ))
 			continue;
@@ -2012,18 +2197,8 @@ static qboolean Touch_ButtonEdit( touchEventType type, int fingerID, float x, fl
 
 				// make button last to bring it up
 				if( button->next && button->type == touch_command )
-				{
-					if( button->prev )
-						button->prev->next = button->next;
-					else
-						touch.list_user.first = button->next;
-
-					button->next->prev = button->prev;
-					touch.list_user.last->next = button;
-					button->prev = touch.list_user.last;
-					button->next = NULL;
-					touch.list_user.last = button;
-				}
+					Touch_BringToFront( &touch.list_user, button );
+
 				touch.state = state_edit_move;
 				return true;
 			}
@@ -2253,3 +2428,200 @@ void Touch_Shutdown( void )
 	touch.initialized = false;
 	Mem_FreePool( &touch.mempool );
 }
+
+#if XASH_ENGINE_TESTS
+#include "tests.h"
+
+static uint test_touch_seed;
+
+static float Test_TouchRandom( float min, float max )
+{
+	test_touch_seed = test_touch_seed * 1103515245 + 12345;
+	return min + ( max - min ) * (( test_touch_seed >> 8 ) & 0xFFFF ) / 65535.0f;
+}
+
+static touch_button_t *Test_TouchFindLinear( touchbuttonlist_t *list, const char *name, qboolean privileged )
+{
+	touch_button_t *b;
+
+	for( b = list->first; b; b = b->next )
+	{
+		if( !privileged && !FBitSet( b->flags, TOUCH_FL_UNPRIVILEGED ))
+			continue;
+
+		if( !Q_strncmp( b->name, name, sizeof( b->name )))
+			return b;
+	}
+
+	return NULL;
+}
+
+static void Test_TouchNameHash( void )
+{
+	touchbuttonlist_t list = { 0 };
+	touch_button_t *b, *dup1, *dup2;
+	rgba_t color = { 255, 255, 255, 255 };
+	string name;
+	int i, count;
+
+	for( i = 0; i < 200; i++ )
+	{
+		Q_snprintf( name, sizeof( name ), "button%d", i );
+		Touch_AddButton( &list, name, "", "", 0.0f, 0.0f, 0.1f, 0.1f, color, i & 1 );
+	}
+
+	for( i = 0; i < 210; i++ )
+	{
+		Q_snprintf( name, sizeof( name ), "button%d", i );
+		TASSERT_EQp( Touch_FindButtonNoPattern( &list, name, true ), Test_TouchFindLinear( &list, name, true ));
+		TASSERT_EQp( Touch_FindButtonNoPattern( &list, name, false ), Test_TouchFindLinear( &list, name, false ));
+	}
+
+	// pattern search still walks the list
+	for( count = 0, b = Touch_FindFirst( &list, "button1*", true ); b; b = Touch_FindNext( b, "button1*", true ))
+		count++;
+	TASSERT_EQi( count, 111 );
+
+	// edit list may have duplicates, they come in list order
+	dup1 = Touch_AddButton( &list, "dup", "", "", 0.0f, 0.0f, 0.1f, 0.1f, color, true );
+	dup2 = Touch_AddButton( &list, "dup", "", "", 0.0f, 0.0f, 0.1f, 0.1f, color, true );
+	TASSERT_EQp( Touch_FindFirst( &list, "dup", true ), dup1 );
+	TASSERT_EQp( Touch_FindNext( dup1, "dup", true ), dup2 );
+	TASSERT_EQp( Touch_FindNext( dup2, "dup", true ), NULL );
+
+	Touch_BringToFront( &list, dup1 );
+	TASSERT_EQp( list.last, dup1 );
+	TASSERT_EQp( Touch_FindFirst( &list, "dup", true ), dup2 );
+	TASSERT_EQp( Touch_FindNext( dup2, "dup", true ), dup1 );
+
+	b = Touch_FindButtonNoPattern( &list, "button42", true );
+	Touch_UnlinkButton( &list, b );
+	Mem_Free( b );
+	TASSERT_EQp( Touch_FindButtonNoPattern( &list, "button42", true ), NULL );
+	TASSERT_EQp( Touch_FindButtonNoPattern( &list, "button43", true ), Test_TouchFindLinear( &list, "button43", true ));
+
+	Touch_ClearList( &list );
+	TASSERT_EQp( Touch_FindButtonNoPattern( &list, "button43", true ), NULL );
+}
+
+static void Test_TouchHitTest( void )
+{
+	touchbuttonlist_t list = { 0 };
+	touch_button_t *b, **cell, *hits[64];
+	rgba_t color = { 255, 255, 255, 255 };
+	string name;
+	int i, j, k, numhits;
+
+	test_touch_seed = 1;
+
+	// grid aligned, out of screen and degenerate buttons are there too
+	Touch_AddButton( &list, "whole", "", "", 0.0f, 0.0f, 1.0f, 1.0f, color, true );
+	Touch_AddButton( &list, "aligned", "", "", 0.25f, 0.25f, 0.5f, 0.5f, color, true );
+	Touch_AddButton( &list, "offscreen", "", "", -0.5f, 0.9f, 0.1f, 1.5f, color, true );
+	Touch_AddButton( &list, "degenerate", "", "", 0.6f, 0.6f, 0.5f, 0.7f, color, true );
+
+	for( i = 0; i < 40; i++ )
+	{
+		float x = Test_TouchRandom( -0.1f, 1.0f );
+		float y = Test_TouchRandom( -0.1f, 1.0f );
+
+		Q_snprintf( name, sizeof( name ), "random%d", i );
+		Touch_AddButton( &list, name, "", "", x, y, x + Test_TouchRandom( 0.0f, 0.3f ), y + Test_TouchRandom( 0.0f, 0.3f ), color, true );
+	}
+
+	// synthetic touch stream: each down must hit same buttons
+	// in same order as bounds check over the whole list
+	for( i = 0; i < 2000; i++ )
+	{
+		float x, y;
+
+		if( i == 1000 )
+		{
+			// move a button like editor does
+			b = Touch_FindButtonNoPattern( &list, "random7", true );
+			b->x1 += 0.3f;
+			b->x2 += 0.3f;
+			list.gridvalid = false;
+		}
+
+		switch( i % 4 )
+		{
+		case 0: // on grid lines and buttons edges
+			x = ( i / 4 % ( TOUCH_GRID_SIZE + 1 )) / (float)TOUCH_GRID_SIZE;
+			y = ( i / 4 / ( TOUCH_GRID_SIZE + 1 ) % ( TOUCH_GRID_SIZE + 1 )) / (float)TOUCH_GRID_SIZE;
+			break;
+		case 1: // out of screen
+			x = Test_TouchRandom( -1.0f, 2.0f );
+			y = Test_TouchRandom( -1.0f, 2.0f );
+			break;
+		default:
+			x = Test_TouchRandom( 0.0f, 1.0f );
+			y = Test_TouchRandom( 0.0f, 1.0f );
+			break;
+		}
+
+		for( numhits = 0, b = list.last; b; b = b->prev )
+		{
+			if( x < b->x1 || x > b->x2 || y < b->y1 || y > b->y2 )
+				continue;
+
+			hits[numhits++] = b;
+		}
+
+		// grid candidates give same hits in front to back order
+		for( k = 0, cell = Touch_GetButtons( &list, true, x, y, &j ); j-- > 0; )
+		{
+			b = cell[j];
+
+			if( x < b->x1 || x > b->x2 || y < b->y1 || y > b->y2 )
+				continue;
+
+			if( k < numhits )
+			{
+				TASSERT_EQp( b, hits[k] );
+			}
+			k++;
+		}
+		TASSERT_EQi( k, numhits );
+
+		Touch_ButtonPress( &list, event_down, i, x, y );
+
+		for( j = 0, b = list.first; b; b = b->next )
+		{
+			if( b->finger == i )
+				j++;
+		}
+		TASSERT_EQi( j, numhits );
+
+		// release doesn't depend on position
+		Touch_ButtonPress( &list, event_up, i, 2.0f, 2.0f );
+
+		for( j = 0, b = list.first; b; b = b->next )
+		{
+			if( b->finger != -1 )
+				j++;
+		}
+		TASSERT_EQi( j, 0 );
+
+		// drop commands queued by pressed buttons
+		Cbuf_Clear();
+	}
+
+	Touch_ClearList( &list );
+	Mem_Free( list.gridbuttons );
+}
+
+void Test_RunTouch( void )
+{
+	qboolean temppool = !touch.mempool;
+
+	if( temppool )
+		touch.mempool = Mem_AllocPool( "Touch Tests" );
+
+	TRUN( Test_TouchNameHash() );
+	TRUN( Test_TouchHitTest() );
+
+	if( temppool )
+		Mem_FreePool( &touch.mempool );
+}
+#endif /* XASH_ENGINE_TESTS */
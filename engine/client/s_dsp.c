@@ -252,7 +252,7 @@ void SX_Init( void )
 
 	Cvar_RegisterVariable( &sxste_delay );
 
-	Cmd_AddCommand( "dsp_profile", SX_Profiling_f, "dsp stress-test, first argument is room_type" );
+	Cmd_AddCommand( "dsp_profile", SX_Profiling_f, "dsp stress-test, first argument is room_type or \"all\"" );
 
 	SX_ReloadRoomFX();
 }
@@ -345,6 +345,40 @@ static void DLY_MovePointer( dly_t *dly )
 		dly->idelayoutput = 0;
 }
 
+/*
+============
+DLY_ContiguousSamples
+
+How many samples can be processed before
+input or output pointer wraps around
+============
+*/
+static int DLY_ContiguousSamples( const dly_t *dly, int count )
+{
+	size_t	n = count;
+
+	n = Q_min( n, dly->cdelaysamplesmax - dly->idelayinput );
+	n = Q_min( n, dly->cdelaysamplesmax - dly->idelayoutput );
+
+	return (int)n;
+}
+
+/*
+============
+DLY_AdvancePointers
+
+DLY_MovePointer for a whole block returned by DLY_ContiguousSamples
+============
+*/
+static void DLY_AdvancePointers( dly_t *dly, int count )
+{
+	if(( dly->idelayinput += count ) >= dly->cdelaysamplesmax )
+		dly->idelayinput = 0;
+
+	if(( dly->idelayoutput += count ) >= dly->cdelaysamplesmax )
+		dly->idelayoutput = 0;
+}
+
 /*
 =============
 DLY_CheckNewStereoDelayVal
@@ -395,66 +429,127 @@ static void DLY_CheckNewStereoDelayVal( void )
 
 /*
 =============
-DLY_DoStereoDelay
+DLY_DoStereoDelaySample
 
-Do stereo processing
+Do stereo processing for one sample, handles crossfade
 =============
 */
-static void DLY_DoStereoDelay( int count )
+static void DLY_DoStereoDelaySample( dly_t *dly, portable_samplepair_t *paint )
 {
-	int			delay, samplexf;
-	dly_t *const		dly = &rgsxdly[STEREODLY];
-	portable_samplepair_t	*paint = paintto;
+	int	delay, samplexf;
 
-	if( !dly->lpdelayline )
-		return; // inactive
+	if( dly->mod && --dly->modcur < 0 )
+		dly->modcur = dly->mod;
 
-	for( ; count; count--, paint++ )
+	delay = dly->lpdelayline[dly->idelayoutput];
+
+	// process only if crossfading, active left value or delayline
+	if( delay || paint->left || dly->xfade )
 	{
-		if( dly->mod && --dly->modcur < 0 )
-			dly->modcur = dly->mod;
+		// set up new crossfade, if not crossfading, not modulating, but going to
+		if( !dly->xfade && !dly->modcur && dly->mod )
+		{
+			dly->idelayoutputxf = dly->idelayoutput + ((COM_RandomLong( 0, 255 ) * dly->delaysamples ) >> 9 );
+
+			dly->xfade = 128;
+		}
 
-		delay = dly->lpdelayline[dly->idelayoutput];
+		dly->idelayoutputxf %= dly->cdelaysamplesmax;
 
-		// process only if crossfading, active left value or delayline
-		if( delay || paint->left || dly->xfade )
+		// modify delay, if crossfading
+		if( dly->xfade )
 		{
-			// set up new crossfade, if not crossfading, not modulating, but going to
-			if( !dly->xfade && !dly->modcur && dly->mod )
-			{
-				dly->idelayoutputxf = dly->idelayoutput + ((COM_RandomLong( 0, 255 ) * dly->delaysamples ) >> 9 );
+			samplexf = dly->lpdelayline[dly->idelayoutputxf] * (128 - dly->xfade) >> 7;
+			delay = samplexf + ((delay * dly->xfade) >> 7);
 
-				dly->xfade = 128;
-			}
+			if( ++dly->idelayoutputxf >= dly->cdelaysamplesmax )
+				dly->idelayoutputxf = 0;
 
-			dly->idelayoutputxf %= dly->cdelaysamplesmax;
+			if( --dly->xfade == 0 )
+				dly->idelayoutput = dly->idelayoutputxf;
+		}
 
-			// modify delay, if crossfading
-			if( dly->xfade )
-			{
-				samplexf = dly->lpdelayline[dly->idelayoutputxf] * (128 - dly->xfade) >> 7;
-				delay = samplexf + ((delay * dly->xfade) >> 7);
+		// save left value to delay line
+		dly->lpdelayline[dly->idelayinput] = CLIP( paint->left );
 
-				if( ++dly->idelayoutputxf >= dly->cdelaysamplesmax )
-					dly->idelayoutputxf = 0;
+		// paint new delay value
+		paint->left = delay;
+	}
+	else
+	{
+		// clear delay line
+		dly->lpdelayline[dly->idelayinput] = 0;
+	}
 
-				if( --dly->xfade == 0 )
-					dly->idelayoutput = dly->idelayoutputxf;
-			}
+	DLY_MovePointer( dly );
+}
 
-			// save left value to delay line
-			dly->lpdelayline[dly->idelayinput] = CLIP( paint->left );
+/*
+=============
+DLY_DoStereoDelayBlock
 
-			// paint new delay value
-			paint->left = delay;
+Same as DLY_DoStereoDelaySample without crossfade and modulation,
+delay line pointers must not wrap inside of the block
+=============
+*/
+static void DLY_DoStereoDelayBlock( dly_t *dly, portable_samplepair_t *paint, int count )
+{
+	int *const	input = &dly->lpdelayline[dly->idelayinput];
+	const int *const	output = &dly->lpdelayline[dly->idelayoutput];
+	qboolean		processed = false;
+	int		i, delay;
+
+	for( i = 0; i < count; i++ )
+	{
+		delay = output[i];
+
+		if( delay || paint[i].left )
+		{
+			input[i] = CLIP( paint[i].left );
+			paint[i].left = delay;
+			processed = true;
 		}
-		else
+		else input[i] = 0;
+	}
+
+	// it's idempotent, so once is enough
+	if( processed )
+		dly->idelayoutputxf %= dly->cdelaysamplesmax;
+
+	DLY_AdvancePointers( dly, count );
+}
+
+/*
+=============
+DLY_DoStereoDelay
+
+Do stereo processing
+=============
+*/
+static void DLY_DoStereoDelay( int count )
+{
+	dly_t *const		dly = &rgsxdly[STEREODLY];
+	portable_samplepair_t	*paint = paintto;
+	int			n;
+
+	if( !dly->lpdelayline )
+		return; // inactive
+
+	while( count > 0 )
+	{
+		// crossfade and modulation change pointers on the fly
+		if( dly->xfade || dly->mod )
 		{
-			// clear delay line
-			dly->lpdelayline[dly->idelayinput] = 0;
+			DLY_DoStereoDelaySample( dly, paint );
+			paint++;
+			count--;
+			continue;
 		}
 
-		DLY_MovePointer( dly );
+		n = DLY_ContiguousSamples( dly, count );
+		DLY_DoStereoDelayBlock( dly, paint, n );
+		paint += n;
+		count -= n;
 	}
 }
 
@@ -506,52 +601,82 @@ static void DLY_CheckNewDelayVal( void )
 
 /*
 =============
-DLY_DoDelay
+DLY_DoDelayBlock
 
-Do delay processing
+Do delay processing, delay line pointers
+must not wrap inside of the block
 =============
 */
-static void DLY_DoDelay( int count )
+static void DLY_DoDelayBlock( dly_t *dly, portable_samplepair_t *paint, int count )
 {
-	dly_t *const		dly = &rgsxdly[MONODLY];
-	portable_samplepair_t	*paint = paintto;
-	int			delay;
-
-	if( !dly->lpdelayline || !count )
-		return; // inactive
-
-	for( ; count; count--, paint++ )
+	int *const	input = &dly->lpdelayline[dly->idelayinput];
+	const int *const	output = &dly->lpdelayline[dly->idelayoutput];
+	const int		feedback = dly->delayfeedback;
+	const int		lp = dly->lp;
+	int		lp0 = dly->lp0, lp1 = dly->lp1, lp2 = dly->lp2;
+	int		i, delay, val;
+
+	for( i = 0; i < count; i++ )
 	{
-		delay = dly->lpdelayline[dly->idelayoutput];
+		delay = output[i];
 
 		// don't process if delay line and left/right samples are zero
-		if( delay || paint->left || paint->right )
+		if( delay || paint[i].left || paint[i].right )
 		{
 			// calculate delayed value from average
-			int val = (( paint->left + paint->right ) >> 1 ) + (( dly->delayfeedback * delay ) >> 8);
+			val = (( paint[i].left + paint[i].right ) >> 1 ) + (( feedback * delay ) >> 8);
 			val = CLIP( val );
 
-			if( dly->lp ) // lowpass
+			if( lp ) // lowpass
 			{
-				val = ( dly->lp0 + dly->lp1 + val ) / 3;
-				dly->lp0 = dly->lp1;
-				dly->lp1 = val;
+				val = ( lp0 + lp1 + val ) / 3;
+				lp0 = lp1;
+				lp1 = val;
 			}
 
-			dly->lpdelayline[dly->idelayinput] = val;
+			input[i] = val;
 
 			val >>= 2;
 
-			paint->left = CLIP( paint->left + val );
-			paint->right = CLIP( paint->right + val );
+			paint[i].left = CLIP( paint[i].left + val );
+			paint[i].right = CLIP( paint[i].right + val );
 		}
 		else
 		{
-			dly->lpdelayline[dly->idelayinput] = 0;
-			dly->lp0 = dly->lp1 = dly->lp2 = 0;
+			input[i] = 0;
+			lp0 = lp1 = lp2 = 0;
 		}
+	}
+
+	dly->lp0 = lp0;
+	dly->lp1 = lp1;
+	dly->lp2 = lp2;
 
-		DLY_MovePointer( dly );
+	DLY_AdvancePointers( dly, count );
+}
+
+/*
+=============
+DLY_DoDelay
+
+Do delay processing
+=============
+*/
+static void DLY_DoDelay( int count )
+{
+	dly_t *const		dly = &rgsxdly[MONODLY];
+	portable_samplepair_t	*paint = paintto;
+	int			n;
+
+	if( !dly->lpdelayline || !count )
+		return; // inactive
+
+	while( count > 0 )
+	{
+		n = DLY_ContiguousSamples( dly, count );
+		DLY_DoDelayBlock( dly, paint, n );
+		paint += n;
+		count -= n;
 	}
 }
 
@@ -696,6 +821,82 @@ static int RVB_DoReverbForOneDly( dly_t *dly, const int vlr, const portable_samp
 
 }
 
+/*
+===========
+RVB_DoReverbBlock
+
+Same as RVB_DoReverbForOneDly without crossfades, for both
+delay lines at once. Pointers must not wrap inside of the block
+===========
+*/
+static void RVB_DoReverbBlock( dly_t *dly1, dly_t *dly2, portable_samplepair_t *paint, int count, qboolean alpha )
+{
+	dly_t *const	dlys[2] = { dly1, dly2 };
+	int		*input[2], lp0[2], modcur[2];
+	const int		*output[2];
+	int		i, j, delay, val, vlr, voutm;
+
+	for( j = 0; j < 2; j++ )
+	{
+		input[j] = &dlys[j]->lpdelayline[dlys[j]->idelayinput];
+		output[j] = &dlys[j]->lpdelayline[dlys[j]->idelayoutput];
+		lp0[j] = dlys[j]->lp0;
+		modcur[j] = dlys[j]->modcur;
+	}
+
+	for( i = 0; i < count; i++ )
+	{
+		vlr = ( paint[i].left + paint[i].right ) >> 1;
+		voutm = 0;
+
+		for( j = 0; j < 2; j++ )
+		{
+			if( --modcur[j] < 0 )
+				modcur[j] = dlys[j]->mod;
+
+			delay = output[j][i];
+
+			if( delay || paint[i].left || paint[i].right )
+			{
+				if( delay )
+				{
+					val = vlr + (( dlys[j]->delayfeedback * delay ) >> 8 );
+					val = CLIP( val );
+				}
+				else val = vlr;
+
+				if( dlys[j]->lp )
+				{
+					input[j][i] = ( lp0[j] + val ) >> 1;
+					lp0[j] = val;
+				}
+				else input[j][i] = val;
+
+				voutm += input[j][i];
+			}
+			else
+			{
+				input[j][i] = 0;
+				lp0[j] = 0;
+			}
+		}
+
+		if( alpha )
+			voutm /= 6;
+		else voutm = (11 * voutm) >> 6;
+
+		paint[i].left = CLIP( paint[i].left + voutm );
+		paint[i].right = CLIP( paint[i].right + voutm );
+	}
+
+	for( j = 0; j < 2; j++ )
+	{
+		dlys[j]->lp0 = lp0[j];
+		dlys[j]->modcur = modcur[j];
+		DLY_AdvancePointers( dlys[j], count );
+	}
+}
+
 /*
 ===========
 RVB_DoReverb
@@ -708,24 +909,39 @@ static void RVB_DoReverb( int count )
 	dly_t *const		dly1 = &rgsxdly[REVERBPOS];
 	dly_t *const		dly2 = &rgsxdly[REVERBPOS+1];
 	portable_samplepair_t	*paint = paintto;
-	int			vlr, voutm;
+	const qboolean		alpha = dsp_coeff_table.value == 1.0f;
+	int			vlr, voutm, n;
 
 	if( !dly1->lpdelayline )
 		return;
 
-	for( ; count; count--, paint++ )
+	while( count > 0 )
 	{
-		vlr = ( paint->left + paint->right ) >> 1;
+		// crossfades and unmodulated lines need per sample processing
+		if( dly1->xfade || dly2->xfade || !dly1->mod || !dly2->mod || !dly2->lpdelayline )
+		{
+			vlr = ( paint->left + paint->right ) >> 1;
 
-		voutm = RVB_DoReverbForOneDly( dly1, vlr, paint );
-		voutm += RVB_DoReverbForOneDly( dly2, vlr, paint );
+			voutm = RVB_DoReverbForOneDly( dly1, vlr, paint );
+			voutm += RVB_DoReverbForOneDly( dly2, vlr, paint );
 
-		if( dsp_coeff_table.value == 1.0f )
-			voutm /= 6; // alpha
-		else voutm = (11 * voutm) >> 6;
+			if( alpha )
+				voutm /= 6; // alpha
+			else voutm = (11 * voutm) >> 6;
+
+			paint->left = CLIP( paint->left + voutm );
+			paint->right = CLIP( paint->right + voutm );
+
+			paint++;
+			count--;
+			continue;
+		}
 
-		paint->left = CLIP( paint->left + voutm );
-		paint->right = CLIP( paint->right + voutm );
+		n = DLY_ContiguousSamples( dly1, count );
+		n = DLY_ContiguousSamples( dly2, n );
+		RVB_DoReverbBlock( dly1, dly2, paint, n, alpha );
+		paint += n;
+		count -= n;
 	}
 }
 
@@ -739,67 +955,83 @@ Do amplification modulation processing
 static void RVB_DoAMod( int count )
 {
 	portable_samplepair_t	*paint = paintto;
-
-	if( !sxmod_lowpass.value && !sxmod_mod.value )
+	const qboolean		lowpass = sxmod_lowpass.value != 0.0f;
+	const qboolean		modulate = sxmod_mod.value != 0.0f;
+	int			lp[MAXLP];
+	int			amodl = sxamodl, amodr = sxamodr;
+	int			amodlt = sxamodlt, amodrt = sxamodrt;
+	int			mod1cur = sxmod1cur, mod2cur = sxmod2cur;
+
+	if( !lowpass && !modulate )
 		return;
 
+	memcpy( lp, rgsxlp, sizeof( lp ));
+
 	for( ; count; count--, paint++ )
 	{
 		portable_samplepair_t	res = *paint;
 
-		if( sxmod_lowpass.value )
+		if( lowpass )
 		{
-			res.left  = rgsxlp[0] + rgsxlp[1] + rgsxlp[2] + rgsxlp[3] + rgsxlp[4] + res.left;
-			res.right = rgsxlp[5] + rgsxlp[6] + rgsxlp[7] + rgsxlp[8] + rgsxlp[9] + res.right;
+			res.left  = lp[0] + lp[1] + lp[2] + lp[3] + lp[4] + res.left;
+			res.right = lp[5] + lp[6] + lp[7] + lp[8] + lp[9] + res.right;
 
 			res.left >>= 2;
 			res.right >>= 2;
 
-			rgsxlp[4] = paint->left;
-			rgsxlp[9] = paint->right;
-
-			rgsxlp[0] = rgsxlp[1];
-			rgsxlp[1] = rgsxlp[2];
-			rgsxlp[2] = rgsxlp[3];
-			rgsxlp[3] = rgsxlp[4];
-			rgsxlp[4] = rgsxlp[5];
-			rgsxlp[5] = rgsxlp[6];
-			rgsxlp[6] = rgsxlp[7];
-			rgsxlp[7] = rgsxlp[8];
-			rgsxlp[8] = rgsxlp[9];
+			lp[4] = paint->left;
+			lp[9] = paint->right;
+
+			lp[0] = lp[1];
+			lp[1] = lp[2];
+			lp[2] = lp[3];
+			lp[3] = lp[4];
+			lp[4] = lp[5];
+			lp[5] = lp[6];
+			lp[6] = lp[7];
+			lp[7] = lp[8];
+			lp[8] = lp[9];
 		}
 
-		if( sxmod_mod.value )
+		if( modulate )
 		{
-			if( --sxmod1cur < 0 )
-				sxmod1cur = sxmod1;
+			if( --mod1cur < 0 )
+				mod1cur = sxmod1;
 
 			if( !sxmod1 )
-				sxamodlt = COM_RandomLong( 32, 255 );
+				amodlt = COM_RandomLong( 32, 255 );
 
-			if( --sxmod2cur < 0 )
-				sxmod2cur = sxmod2;
+			if( --mod2cur < 0 )
+				mod2cur = sxmod2;
 
 			if( !sxmod2 )
-				sxamodrt = COM_RandomLong( 32, 255 );
+				amodrt = COM_RandomLong( 32, 255 );
 
-			res.left = (sxamodl * res.left) >> 8;
-			res.right = (sxamodr * res.right) >> 8;
+			res.left = (amodl * res.left) >> 8;
+			res.right = (amodr * res.right) >> 8;
 
-			if( sxamodl < sxamodlt )
-				sxamodl++;
-			else if( sxamodl > sxamodlt )
-				sxamodl--;
+			if( amodl < amodlt )
+				amodl++;
+			else if( amodl > amodlt )
+				amodl--;
 
-			if( sxamodr < sxamodrt )
-				sxamodr++;
-			else if( sxamodr > sxamodrt )
-				sxamodr--;
+			if( amodr < amodrt )
+				amodr++;
+			else if( amodr > amodrt )
+				amodr--;
 		}
 
 		paint->left = CLIP(res.left);
 		paint->right = CLIP(res.right);
 	}
+
+	memcpy( rgsxlp, lp, sizeof( lp ));
+	sxamodl = amodl;
+	sxamodr = amodr;
+	sxamodlt = amodlt;
+	sxamodrt = amodrt;
+	sxmod1cur = mod1cur;
+	sxmod2cur = mod2cur;
 }
 
 /*
@@ -913,12 +1145,70 @@ void CheckNewDspPresets( void )
 	ClearBits( sxste_delay.flags, FCVAR_CHANGED );
 }
 
+/*
+===========
+SX_ProfileRoom
+
+Profiles each DSP stage separately and returns total time
+===========
+*/
+static double SX_ProfileRoom( portable_samplepair_t *testbuffer, int count, int calls )
+{
+	static void (*const stages[])( int ) =
+	{
+		RVB_DoAMod,
+		RVB_DoReverb,
+		DLY_DoDelay,
+		DLY_DoStereoDelay,
+	};
+	static const char *const names[] =
+	{
+		"amod",
+		"reverb",
+		"delay",
+		"stereo delay",
+	};
+	double	times[ARRAYSIZE( stages )] = { 0 };
+	double	start, total = 0.0;
+	int	i, j;
+
+	if( dsp_off.value || room_off.value )
+		return 0.0;
+
+	paintto = testbuffer;
+
+	for( i = 0; i < calls; i++ )
+	{
+		for( j = 0; j < (int)ARRAYSIZE( stages ); j++ )
+		{
+			start = Sys_DoubleTime();
+			stages[j]( count );
+			times[j] += Sys_DoubleTime() - start;
+		}
+	}
+
+	for( j = 0; j < (int)ARRAYSIZE( stages ); j++ )
+	{
+		Con_Printf( "  %-12s %g seconds\n", names[j], times[j] );
+		total += times[j];
+	}
+
+	return total;
+}
+
+/*
+===========
+SX_Profiling_f
+
+dsp_profile [room_type|all]
+===========
+*/
 static void SX_Profiling_f( void )
 {
 	portable_samplepair_t	testbuffer[512];
 	float			oldroom = room_type.value;
-	double			start, end;
-	int			i, calls;
+	double			start, end, total;
+	int			i, calls, first, last;
 
 	for( i = 0; i < 512; i++ )
 	{
@@ -926,23 +1216,51 @@ static void SX_Profiling_f( void )
 		testbuffer[i].right = COM_RandomLong( 0, 3000 );
 	}
 
-	if( Cmd_Argc() > 1 )
+	if( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "all" ))
 	{
-		Cvar_DirectSetValue( &room_type, Q_atof( Cmd_Argv( 1 )));
-		SX_ReloadRoomFX();
-		CheckNewDspPresets(); // we just need idsp_room immediately, for message below
+		first = 0;
+		last = MAX_ROOM_TYPES - 1;
 	}
+	else
+	{
+		if( Cmd_Argc() > 1 )
+		{
+			Cvar_DirectSetValue( &room_type, Q_atof( Cmd_Argv( 1 )));
+			SX_ReloadRoomFX();
+		}
+
+		CheckNewDspPresets(); // we just need idsp_room immediately, for message below
 
-	Con_Printf( "Profiling 10000 calls to DSP. Sample count is 512, room_type is %i\n", idsp_room );
+		first = last = idsp_room;
+	}
 
-	start = Sys_DoubleTime();
-	for( calls = 10000; calls; calls-- )
+	for( i = first, total = 0.0; i <= last; i++ )
 	{
-		DSP_Process( testbuffer, 512 );
+		if( first != last )
+		{
+			Cvar_DirectSetValue( &room_type, i );
+			SX_ReloadRoomFX();
+			CheckNewDspPresets();
+		}
+
+		Con_Printf( "Profiling 10000 calls to DSP. Sample count is 512, room_type is %i\n", idsp_room );
+
+		start = Sys_DoubleTime();
+		for( calls = 10000; calls; calls-- )
+		{
+			DSP_Process( testbuffer, 512 );
+		}
+		end = Sys_DoubleTime();
+
+		Con_Printf( "----------\nTook %g seconds.\n", end - start );
+		total += end - start;
+
+		// same amount of calls again, but time each stage on its own
+		SX_ProfileRoom( testbuffer, 512, 10000 );
 	}
-	end = Sys_DoubleTime();
 
-	Con_Printf( "----------\nTook %g seconds.\n", end - start );
+	if( first != last )
+		Con_Printf( "----------\nAll rooms took %g seconds.\n", total );
 
 	if( Cmd_Argc() > 1 )
 	{
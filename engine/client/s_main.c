@@ -19,6 +19,7 @@ GNU General Public License for more details.
 #include "con_nprint.h"
 #include "pm_local.h"
 #include "platform/platform.h"
+#include "soundlib.h"
 
 dma_t		dma;
 poolhandle_t sndpool;
@@ -45,6 +46,7 @@ CVAR_DEFINE_AUTO( snd_mute_losefocus, "1", FCVAR_ARCHIVE|FCVAR_FILTERABLE, "sile
 CVAR_DEFINE_AUTO( s_test, "0", 0, "engine developer cvar for quick testing new features" );
 CVAR_DEFINE_AUTO( s_samplecount, "0", FCVAR_ARCHIVE|FCVAR_FILTERABLE, "sample count (0 for default value)" );
 CVAR_DEFINE_AUTO( s_warn_late_precache, "0", FCVAR_ARCHIVE|FCVAR_FILTERABLE, "warn about late precached sounds on client-side" );
+CVAR_DEFINE_AUTO( s_music_thread, "1", FCVAR_ARCHIVE|FCVAR_FILTERABLE, "decode background music from loose files on a separate thread" );
 
 /*
 =============================================================================
@@ -1836,6 +1838,7 @@ qboolean S_Init( void )
 	Cvar_RegisterVariable( &s_test );
 	Cvar_RegisterVariable( &s_samplecount );
 	Cvar_RegisterVariable( &s_warn_late_precache );
+	Cvar_RegisterVariable( &s_music_thread );
 
 	if( Sys_CheckParm( "-nosound" ))
 	{
@@ -1852,6 +1855,7 @@ qboolean S_Init( void )
 	Cmd_AddCommand( "soundlist", S_SoundList_f, "display loaded sounds" );
 	Cmd_AddCommand( "s_info", S_SoundInfo_f, "print sound system information" );
 	Cmd_AddCommand( "s_fade", S_SoundFade_f, "fade all sounds then stop all" );
+	Cmd_AddCommand( "s_mp3bench", Sound_BenchMPG_f, "decode mp3 files with generic and simd synth, compare speed and output" );
 	Cmd_AddCommand( "+voicerecord", S_VoiceRecordStart_f, "start voice recording" );
 	Cmd_AddCommand( "-voicerecord", S_VoiceRecordStop_f, "stop voice recording" );
 	Cmd_AddCommand( "spk", S_SayReliable_f, "reliable play a specified sententce" );
@@ -1897,12 +1901,14 @@ void S_Shutdown( void )
 	Cmd_RemoveCommand( "soundlist" );
 	Cmd_RemoveCommand( "s_info" );
 	Cmd_RemoveCommand( "s_fade" );
+	Cmd_RemoveCommand( "s_mp3bench" );
 	Cmd_RemoveCommand( "+voicerecord" );
 	Cmd_RemoveCommand( "-voicerecord" );
 	Cmd_RemoveCommand( "speak" );
 	Cmd_RemoveCommand( "spk" );
 
 	S_StopAllSounds (false);
+	S_StreamShutdown ();
 	S_FreeRawChannels ();
 	S_FreeSounds ();
 	VOX_Shutdown ();
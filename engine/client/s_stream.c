@@ -17,10 +17,379 @@ GNU General Public License for more details.
 #include "sound.h"
 #include "client.h"
 #include "soundlib.h"
+#include "platform/platform.h"
+
+#if !XASH_EMSCRIPTEN && !XASH_DOS4GW && !defined XASH_NO_ASYNC_MUSIC
+#define CAN_ASYNC_MUSIC
+#endif // !XASH_EMSCRIPTEN && !XASH_DOS4GW && !defined XASH_NO_ASYNC_MUSIC
+
+#define MUSIC_CHUNKS	8	// ~0.75 seconds of 44.1kHz 16-bit stereo
+#define MUSIC_IDLE_MSEC	5	// decoder sleep time when ring is full or there is nothing to play
 
 static bg_track_t		s_bgTrack;
 static musicfade_t		musicfade;	// controlled by game dlls
 
+#ifdef CAN_ASYNC_MUSIC
+static void S_MusicThread( void );
+
+#if XASH_SDL == 2
+#include <SDL_thread.h>
+#define mutex_create( x )    (( x ) = SDL_CreateMutex() )
+#define mutex_destroy( x )   SDL_DestroyMutex(( x ))
+#define mutex_lock( x )      SDL_LockMutex(( x ))
+#define mutex_unlock( x )    SDL_UnlockMutex(( x ))
+#define create_thread( thread, pfn ) (( thread ) = SDL_CreateThread(( pfn ), "Music decoder thread", NULL ))
+#define join_thread( x )     SDL_WaitThread(( x ), NULL )
+typedef SDL_mutex *mutex_t;
+typedef SDL_Thread *thread_t;
+static int S_MusicThreadStart( void *unused )
+{
+	S_MusicThread();
+	return 0;
+}
+#elif !XASH_WIN32
+#include <pthread.h>
+#define mutex_create( x )     pthread_mutex_init( &( x ), NULL )
+#define mutex_destroy( x )    pthread_mutex_destroy( &( x ))
+#define mutex_lock( x )       pthread_mutex_lock( &( x ))
+#define mutex_unlock( x )     pthread_mutex_unlock( &( x ))
+#define create_thread( thread, pfn ) !pthread_create( &( thread ), NULL, ( pfn ), NULL )
+#define join_thread( x )      pthread_join(( x ), NULL )
+typedef pthread_mutex_t mutex_t;
+typedef pthread_t thread_t;
+static void *S_MusicThreadStart( void *unused )
+{
+	S_MusicThread();
+	return NULL;
+}
+#else // WIN32
+#include <windows.h>
+#define mutex_create( x )   InitializeCriticalSection( &( x ))
+#define mutex_destroy( x )  DeleteCriticalSection( &( x ))
+#define mutex_lock( x )     EnterCriticalSection( &( x ))
+#define mutex_unlock( x )   LeaveCriticalSection( &( x ))
+#define create_thread( thread, pfn ) (( thread ) = CreateThread( NULL, 0, ( pfn ), NULL, 0, NULL ))
+#define join_thread( x )    ( WaitForSingleObject(( x ), INFINITE ), CloseHandle(( x )))
+typedef CRITICAL_SECTION mutex_t;
+typedef HANDLE thread_t;
+static DWORD WINAPI S_MusicThreadStart( LPVOID unused )
+{
+	S_MusicThread();
+	return 0;
+}
+#endif // !_WIN32
+
+typedef struct musicchunk_s
+{
+	int	rate;
+	int	width;
+	int	channels;
+	int	size;		// decoded bytes
+	int	position;		// stream position right after this chunk
+	int	track;		// stream serial number, see musicthread.track
+	byte	data[MAX_RAW_SAMPLES];
+} musicchunk_t;
+
+// single producer, single consumer ring of decoded music
+// decoder never holds the mutex while it reads the stream
+static struct musicthread_s
+{
+	mutex_t	mutex;
+	thread_t	thread;
+	qboolean	initialized;
+
+	// shared, protected by mutex
+	qboolean	quit;
+	qboolean	busy;		// decoder is reading from the stream
+	qboolean	eof;		// stream is over, waiting for the next one
+	stream_t	*stream;		// stream given to decoder
+	int	track;		// increments every time stream is changed
+	int	seekpos;		// requested stream position or -1
+	uint	head;		// chunks decoded
+	uint	tail;		// chunks played
+	uint	underruns;	// times when sound update found no decoded data
+	uint	decoded;
+
+	// main thread only
+	qboolean	primed;		// got first chunk, counting underruns from now
+	qboolean	leaving;		// loop track can't be decoded on thread, play it after ring drains
+	stream_t	*pending;		// loop track, if leaving
+	int	playtrack;	// serial number of the last played chunk
+	int	chunkpos;		// bytes played from the tail chunk
+
+	musicchunk_t	chunks[MUSIC_CHUNKS];
+} musicthread;
+
+/*
+=================
+S_MusicThread
+
+decodes given stream ahead into the ring
+=================
+*/
+static void S_MusicThread( void )
+{
+	while( true )
+	{
+		musicchunk_t	*chunk;
+		stream_t		*stream;
+		int		track, seekpos, bytes;
+
+		mutex_lock( musicthread.mutex );
+
+		if( musicthread.quit )
+		{
+			mutex_unlock( musicthread.mutex );
+			break;
+		}
+
+		if( !musicthread.stream || musicthread.eof || musicthread.head - musicthread.tail >= MUSIC_CHUNKS )
+		{
+			mutex_unlock( musicthread.mutex );
+			Platform_Sleep( MUSIC_IDLE_MSEC );
+			continue;
+		}
+
+		// slot at head isn't visible to main thread until head moves
+		chunk = &musicthread.chunks[musicthread.head % MUSIC_CHUNKS];
+		stream = musicthread.stream;
+		track = musicthread.track;
+		seekpos = musicthread.seekpos;
+		musicthread.seekpos = -1;
+		musicthread.busy = true;
+
+		mutex_unlock( musicthread.mutex );
+
+		if( seekpos != -1 )
+			FS_SetStreamPos( stream, seekpos );
+
+		// read whole sample frames only
+		bytes = sizeof( chunk->data ) - sizeof( chunk->data ) % ( stream->width * stream->channels );
+
+		chunk->rate = stream->rate;
+		chunk->width = stream->width;
+		chunk->channels = stream->channels;
+		chunk->size = FS_ReadStream( stream, bytes, chunk->data );
+		chunk->position = FS_GetStreamPos( stream );
+		chunk->track = track;
+
+		mutex_lock( musicthread.mutex );
+
+		musicthread.busy = false;
+
+		if( musicthread.track == track )
+		{
+			if( chunk->size > 0 )
+			{
+				musicthread.head++;
+				musicthread.decoded++;
+			}
+			else musicthread.eof = true;
+		}
+
+		mutex_unlock( musicthread.mutex );
+	}
+}
+
+/*
+=================
+S_MusicThreadInit
+=================
+*/
+static qboolean S_MusicThreadInit( void )
+{
+	if( musicthread.initialized )
+		return true;
+
+	mutex_create( musicthread.mutex );
+	musicthread.seekpos = -1;
+
+	if( !create_thread( musicthread.thread, S_MusicThreadStart ))
+	{
+		Con_Reportf( S_ERROR "%s: failed to create thread!\n", __func__ );
+		mutex_destroy( musicthread.mutex );
+		return false;
+	}
+
+	musicthread.initialized = true;
+
+	return true;
+}
+
+/*
+=================
+S_MusicThreadSetStream
+
+flushes the ring and gives new stream to decoder,
+waits until decoder is done with previous one
+=================
+*/
+static void S_MusicThreadSetStream( stream_t *stream, int seekpos )
+{
+	mutex_lock( musicthread.mutex );
+
+	while( musicthread.busy )
+	{
+		mutex_unlock( musicthread.mutex );
+		Platform_Sleep( 1 );
+		mutex_lock( musicthread.mutex );
+	}
+
+	musicthread.stream = stream;
+	musicthread.track++;
+	musicthread.seekpos = seekpos;
+	musicthread.eof = false;
+	musicthread.head = musicthread.tail = 0;
+
+	musicthread.playtrack = musicthread.track;
+	musicthread.chunkpos = 0;
+	musicthread.primed = false;
+
+	mutex_unlock( musicthread.mutex );
+
+	if( musicthread.pending )
+		FS_FreeStream( musicthread.pending );
+
+	musicthread.pending = NULL;
+	musicthread.leaving = false;
+}
+
+/*
+=================
+S_MusicThreadLoop
+
+opens loop track as soon as decoder reached the end of previous one,
+so it continues without a gap while the ring is being played
+=================
+*/
+static void S_MusicThreadLoop( void )
+{
+	stream_t	*stream = FS_OpenStream( s_bgTrack.loopName );
+
+	if( !stream || !stream->ondisk )
+	{
+		// finish playing what was decoded, then continue on main thread
+		musicthread.pending = stream;
+		musicthread.leaving = true;
+		return;
+	}
+
+	// decoder doesn't touch the stream after eof, so it's safe to swap
+	mutex_lock( musicthread.mutex );
+	musicthread.stream = stream;
+	musicthread.track++;
+	musicthread.eof = false;
+	mutex_unlock( musicthread.mutex );
+
+	FS_FreeStream( s_bgTrack.stream );
+	s_bgTrack.stream = stream;
+}
+
+/*
+=================
+S_MusicThreadLeave
+
+ring is empty and loop track must be played on main thread
+=================
+*/
+static void S_MusicThreadLeave( void )
+{
+	stream_t	*stream = musicthread.pending;
+
+	musicthread.pending = NULL;
+	S_MusicThreadSetStream( NULL, -1 );
+
+	FS_FreeStream( s_bgTrack.stream );
+	s_bgTrack.stream = stream;
+	s_bgTrack.async = false;
+	Q_strncpy( s_bgTrack.current, s_bgTrack.loopName, sizeof( s_bgTrack.current ));
+}
+
+/*
+=================
+S_StreamBackgroundTrackAsync
+
+play music decoded by the music thread
+=================
+*/
+static void S_StreamBackgroundTrackAsync( rawchan_t *ch )
+{
+	while( ch->s_rawend < soundtime + ch->max_samples )
+	{
+		musicchunk_t	*chunk = NULL;
+		int		bufferSamples;
+		int		fileSamples;
+		int		fileBytes;
+		int		frame;
+		qboolean		eof;
+
+		mutex_lock( musicthread.mutex );
+
+		if( musicthread.head != musicthread.tail )
+			chunk = &musicthread.chunks[musicthread.tail % MUSIC_CHUNKS];
+		else if( !musicthread.eof && musicthread.primed )
+			musicthread.underruns++;
+
+		eof = musicthread.eof;
+
+		mutex_unlock( musicthread.mutex );
+
+		if( eof && s_bgTrack.loopName[0] && !musicthread.leaving )
+			S_MusicThreadLoop();
+
+		if( !chunk )
+		{
+			if( !eof )
+				return; // decoder is late
+
+			if( musicthread.leaving )
+				S_MusicThreadLeave();
+			else if( !s_bgTrack.loopName[0] )
+				S_StopBackgroundTrack();
+			return;
+		}
+
+		musicthread.primed = true;
+
+		if( chunk->track != musicthread.playtrack )
+		{
+			// intro is over, playing loop track
+			musicthread.playtrack = chunk->track;
+			Q_strncpy( s_bgTrack.current, s_bgTrack.loopName, sizeof( s_bgTrack.current ));
+		}
+
+		frame = chunk->width * chunk->channels;
+		bufferSamples = ch->max_samples - (ch->s_rawend - soundtime);
+
+		// decide how much data needs to be taken from the chunk
+		fileSamples = bufferSamples * ((float)chunk->rate / SOUND_DMA_SPEED );
+		if( fileSamples <= 1 ) return; // no more samples need
+
+		fileSamples = Q_min( fileSamples, ( chunk->size - musicthread.chunkpos ) / frame );
+		fileBytes = fileSamples * frame;
+
+		if( fileSamples > 0 )
+		{
+			// add to raw buffer
+			int music_vol = (int)(255.0f * S_GetMusicVolume());
+			S_RawEntSamples( S_RAW_SOUND_BACKGROUNDTRACK, fileSamples, chunk->rate, chunk->width, chunk->channels, chunk->data + musicthread.chunkpos, music_vol );
+		}
+
+		musicthread.chunkpos += fileBytes;
+
+		if( chunk->size - musicthread.chunkpos < frame )
+		{
+			s_bgTrack.position = chunk->position;
+			musicthread.chunkpos = 0;
+
+			mutex_lock( musicthread.mutex );
+			musicthread.tail++;
+			mutex_unlock( musicthread.mutex );
+		}
+	}
+}
+#endif // CAN_ASYNC_MUSIC
+
 /*
 =================
 S_PrintBackgroundTrackState
@@ -37,6 +406,21 @@ void S_PrintBackgroundTrackState( void )
 	else if( s_bgTrack.loopName[0] )
 		Con_Printf( "%s [loop]\n", s_bgTrack.loopName );
 	else Con_Printf( "not playing\n" );
+
+#ifdef CAN_ASYNC_MUSIC
+	if( s_bgTrack.async )
+	{
+		uint	buffered, underruns, decoded;
+
+		mutex_lock( musicthread.mutex );
+		buffered = musicthread.head - musicthread.tail;
+		underruns = musicthread.underruns;
+		decoded = musicthread.decoded;
+		mutex_unlock( musicthread.mutex );
+
+		Con_Printf( "decoded on music thread: %u/%i chunks ahead, %u decoded, %u underruns\n", buffered, MUSIC_CHUNKS, decoded, underruns );
+	}
+#endif // CAN_ASYNC_MUSIC
 }
 
 /*
@@ -108,6 +492,17 @@ void S_StartBackgroundTrack( const char *introTrack, const char *mainTrack, int
 	memset( &musicfade, 0, sizeof( musicfade )); // clear any soundfade
 	s_bgTrack.source = cls.key_dest;
 
+#ifdef CAN_ASYNC_MUSIC
+	// archives share file offsets between handles, so only loose files can be read on another thread
+	if( s_bgTrack.stream && s_bgTrack.stream->ondisk && s_music_thread.value && S_MusicThreadInit( ))
+	{
+		s_bgTrack.async = true;
+		s_bgTrack.position = position;
+		S_MusicThreadSetStream( s_bgTrack.stream, position != 0 ? position : -1 );
+		return;
+	}
+#endif // CAN_ASYNC_MUSIC
+
 	if( position != 0 )
 	{
 		// restore message, update song position
@@ -127,6 +522,11 @@ void S_StopBackgroundTrack( void )
 	if( !dma.initialized ) return;
 	if( !s_bgTrack.stream ) return;
 
+#ifdef CAN_ASYNC_MUSIC
+	if( s_bgTrack.async )
+		S_MusicThreadSetStream( NULL, -1 );
+#endif // CAN_ASYNC_MUSIC
+
 	FS_FreeStream( s_bgTrack.stream );
 	memset( &s_bgTrack, 0, sizeof( bg_track_t ));
 	memset( &musicfade, 0, sizeof( musicfade ));
@@ -169,7 +569,12 @@ qboolean S_StreamGetCurrentState( char *currentTrack, size_t currentTrackSize, c
 	}
 
 	if( position )
-		*position = FS_GetStreamPos( s_bgTrack.stream );
+	{
+		// decoder is ahead of playback
+		if( s_bgTrack.async )
+			*position = s_bgTrack.position;
+		else *position = FS_GetStreamPos( s_bgTrack.stream );
+	}
 
 	return true;
 }
@@ -211,6 +616,14 @@ void S_StreamBackgroundTrack( void )
 	if( ch->s_rawend < soundtime )
 		ch->s_rawend = soundtime;
 
+#ifdef CAN_ASYNC_MUSIC
+	if( s_bgTrack.async )
+	{
+		S_StreamBackgroundTrackAsync( ch );
+		return;
+	}
+#endif // CAN_ASYNC_MUSIC
+
 	while( ch->s_rawend < soundtime + ch->max_samples )
 	{
 		const stream_t *info = s_bgTrack.stream;
@@ -288,3 +701,27 @@ void S_StopStreaming( void )
 	if( !dma.initialized ) return;
 	s_listener.streaming = false;
 }
+
+/*
+=================
+S_StreamShutdown
+=================
+*/
+void S_StreamShutdown( void )
+{
+	S_StopBackgroundTrack();
+
+#ifdef CAN_ASYNC_MUSIC
+	if( !musicthread.initialized )
+		return;
+
+	mutex_lock( musicthread.mutex );
+	musicthread.quit = true;
+	mutex_unlock( musicthread.mutex );
+
+	join_thread( musicthread.thread );
+	mutex_destroy( musicthread.mutex );
+
+	memset( &musicthread, 0, sizeof( musicthread ));
+#endif // CAN_ASYNC_MUSIC
+}
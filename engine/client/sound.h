@@ -168,6 +168,8 @@ typedef struct
 	string    loopName; // may be empty
 	stream_t *stream;
 	int       source;   // may be game, menu, etc
+	qboolean  async;    // decoded by music thread
+	int       position; // stream position of played data, if async
 } bg_track_t;
 
 typedef int sound_t;
@@ -197,6 +199,7 @@ extern convar_t s_test;  // cvar to test new effects
 extern convar_t s_samplecount;
 extern convar_t s_warn_late_precache;
 extern convar_t snd_mute_losefocus;
+extern convar_t s_music_thread;
 
 void S_InitScaletable( void );
 wavdata_t *S_LoadSound( sfx_t *sfx );
@@ -266,6 +269,7 @@ void SND_ForceCloseMouth( int entnum );
 // s_stream.c
 //
 void S_StreamBackgroundTrack( void );
+void S_StreamShutdown( void );
 void S_PrintBackgroundTrackState( void );
 void S_FadeMusicVolume( float fadePercent );
 
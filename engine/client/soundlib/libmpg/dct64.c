@@ -15,11 +15,11 @@
  */
 
 #include "mpg123.h"
+#include "optimize.h"
 
-void dct64( float *out0, float *out1, float *samples )
+// first three butterfly stages, leave results in bufs[0..31]
+static void dct64_1( float *bufs, float *samples )
 {
-	float	bufs[64];
-
 	{
 		register float	*b1, *b2, *bs;
 		register float	*costab;
@@ -74,8 +74,19 @@ void dct64( float *out0, float *out1, float *samples )
 				*bs++ = REAL_MUL((*b1++ - *--b2), costab[i]);
 			b2 += 16;
 		}
+	}
+}
+
+// remaining stages and output, expects dct64_1 results in bufs[0..31]
+static void dct64_2( float *out0, float *out1, float *bufs )
+{
+	{
+		register float	*b1, *b2, *bs;
+		register float	*costab;
+		register int	j;
 
 		b1 = bufs;
+		bs = bufs + 32;
 		costab = pnts[3];
 		b2 = b1 + 4;
 
@@ -173,3 +184,54 @@ void dct64( float *out0, float *out1, float *samples )
 	out1[0x10*14] = REAL_SCALE_DCT64( bufs[15] );
 	out1[0x10*15] = REAL_SCALE_DCT64( bufs[16+15] );
 }
+
+void dct64( float *out0, float *out1, float *samples )
+{
+	float	bufs[64];
+
+	dct64_1( bufs, samples );
+	dct64_2( out0, out1, bufs );
+}
+
+#ifdef OPT_SIMD
+/*
+ * out[k] = in[k] + in[2n-1-k], out[n+k] = (in[n-1-k] - in[n+k]) * costab[n-1-k]
+ * the difference is negated for odd segments. Same arithmetic as the plain
+ * version, just four lanes at once, so results are bit exact.
+ */
+static void dct64_butterfly( float *out, const float *in, const float *costab, int n, int neg )
+{
+	int	k;
+
+	for( k = 0; k < n; k += 4 )
+	{
+		v4sf	lo = V4_LOAD( in + k );
+		v4sf	hi = V4_REV( V4_LOAD( in + 2 * n - 4 - k ));
+		v4sf	a = V4_REV( V4_LOAD( in + n - 4 - k ));
+		v4sf	b = V4_LOAD( in + n + k );
+		v4sf	c = V4_REV( V4_LOAD( costab + n - 4 - k ));
+
+		V4_STORE( out + k, V4_ADD( lo, hi ));
+		V4_STORE( out + n + k, V4_MUL( neg ? V4_SUB( b, a ) : V4_SUB( a, b ), c ));
+	}
+}
+
+void dct64_simd( float *out0, float *out1, float *samples )
+{
+	float	bufs[64];
+	int	j;
+
+	dct64_butterfly( bufs, samples, pnts[0], 16, FALSE );
+
+	dct64_butterfly( bufs + 32, bufs, pnts[1], 8, FALSE );
+	dct64_butterfly( bufs + 48, bufs + 16, pnts[1], 8, TRUE );
+
+	for( j = 0; j < 32; j += 16 )
+	{
+		dct64_butterfly( bufs + j, bufs + 32 + j, pnts[2], 4, FALSE );
+		dct64_butterfly( bufs + j + 8, bufs + 40 + j, pnts[2], 4, TRUE );
+	}
+
+	dct64_2( out0, out1, bufs );
+}
+#endif // OPT_SIMD
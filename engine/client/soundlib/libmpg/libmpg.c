@@ -132,3 +132,8 @@ void close_decoder( void *mpg )
 	mpg123_delete( mpg );
 	mpg123_exit();
 }
+
+int set_decoder_simd( void *mpg, int enable )
+{
+	return synth_use_simd( mpg, enable );
+}
@@ -167,6 +167,10 @@ SOURCE=.\mpg123.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\optimize.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\reader.h
 # End Source File
 # Begin Source File
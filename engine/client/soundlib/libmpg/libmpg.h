@@ -52,6 +52,7 @@ extern int read_mpeg_stream(void *mpg, byte *outbuf, size_t *outsize  );
 extern int get_stream_pos( void *mpg );
 extern int set_stream_pos( void *mpg, int curpos );
 extern void close_decoder( void *mpg );
+extern int set_decoder_simd( void *mpg, int enable ); // call before decoding, returns false if simd is unavailable
 const char *get_error( void *mpeg );
 
 #ifdef __cplusplus
@@ -468,6 +468,7 @@ void dct12( float *in, float *rawout1, float *rawout2, register float *wi, regis
 // dct64.c
 //
 void dct64( float *out0, float *out1, float *samples );
+void dct64_simd( float *out0, float *out1, float *samples );
 
 //
 // tabinit.c
@@ -0,0 +1,80 @@
+/*
+optimize.h - compact version of famous library mpg123
+Copyright (C) 2017 Uncle Mike
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+*/
+
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+// select vector instruction set that is guaranteed by the target
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define OPT_SSE2
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( _M_ARM64 )
+#define OPT_NEON
+#endif
+
+#if defined( OPT_SSE2 ) || defined( OPT_NEON )
+#define OPT_SIMD
+
+#ifdef _MSC_VER
+#define OPT_INLINE	__inline
+#else
+#define OPT_INLINE	inline
+#endif
+
+// four floats vector, only what synth and dct64 needs
+#if defined( OPT_SSE2 )
+#include <emmintrin.h>
+
+typedef __m128 v4sf;
+
+#define V4_LOAD( p )	_mm_loadu_ps(( p ))
+#define V4_STORE( p, v )	_mm_storeu_ps(( p ), ( v ))
+#define V4_ADD( a, b )	_mm_add_ps(( a ), ( b ))
+#define V4_SUB( a, b )	_mm_sub_ps(( a ), ( b ))
+#define V4_MUL( a, b )	_mm_mul_ps(( a ), ( b ))
+#define V4_REV( v )		_mm_shuffle_ps(( v ), ( v ), _MM_SHUFFLE( 0, 1, 2, 3 ))
+
+static OPT_INLINE float V4_HSUM( v4sf v )
+{
+	v = _mm_add_ps( v, _mm_movehl_ps( v, v ));
+	v = _mm_add_ss( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 1, 1, 1 )));
+	return _mm_cvtss_f32( v );
+}
+#else // OPT_NEON
+#include <arm_neon.h>
+
+typedef float32x4_t v4sf;
+
+#define V4_LOAD( p )	vld1q_f32(( p ))
+#define V4_STORE( p, v )	vst1q_f32(( p ), ( v ))
+#define V4_ADD( a, b )	vaddq_f32(( a ), ( b ))
+#define V4_SUB( a, b )	vsubq_f32(( a ), ( b ))
+#define V4_MUL( a, b )	vmulq_f32(( a ), ( b ))
+
+static OPT_INLINE v4sf V4_REV( v4sf v )
+{
+	v = vrev64q_f32( v );
+	return vcombine_f32( vget_high_f32( v ), vget_low_f32( v ));
+}
+
+static OPT_INLINE float V4_HSUM( v4sf v )
+{
+	float32x2_t	s = vadd_f32( vget_low_f32( v ), vget_high_f32( v ));
+	return vget_lane_f32( vpadd_f32( s, s ), 0 );
+}
+#endif // OPT_NEON
+
+#endif // OPT_SSE2 || OPT_NEON
+
+#endif//OPTIMIZE_H
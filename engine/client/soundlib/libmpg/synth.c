@@ -15,6 +15,7 @@ GNU General Public License for more details.
 
 #include "mpg123.h"
 #include "sample.h"
+#include "optimize.h"
 
 #define BACKPEDAL	0x10	// we use autoincrement and thus need this re-adjustment for window/b0.
 #define BLOCK	0x40	// one decoding block is 64 samples.
@@ -135,6 +136,102 @@ static int synth_1to1( float *bandPtr, int channel, mpg123_handle_t *fr, int fin
 	return clip;
 }
 
+#ifdef OPT_SIMD
+// same as synth_1to1, but sums four window taps at once, uses vectorized dct64
+static int synth_1to1_simd( float *bandPtr, int channel, mpg123_handle_t *fr, int final )
+{
+	static const float	altsign[4] = { 1.0f, -1.0f, 1.0f, -1.0f };
+	static const int	step = 2;
+	short		*samples = (short *) (fr->buffer.data + fr->buffer.fill);
+	float		*b0, **buf; // (*buf)[0x110];
+	int		clip = 0;
+	int		bo1;
+
+	if( !channel )
+	{
+		fr->bo--;
+		fr->bo &= 0xf;
+		buf = fr->float_buffs[0];
+	}
+	else
+	{
+		samples++;
+		buf = fr->float_buffs[1];
+	}
+
+	if( fr->bo & 0x1 )
+	{
+		b0 = buf[0];
+		bo1 = fr->bo;
+		dct64_simd( buf[1] + ((fr->bo + 1) & 0xf ), buf[0] + fr->bo, bandPtr );
+	}
+	else
+	{
+		b0 = buf[1];
+		bo1 = fr->bo+1;
+		dct64_simd( buf[0] + fr->bo, buf[1] + fr->bo + 1, bandPtr );
+	}
+
+	{
+		const v4sf	sign = V4_LOAD( altsign );
+		float		*window = fr->decwin + 16 - bo1;
+		register int	j;
+
+		for( j = (BLOCK / 4); j; j--, b0 += 0x400 / BLOCK, window += 0x800 / BLOCK, samples += step )
+		{
+			v4sf	v;
+			float	sum;
+
+			v = V4_MUL( V4_LOAD( window + 0x0 ), V4_LOAD( b0 + 0x0 ));
+			v = V4_ADD( v, V4_MUL( V4_LOAD( window + 0x4 ), V4_LOAD( b0 + 0x4 )));
+			v = V4_ADD( v, V4_MUL( V4_LOAD( window + 0x8 ), V4_LOAD( b0 + 0x8 )));
+			v = V4_ADD( v, V4_MUL( V4_LOAD( window + 0xC ), V4_LOAD( b0 + 0xC )));
+			sum = V4_HSUM( V4_MUL( v, sign ));
+
+			WRITE_SHORT_SAMPLE( samples, sum, clip );
+		}
+
+		{
+			float	sum;
+
+			sum  = REAL_MUL_SYNTH( window[0x0], b0[0x0] );
+			sum += REAL_MUL_SYNTH( window[0x2], b0[0x2] );
+			sum += REAL_MUL_SYNTH( window[0x4], b0[0x4] );
+			sum += REAL_MUL_SYNTH( window[0x6], b0[0x6] );
+			sum += REAL_MUL_SYNTH( window[0x8], b0[0x8] );
+			sum += REAL_MUL_SYNTH( window[0xA], b0[0xA] );
+			sum += REAL_MUL_SYNTH( window[0xC], b0[0xC] );
+			sum += REAL_MUL_SYNTH( window[0xE], b0[0xE] );
+
+			WRITE_SHORT_SAMPLE( samples, sum, clip );
+			samples += step;
+			b0 -= 0x400 / BLOCK;
+			window -= 0x800 / BLOCK;
+		}
+		window += bo1<<1;
+
+		// window taps go backwards here
+		for( j= (BLOCK / 4) - 1; j; j--, b0 -= 0x400 / BLOCK, window -= 0x800 / BLOCK, samples += step )
+		{
+			v4sf	v;
+			float	sum;
+
+			v = V4_MUL( V4_REV( V4_LOAD( window - 0x4 )), V4_LOAD( b0 + 0x0 ));
+			v = V4_ADD( v, V4_MUL( V4_REV( V4_LOAD( window - 0x8 )), V4_LOAD( b0 + 0x4 )));
+			v = V4_ADD( v, V4_MUL( V4_REV( V4_LOAD( window - 0xC )), V4_LOAD( b0 + 0x8 )));
+			v = V4_ADD( v, V4_MUL( V4_REV( V4_LOAD( window - 0x10 )), V4_LOAD( b0 + 0xC )));
+			sum = -V4_HSUM( v );
+
+			WRITE_SHORT_SAMPLE( samples, sum, clip );
+		}
+	}
+
+	if( final ) fr->buffer.fill += BLOCK * sizeof( short );
+
+	return clip;
+}
+#endif // OPT_SIMD
+
 // the call of left and right plain synth, wrapped.
 // this may be replaced by a direct stereo optimized synth.
 static int synth_stereo( float *bandPtr_l, float *bandPtr_r, mpg123_handle_t *fr )
@@ -152,7 +249,7 @@ static int synth_1to1_m2s(float *bandPtr, mpg123_handle_t *fr )
 	byte	*samples = fr->buffer.data;
 	int	i, ret;
 
-	ret = synth_1to1( bandPtr, 0, fr, 1 );
+	ret = (fr->synth)( bandPtr, 0, fr, 1 );
 	samples += fr->buffer.fill - BLOCK * sizeof( short );
 
 	for( i = 0; i < (BLOCK / 2); i++ )
@@ -177,7 +274,7 @@ static int synth_1to1_mono( float *bandPtr, mpg123_handle_t *fr )
 	fr->buffer.data = (byte *)samples_tmp;
 	fr->buffer.fill = 0;
 
-	ret = synth_1to1( bandPtr, 0, fr, 0 );	// decode into samples_tmp
+	ret = (fr->synth)( bandPtr, 0, fr, 0 );	// decode into samples_tmp
 	fr->buffer.data = samples;		// restore original value
 
 	// now append samples from samples_tmp
@@ -211,9 +308,45 @@ static const struct synth_s synth_base =
 }
 };
 
+#ifdef OPT_SIMD
+static const struct synth_s synth_simd =
+{
+{
+{ synth_1to1_simd }	// plain
+},
+{
+{ synth_stereo }
+},
+{
+{ synth_1to1_m2s }
+},
+{
+{ synth_1to1_mono }
+}
+};
+
+#endif // OPT_SIMD
+
 void init_synth( mpg123_handle_t *fr )
 {
+#ifdef OPT_SIMD
+	fr->synths = synth_simd;
+#else
+	fr->synths = synth_base;
+#endif
+}
+
+// choose vectorized or generic synth for this decoder before it decodes anything
+// returns FALSE if vectorized synth was requested but there is no SIMD support
+int synth_use_simd( mpg123_handle_t *fr, int enable )
+{
+#ifdef OPT_SIMD
+	fr->synths = enable ? synth_simd : synth_base;
+	return TRUE;
+#else
 	fr->synths = synth_base;
+	return !enable;
+#endif
 }
 
 static int find_synth(func_synth synth,  const func_synth synths[r_limit][f_limit])
@@ -237,6 +370,7 @@ enum optdec
 {
 	autodec = 0,
 	generic,
+	simd,
 	nodec
 };
 
@@ -249,6 +383,10 @@ static int find_dectype( mpg123_handle_t *fr )
 
 	if( find_synth( basic_synth, synth_base.plain ))
 		type = generic;
+#ifdef OPT_SIMD
+	else if( find_synth( basic_synth, synth_simd.plain ))
+		type = simd;
+#endif
 
 	if( type != nodec )
 	{
@@ -52,6 +52,7 @@ typedef struct synth_s
 } synth_t;
 
 void init_synth( mpg123_handle_t *fr );
+int synth_use_simd( mpg123_handle_t *fr, int enable );
 int set_synth_functions( mpg123_handle_t *fr );
 
 #endif//SYNTH_H
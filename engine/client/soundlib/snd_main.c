@@ -15,7 +15,7 @@ GNU General Public License for more details.
 
 #include "soundlib.h"
 
-static void Sound_Reset( void )
+void Sound_Reset( void )
 {
 	// reset global variables
 	sound.width = sound.rate = 0;
@@ -47,6 +47,44 @@ static MALLOC_LIKE( FS_FreeSound, 1 ) wavdata_t *SoundPack( void )
 	return pack;
 }
 
+/*
+================
+Sound_LoadFile
+
+load sound from file with known format,
+paths that are indexed as missing are skipped
+================
+*/
+static wavdata_t *Sound_LoadFile( const loadwavfmt_t *format, const char *path )
+{
+	const soundinfo_t *info = Sound_FindInfo( path );
+	fs_offset_t filesize = 0;
+	wavdata_t *pack;
+	byte *f;
+
+	if( info && info->missing )
+		return NULL;
+
+	f = FS_LoadFile( path, &filesize, false );
+	if( !f )
+	{
+		Sound_SetInfo( path, NULL, NULL, 0 );
+		return NULL;
+	}
+
+	if( filesize <= 0 || !format->loadfunc( path, f, filesize ))
+	{
+		Mem_Free( f ); // release buffer
+		return NULL;
+	}
+
+	pack = SoundPack();
+	Sound_SetInfo( path, pack, f, filesize );
+	Mem_Free( f ); // release buffer
+
+	return pack;
+}
+
 /*
 ================
 FS_LoadSound
@@ -88,33 +126,18 @@ wavdata_t *FS_LoadSound( const char *filename, const byte *buffer, size_t size )
 	{
 		if( anyformat || !Q_stricmp( ext, format->ext ))
 		{
-			qboolean success = false;
-			fs_offset_t filesize = 0;
-			byte *f;
+			wavdata_t *pack;
 			string path;
 
 			Q_snprintf( path, sizeof( path ), DEFAULT_SOUNDPATH "%s.%s", loadname, format->ext );
 
-			f = FS_LoadFile( path, &filesize, false );
-			if( f && filesize > 0 )
-			{
-				success = format->loadfunc( path, f, filesize );
-				Mem_Free( f ); // release buffer
-			}
-
-			if( success )
-				return SoundPack(); // loaded
+			if(( pack = Sound_LoadFile( format, path )) != NULL )
+				return pack; // loaded
 
 			Q_snprintf( path, sizeof( path ), "%s.%s", loadname, format->ext );
-			f = FS_LoadFile( path, &filesize, false );
-			if( f && filesize > 0 )
-			{
-				success = format->loadfunc( path, f, filesize );
-				Mem_Free( f ); // release buffer
-			}
 
-			if( success )
-				return SoundPack();
+			if(( pack = Sound_LoadFile( format, path )) != NULL )
+				return pack;
 		}
 	}
 
@@ -195,6 +218,7 @@ stream_t *FS_OpenStream( const char *filename )
 			if(( stream = format->openfunc( path )) != NULL )
 			{
 				stream->format = format;
+				stream->ondisk = FS_GetDiskPath( path, false ) != NULL;
 				return stream; // done
 			}
 		}
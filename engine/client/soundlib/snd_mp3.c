@@ -202,7 +202,14 @@ int EXPORT Fuzz_Sound_ParseID3Tag( const uint8_t *Data, size_t Size )
 
 =================================================================
 */
-qboolean Sound_LoadMPG( const char *name, const byte *buffer, fs_offset_t filesize )
+/*
+=================
+Sound_LoadMPGSynth
+
+decode with vectorized or generic synth
+=================
+*/
+static qboolean Sound_LoadMPGSynth( const char *name, const byte *buffer, fs_offset_t filesize, qboolean simd )
 {
 	void	*mpeg;
 	size_t	pos = 0;
@@ -222,6 +229,8 @@ qboolean Sound_LoadMPG( const char *name, const byte *buffer, fs_offset_t filesi
 
 	if( ret ) Con_DPrintf( S_ERROR "%s\n", get_error( mpeg ));
 
+	set_decoder_simd( mpeg, simd );
+
 	// trying to read header
 	if( !feed_mpeg_header( mpeg, buffer, FRAME_SIZE, filesize, &sc ))
 	{
@@ -288,6 +297,11 @@ qboolean Sound_LoadMPG( const char *name, const byte *buffer, fs_offset_t filesi
 	return true;
 }
 
+qboolean Sound_LoadMPG( const char *name, const byte *buffer, fs_offset_t filesize )
+{
+	return Sound_LoadMPGSynth( name, buffer, filesize, true );
+}
+
 static fs_offset_t FS_SeekMpg( void *file, fs_offset_t offset, int whence )
 {
 	return g_fsapi.Seek((file_t *)file, offset, whence ) == -1 ? -1 : g_fsapi.Tell((file_t *)file );
@@ -298,6 +312,121 @@ static mpg_ssize_t FS_ReadMpg( void *file, void *buf, size_t count )
 	return g_fsapi.Read((file_t *)file, buf, count );
 }
 
+/*
+=================
+Sound_DecodeMPG
+
+decodes whole file with generic or vectorized synth,
+returns decoded data and time it took
+=================
+*/
+static byte *Sound_DecodeMPG( const char *name, const byte *buffer, fs_offset_t filesize, qboolean simd, size_t *size, double *time, double *length )
+{
+	sndlib_t	saved = sound; // formats and temp buffer are kept for regular loads
+	double	start = Sys_DoubleTime();
+	byte	*wav = NULL;
+
+	Sound_Reset();
+
+	if( Sound_LoadMPGSynth( name, buffer, filesize, simd ))
+	{
+		wav = sound.wav;
+		*size = sound.samples * sound.width * sound.channels;
+		*length = (double)sound.samples / sound.rate;
+	}
+
+	*time = Sys_DoubleTime() - start;
+	sound = saved;
+
+	return wav;
+}
+
+/*
+=================
+Sound_BenchMPG_f
+
+s_mp3bench [file...], all mp3 files from media folder by default
+=================
+*/
+void Sound_BenchMPG_f( void )
+{
+	search_t	*t = NULL;
+	double	total[2] = { 0.0, 0.0 };
+	double	length = 0.0;
+	int	i, count;
+	void	*mpeg;
+
+	if( Cmd_Argc() < 2 )
+	{
+		if(( t = FS_Search( "media/*.mp3", true, false )) == NULL )
+		{
+			Con_Printf( "Usage: %s [file...]\n", Cmd_Argv( 0 ));
+			return;
+		}
+
+		count = t->numfilenames;
+	}
+	else count = Cmd_Argc() - 1;
+
+	if(( mpeg = create_decoder( NULL )) != NULL )
+	{
+		if( !set_decoder_simd( mpeg, true ))
+			Con_Printf( S_WARN "vectorized synth isn't available on this platform\n" );
+		close_decoder( mpeg );
+	}
+
+	for( i = 0; i < count; i++ )
+	{
+		const char	*name = t ? t->filenames[i] : Cmd_Argv( i + 1 );
+		byte		*buffer, *generic, *vector;
+		size_t		gensize = 0, vecsize = 0, j;
+		double		gentime, vectime, seconds = 0.0;
+		int		maxdiff = 0;
+		fs_offset_t	filesize;
+
+		if(( buffer = FS_LoadFile( name, &filesize, false )) == NULL )
+		{
+			Con_Printf( S_ERROR "couldn't load %s\n", name );
+			continue;
+		}
+
+		generic = Sound_DecodeMPG( name, buffer, filesize, false, &gensize, &gentime, &seconds );
+		vector = Sound_DecodeMPG( name, buffer, filesize, true, &vecsize, &vectime, &seconds );
+
+		if( generic && vector && gensize == vecsize )
+		{
+			const short *a = (const short *)generic;
+			const short *b = (const short *)vector;
+
+			for( j = 0; j < gensize / sizeof( short ); j++ )
+			{
+				if( abs( a[j] - b[j] ) > maxdiff )
+					maxdiff = abs( a[j] - b[j] );
+			}
+
+			Con_Printf( "%s: generic %.3f ms, simd %.3f ms, %.2fx, max sample difference %i\n",
+				name, gentime * 1000.0, vectime * 1000.0, gentime / ( vectime + 0.000001 ), maxdiff );
+
+			total[0] += gentime;
+			total[1] += vectime;
+			length += seconds;
+		}
+		else Con_Printf( S_ERROR "%s: couldn't decode or size mismatch\n", name );
+
+		if( generic ) Mem_Free( generic );
+		if( vector ) Mem_Free( vector );
+		Mem_Free( buffer );
+	}
+
+	if( t ) Mem_Free( t );
+
+	if( total[0] > 0.0 && total[1] > 0.0 )
+	{
+		Con_Printf( "total: %.1f seconds of audio, generic %.1fx realtime, simd %.1fx realtime\n",
+			length, length / total[0], length / total[1] );
+	}
+}
+
 /*
 =================
 Stream_OpenMPG
@@ -387,6 +387,7 @@ void _Mem_FreePool( poolhandle_t *poolptr, const char *filename, int fileline );
 void _Mem_EmptyPool( poolhandle_t poolptr, const char *filename, int fileline );
 void _Mem_Check( const char *filename, int fileline );
 qboolean Mem_IsAllocatedExt( poolhandle_t poolptr, void *data );
+size_t Mem_PoolSize( poolhandle_t poolptr );
 void Mem_PrintList( size_t minallocationsize );
 void Mem_PrintStats( void );
 
@@ -549,6 +550,22 @@ typedef struct wavdata_s
 	byte    buffer[];  // sound buffer
 } wavdata_t;
 
+// sound metadata index entry
+typedef struct soundinfo_s
+{
+	uint     type;        // sndformat_t, WF_UNKNOWN for unrecognized files
+	uint     rate;        // samples per second
+	uint     width;       // bytes per sample
+	uint     channels;    // num channels
+	uint     samples;     // total samplecount, known only if decoded
+	uint     loopStart;   // loop offset, known only if decoded
+	uint     flags;       // wavdata flags, known only if decoded
+	uint     approxmsecs; // GoldSrc play length estimation, WAV only
+	qboolean probed;      // header was read
+	qboolean decoded;     // sound was loaded at least once
+	qboolean missing;     // no such file in search paths
+} soundinfo_t;
+
 //
 // soundlib
 //
@@ -564,6 +581,9 @@ int FS_SetStreamPos( stream_t *stream, int newpos );
 int FS_GetStreamPos( stream_t *stream );
 qboolean Sound_Process( wavdata_t **wav, int rate, int width, int channels, uint flags );
 uint Sound_GetApproxWavePlayLen( const char *filepath );
+qboolean Sound_GetInfo( const char *filepath, soundinfo_t *info );
+const soundinfo_t *Sound_FindInfo( const char *filepath );
+void Sound_SetInfo( const char *filepath, const wavdata_t *sc, const byte *buffer, fs_offset_t filesize );
 qboolean Sound_SupportedFileFormat( const char *fileext );
 
 //
@@ -691,6 +711,8 @@ void Cmd_AutoCompleteClear( void );
 //
 // custom.c
 //
+void COM_InitCustomizations( void );
+void COM_ReleaseCustomization( customization_t *pCust );
 void COM_ClearCustomizationList( customization_t *pHead, qboolean bCleanDecals );
 qboolean COM_CreateCustomization( customization_t *pHead, resource_t *pRes, int playernum, int flags, customization_t **pCust, int *nLumps );
 int COM_SizeofResourceList( resource_t *pList, resourceinfo_t *ri );
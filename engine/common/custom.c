@@ -34,18 +34,229 @@ static rgbdata_t *CustomDecal_LoadImage( const char *path, void *raw, int size )
 	return FS_LoadImage( testname, raw, size );
 }
 
-static qboolean CustomDecal_Validate( const char *path, void *raw, int nFileSize )
+/*
+===============================================================================
+
+	CUSTOM DECALS CACHE
+
+same sprays come again on every connect and map change,
+so remember validation verdict and decoded image by data MD5
+
+===============================================================================
+*/
+#define CUSTOM_HASH_SIZE	64
+#define CUSTOM_MAX_ENTRIES	1024
+
+typedef struct customcache_s
+{
+	struct customcache_s	*next;
+	byte		md5[16];	// of the raw file data
+	int		format;		// image decoder selected by file extension
+	qboolean		valid;
+	rgbdata_t		*image;		// pristine decoded image, may be dropped by budget
+	int		refcount;	// customizations created from this entry
+	uint		lastused;
+} customcache_t;
+
+static struct
+{
+	poolhandle_t	mempool;
+	customcache_t	*hash[CUSTOM_HASH_SIZE];
+	int		numentries;
+	size_t		imagebytes;
+	uint		sequence;
+	uint		decodes;
+	uint		hits;
+} custom_cache;
+
+CVAR_DEFINE_AUTO( custom_cachesize, "4", FCVAR_ARCHIVE, "megabytes of decoded custom decals kept to avoid decoding the same sprays again" );
+
+static int CustomDecal_Format( const char *path )
+{
+	if( !Q_stricmp( COM_FileExtension( path ), "png" ))
+		return 1;
+	if( !Q_stricmp( COM_FileExtension( path ), "wad" ))
+		return 2;
+	return 0;
+}
+
+static size_t CustomDecal_ImageSize( const rgbdata_t *pic )
 {
-	rgbdata_t *test = CustomDecal_LoadImage( path, raw, nFileSize );
+	return sizeof( *pic ) + pic->size + ( pic->palette ? 1024 : 0 );
+}
+
+static void CustomDecal_DataMD5( byte md5[16], const void *raw, int size )
+{
+	MD5Context_t	ctx;
+
+	MD5Init( &ctx );
+	MD5Update( &ctx, raw, size );
+	MD5Final( md5, &ctx );
+}
+
+static customcache_t *CustomDecal_FindEntry( const byte md5[16], int format )
+{
+	customcache_t	*entry;
 
-	if( test )
+	for( entry = custom_cache.hash[md5[0] & ( CUSTOM_HASH_SIZE - 1 )]; entry; entry = entry->next )
 	{
-		// all's ok, logo is valid
-		FS_FreeImage( test );
-		return true;
+		if( entry->format == format && !memcmp( entry->md5, md5, sizeof( entry->md5 )))
+			return entry;
 	}
 
-	return false;
+	return NULL;
+}
+
+static void CustomDecal_DropImage( customcache_t *entry )
+{
+	if( !entry->image )
+		return;
+
+	custom_cache.imagebytes -= CustomDecal_ImageSize( entry->image );
+	FS_FreeImage( entry->image );
+	entry->image = NULL;
+}
+
+/*
+==================
+CustomDecal_TrimCache
+
+drop least recently used unreferenced images until cache fits into budget,
+also keeps the number of remembered verdicts limited
+==================
+*/
+static void CustomDecal_TrimCache( void )
+{
+	size_t	budget = custom_cachesize.value > 0.0f ? (size_t)( custom_cachesize.value * 1024.0f * 1024.0f ) : 0;
+
+	while( custom_cache.imagebytes > budget || custom_cache.numentries > CUSTOM_MAX_ENTRIES )
+	{
+		customcache_t	*entry, **prev, **oldestprev = NULL;
+		qboolean		verdicts = custom_cache.imagebytes <= budget;
+		int		i;
+
+		for( i = 0; i < CUSTOM_HASH_SIZE; i++ )
+		{
+			for( prev = &custom_cache.hash[i]; ( entry = *prev ) != NULL; prev = &entry->next )
+			{
+				if( entry->refcount > 0 || ( !verdicts && !entry->image ))
+					continue;
+
+				if( !oldestprev || entry->lastused < (*oldestprev)->lastused )
+					oldestprev = prev;
+			}
+		}
+
+		if( !oldestprev )
+			break; // everything is in use
+
+		entry = *oldestprev;
+		CustomDecal_DropImage( entry );
+
+		if( verdicts )
+		{
+			*oldestprev = entry->next;
+			Mem_Free( entry );
+			custom_cache.numentries--;
+		}
+	}
+}
+
+/*
+==================
+CustomDecal_Acquire
+
+validates decal data, decoding it only if it wasn't seen before
+or decoded image is needed but was dropped from the cache
+==================
+*/
+static customcache_t *CustomDecal_Acquire( const char *path, void *raw, int size, qboolean needimage )
+{
+	int		format = CustomDecal_Format( path );
+	qboolean		keepimage = needimage;
+	customcache_t	*entry;
+	byte		md5[16];
+
+	CustomDecal_DataMD5( md5, raw, size );
+	entry = CustomDecal_FindEntry( md5, format );
+
+	if( !entry )
+	{
+		uint	hash = md5[0] & ( CUSTOM_HASH_SIZE - 1 );
+
+		entry = Mem_Calloc( custom_cache.mempool, sizeof( *entry ));
+		memcpy( entry->md5, md5, sizeof( entry->md5 ));
+		entry->format = format;
+		entry->next = custom_cache.hash[hash];
+		custom_cache.hash[hash] = entry;
+		custom_cache.numentries++;
+		needimage = true; // need a verdict anyway
+	}
+	else if( !entry->valid || entry->image || !needimage )
+	{
+		custom_cache.hits++;
+		needimage = false;
+	}
+
+	if( needimage )
+	{
+		entry->image = CustomDecal_LoadImage( path, raw, size );
+		entry->valid = entry->image != NULL;
+		custom_cache.decodes++;
+
+		if( entry->image )
+			custom_cache.imagebytes += CustomDecal_ImageSize( entry->image );
+
+		// validation only, e.g. on server
+		if( !keepimage )
+			CustomDecal_DropImage( entry );
+	}
+
+	entry->refcount++;
+	entry->lastused = ++custom_cache.sequence;
+
+	// this one is referenced, so it won't be dropped here
+	CustomDecal_TrimCache();
+
+	return entry;
+}
+
+static void CustomDecal_Release( const char *path, void *raw, int size )
+{
+	customcache_t	*entry;
+	byte		md5[16];
+
+	CustomDecal_DataMD5( md5, raw, size );
+	entry = CustomDecal_FindEntry( md5, CustomDecal_Format( path ));
+
+	if( entry && entry->refcount > 0 )
+		entry->refcount--;
+
+	CustomDecal_TrimCache();
+}
+
+static qboolean CustomDecal_IsCached( const customization_t *pCust )
+{
+	return pCust->bInUse && pCust->pBuffer && FBitSet( pCust->resource.ucFlags, RES_CUSTOM ) && pCust->resource.type == t_decal;
+}
+
+void COM_InitCustomizations( void )
+{
+	custom_cache.mempool = Mem_AllocPool( "Customizations Cache" );
+	Cvar_RegisterVariable( &custom_cachesize );
+}
+
+/*
+==================
+COM_ReleaseCustomization
+
+must be called before customization data is freed
+==================
+*/
+void COM_ReleaseCustomization( customization_t *pCust )
+{
+	if( CustomDecal_IsCached( pCust ))
+		CustomDecal_Release( pCust->resource.szFileName, pCust->pBuffer, pCust->resource.nDownloadSize );
 }
 
 void COM_ClearCustomizationList( customization_t *pHead, qboolean bCleanDecals )
@@ -57,6 +268,8 @@ void COM_ClearCustomizationList( customization_t *pHead, qboolean bCleanDecals )
 	{
 		pNext = pCurrent->pNext;
 
+		COM_ReleaseCustomization( pCurrent );
+
 		if( pCurrent->bInUse && pCurrent->pBuffer )
 			Mem_Free( pCurrent->pBuffer );
 
@@ -83,6 +296,8 @@ qboolean COM_CreateCustomization( customization_t *pListHead, resource_t *pResou
 	qboolean		bError = false;
 	fs_offset_t		checksize = 0;
 	customization_t	*pCust;
+	customcache_t	*entry;
+	qboolean		needimage;
 
 	if( pOut ) *pOut = NULL;
 
@@ -114,7 +329,10 @@ qboolean COM_CreateCustomization( customization_t *pListHead, resource_t *pResou
 	{
 		pCust->resource.playernum = playernumber;
 
-		if( CustomDecal_Validate( pResource->szFileName, pCust->pBuffer, pResource->nDownloadSize ))
+		needimage = !FBitSet( flags, FCUST_IGNOREINIT|FCUST_WIPEDATA );
+		entry = CustomDecal_Acquire( pResource->szFileName, pCust->pBuffer, pResource->nDownloadSize, needimage );
+
+		if( entry->valid )
 		{
 			if( !FBitSet( flags, FCUST_IGNOREINIT ))
 			{
@@ -124,8 +342,9 @@ qboolean COM_CreateCustomization( customization_t *pListHead, resource_t *pResou
 					pCust->nUserData1 = 0;
 					pCust->nUserData2 = 7;
 
-					if( !FBitSet( flags, FCUST_WIPEDATA ))
-						pCust->pInfo = CustomDecal_LoadImage( pResource->szFileName, pCust->pBuffer, pCust->resource.nDownloadSize );
+					// renderer modifies image on upload, so give away a copy
+					if( !FBitSet( flags, FCUST_WIPEDATA ) && entry->image )
+						pCust->pInfo = FS_CopyImage( entry->image );
 					else pCust->pInfo = NULL;
 					if( nLumps ) *nLumps = 1;
 				}
@@ -172,3 +391,93 @@ int COM_SizeofResourceList( resource_t *pList, resourceinfo_t *ri )
 
 	return nSize;
 }
+
+#if XASH_ENGINE_TESTS
+#include "tests.h"
+
+static void Test_CustomizationCache( void )
+{
+	rgbdata_t		rgb = { 0 };
+	customcache_t	*entry, *entry2;
+	float		oldsize = custom_cachesize.value;
+	fs_offset_t	size;
+	byte		junk[1024], *raw;
+	uint		decodes;
+	int		i;
+
+	Image_Setup();
+
+	// generate a valid logo
+	rgb.width = rgb.height = 64;
+	rgb.type = PF_RGBA_32;
+	rgb.flags = IMAGE_HAS_ALPHA;
+	rgb.size = rgb.width * rgb.height * 4;
+	rgb.buffer = Z_Malloc( rgb.size );
+
+	for( i = 0; i < rgb.size; i++ )
+		rgb.buffer[i] = (byte)( i * 7 );
+
+	TASSERT( FS_SaveImage( "test_logo.bmp", &rgb ))
+	Z_Free( rgb.buffer );
+
+	raw = FS_LoadFile( "test_logo.bmp", &size, false );
+	FS_Delete( "test_logo.bmp" );
+	TASSERT( raw != NULL )
+	if( !raw ) return;
+
+	// same logo for two players is decoded once
+	decodes = custom_cache.decodes;
+	entry = CustomDecal_Acquire( "test_logo.bmp", raw, size, true );
+	entry2 = CustomDecal_Acquire( "!md5.bmp", raw, size, true );
+	TASSERT( entry == entry2 )
+	TASSERT( entry->valid && entry->image != NULL )
+	TASSERT_EQi( entry->refcount, 2 )
+	TASSERT_EQi( custom_cache.decodes - decodes, 1 )
+
+	CustomDecal_Release( "test_logo.bmp", raw, size );
+	CustomDecal_Release( "!md5.bmp", raw, size );
+	TASSERT_EQi( entry->refcount, 0 )
+
+	// other decoder is another entry
+	entry2 = CustomDecal_Acquire( "test_logo.png", raw, size, false );
+	TASSERT( entry != entry2 && !entry2->valid )
+	CustomDecal_Release( "test_logo.png", raw, size );
+
+	// unreferenced image goes away when out of budget, verdict stays
+	custom_cachesize.value = 0.0f;
+	CustomDecal_TrimCache();
+	TASSERT( entry->image == NULL )
+
+	decodes = custom_cache.decodes;
+	entry = CustomDecal_Acquire( "test_logo.bmp", raw, size, false );
+	TASSERT( entry->valid )
+	TASSERT_EQi( custom_cache.decodes, decodes )
+	CustomDecal_Release( "test_logo.bmp", raw, size );
+
+	// but decoded again when image is really needed
+	custom_cachesize.value = oldsize;
+	entry = CustomDecal_Acquire( "test_logo.bmp", raw, size, true );
+	TASSERT( entry->image != NULL )
+	TASSERT_EQi( custom_cache.decodes - decodes, 1 )
+	CustomDecal_Release( "test_logo.bmp", raw, size );
+	Mem_Free( raw );
+
+	// broken logo is rejected once and then remembered
+	for( i = 0; i < sizeof( junk ); i++ )
+		junk[i] = (byte)( i * 13 + 5 );
+
+	decodes = custom_cache.decodes;
+	for( i = 0; i < 2; i++ )
+	{
+		entry = CustomDecal_Acquire( "test_badlogo.bmp", junk, sizeof( junk ), true );
+		TASSERT( !entry->valid && entry->image == NULL )
+		CustomDecal_Release( "test_badlogo.bmp", junk, sizeof( junk ));
+	}
+	TASSERT_EQi( custom_cache.decodes - decodes, 1 )
+}
+
+void Test_RunCustomization( void )
+{
+	TRUN( Test_CustomizationCache( ));
+}
+#endif /* XASH_ENGINE_TESTS */
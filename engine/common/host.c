@@ -1152,6 +1152,7 @@ static void Host_InitCommon( int argc, char **argv, const char *progname, qboole
 
 	Image_Init();
 	Sound_Init();
+	COM_InitCustomizations();
 
 #if XASH_ENGINE_TESTS
 	if( Sys_CheckParm( "-runtests" ))
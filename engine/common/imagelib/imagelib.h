@@ -172,6 +172,7 @@ qboolean Image_SaveWAD( const char *name, rgbdata_t *pix );
 //
 // img_quant.c
 //
+extern convar_t img_quantize_quality;
 rgbdata_t *Image_Quantize( rgbdata_t *pic );
 
 //
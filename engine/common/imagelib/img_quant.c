@@ -14,6 +14,7 @@ GNU General Public License for more details.
 */
 
 #include "imagelib.h"
+#include "xash3d_mathlib.h"
 
 #define palettesize 256
 #define netsize     255 // number of colours used
@@ -426,10 +427,106 @@ static void learn( void )
 	}
 }
 
+#define QUANT_HASH_BITS	16
+#define QUANT_HASH_SIZE	(1<<QUANT_HASH_BITS)
+#define QUANT_HASH_MAX	(QUANT_HASH_SIZE>>1)	// keep load factor under a half
+
+// color histogram entry, also used as nearest index cache
+typedef struct
+{
+	uint	key;	// packed rgb + 1, zero for empty slot
+	int	value;	// pixel count, palette index after mapping
+} quantslot_t;
+
+CVAR_DEFINE_AUTO( img_quantize_quality, "10", FCVAR_ARCHIVE, "percent of pixels sampled while learning a palette for indexed images, 10 is classic quality, 100 is best" );
+
+static uint Image_QuantKey( const byte *pix )
+{
+	return (( pix[0] << 16 ) | ( pix[1] << 8 ) | pix[2] ) + 1;
+}
+
+static uint Image_QuantHash( uint key )
+{
+	return ( key * 2654435761u ) >> ( 32 - QUANT_HASH_BITS );
+}
+
+static int Image_QuantSampleFactor( void )
+{
+	int	quality = bound( 1, (int)img_quantize_quality.value, 100 );
+
+	return bound( 1, 100 / quality, 30 );
+}
+
+/*
+=================
+Image_QuantHistogram
+
+count unique colors of the image,
+returns -1 if there are too many of them
+=================
+*/
+static int Image_QuantHistogram( quantslot_t *table, const byte *pix, int numpixels, int bpp )
+{
+	int	i, numcolors = 0;
+
+	for( i = 0; i < numpixels; i++, pix += bpp )
+	{
+		uint	key = Image_QuantKey( pix );
+		uint	h = Image_QuantHash( key );
+
+		while( table[h].key && table[h].key != key )
+			h = ( h + 1 ) & ( QUANT_HASH_SIZE - 1 );
+
+		if( !table[h].key )
+		{
+			if( numcolors == QUANT_HASH_MAX )
+				return -1;
+
+			table[h].key = key;
+			numcolors++;
+		}
+
+		table[h].value++;
+	}
+
+	return numcolors;
+}
+
+/*
+=================
+Image_QuantLookup
+
+with complete histogram every color is already mapped,
+otherwise table works as direct mapped cache of inxsearch
+=================
+*/
+static int Image_QuantLookup( quantslot_t *table, const byte *pix, qboolean complete )
+{
+	uint	key = Image_QuantKey( pix );
+	uint	h = Image_QuantHash( key );
+
+	if( complete )
+	{
+		while( table[h].key != key )
+			h = ( h + 1 ) & ( QUANT_HASH_SIZE - 1 );
+		return table[h].value;
+	}
+
+	if( table[h].key != key )
+	{
+		table[h].key = key;
+		table[h].value = inxsearch( pix[0], pix[1], pix[2] );
+	}
+
+	return table[h].value;
+}
+
 // returns the actual number of palette entries.
 rgbdata_t *Image_Quantize( rgbdata_t *pic )
 {
-	int	i;
+	quantslot_t	*table;
+	const byte	*pix;
+	int		i, j, numcolors;
 
 	// quick case to reject unneeded conversions
 	if( pic->type == PF_INDEXED_24 || pic->type ==  PF_INDEXED_32 )
@@ -442,34 +539,61 @@ rgbdata_t *Image_Quantize( rgbdata_t *pic )
 
 	// allocate 8-bit buffer
 	image.tempbuffer = Mem_Realloc( host.imagepool, image.tempbuffer, image.size );
+	table = Mem_Calloc( host.imagepool, sizeof( *table ) * QUANT_HASH_SIZE );
+	pic->palette = Mem_Calloc( host.imagepool, palettesize * 3 );
 
-	initnet( pic->buffer, pic->size, 10 );
-	learn();
-	unbiasnet();
-
-	pic->palette = Mem_Malloc( host.imagepool, palettesize * 3 );
+	numcolors = Image_QuantHistogram( table, pic->buffer, image.size, image.bpp );
 
-	for( i = 0; i < netsize; i++ )
+	if( numcolors >= 0 && numcolors <= netsize )
 	{
-		pic->palette[i*3+0] = network[i][0];	// red
-		pic->palette[i*3+1] = network[i][1];	// green
-		pic->palette[i*3+2] = network[i][2];	// blue
-	}
+		// image already fits into palette, keep colors as is
+		for( i = j = 0; i < QUANT_HASH_SIZE; i++ )
+		{
+			uint	color = table[i].key - 1;
 
-	for( ; i < palettesize; i++ )
-	{
-		pic->palette[i*3+0] = 0;
-		pic->palette[i*3+1] = 0;
-		pic->palette[i*3+2] = 0;
+			if( !table[i].key )
+				continue;
+
+			pic->palette[j*3+0] = ( color >> 16 ) & 0xFF;	// red
+			pic->palette[j*3+1] = ( color >> 8 ) & 0xFF;	// green
+			pic->palette[j*3+2] = color & 0xFF;		// blue
+			table[i].value = j++;
+		}
 	}
+	else
+	{
+		initnet( pic->buffer, pic->size, Image_QuantSampleFactor( ));
+		learn();
+		unbiasnet();
 
-	inxbuild();
+		for( i = 0; i < netsize; i++ )
+		{
+			pic->palette[i*3+0] = network[i][0];	// red
+			pic->palette[i*3+1] = network[i][1];	// green
+			pic->palette[i*3+2] = network[i][2];	// blue
+		}
 
-	for( i = 0; i < image.width * image.height; i++ )
-	{
-		image.tempbuffer[i] = inxsearch( pic->buffer[i*image.bpp+0], pic->buffer[i*image.bpp+1], pic->buffer[i*image.bpp+2] );
+		inxbuild();
+
+		if( numcolors >= 0 )
+		{
+			// search each unique color only once
+			for( i = 0; i < QUANT_HASH_SIZE; i++ )
+			{
+				uint	color = table[i].key - 1;
+
+				if( table[i].key )
+					table[i].value = inxsearch(( color >> 16 ) & 0xFF, ( color >> 8 ) & 0xFF, color & 0xFF );
+			}
+		}
+		else memset( table, 0, sizeof( *table ) * QUANT_HASH_SIZE );
 	}
 
+	for( i = 0, pix = pic->buffer; i < image.size; i++, pix += image.bpp )
+		image.tempbuffer[i] = Image_QuantLookup( table, pix, numcolors >= 0 );
+
+	Mem_Free( table );
+
 	pic->buffer = Mem_Realloc( host.imagepool, pic->buffer, image.size );
 	memcpy( pic->buffer, image.tempbuffer, image.size );
 	pic->type = PF_INDEXED_24;
@@ -477,3 +601,120 @@ rgbdata_t *Image_Quantize( rgbdata_t *pic )
 
 	return pic;
 }
+
+#if XASH_ENGINE_TESTS
+#include "tests.h"
+
+static rgbdata_t *Test_QuantMakeImage( int kind, int width, int height )
+{
+	rgbdata_t	*pic = Mem_Calloc( host.imagepool, sizeof( *pic ));
+	uint	seed = 0x12345678;
+	byte	*pix;
+	int	i, j;
+
+	pic->width = width;
+	pic->height = height;
+	pic->type = PF_RGBA_32;
+	pic->size = width * height * 4;
+	pic->buffer = pix = Mem_Malloc( host.imagepool, pic->size );
+
+	for( i = 0; i < height; i++ )
+	{
+		for( j = 0; j < width; j++, pix += 4 )
+		{
+			double	x = ( j / (double)width ) - 0.5;
+			double	y = ( i / (double)height ) - 0.5;
+			double	d = sqrt( x * x + y * y );
+
+			switch( kind )
+			{
+			case 0: // flat blocks, fits into palette
+				pix[0] = ( i / 32 ) * 32;
+				pix[1] = ( j / 32 ) * 32;
+				pix[2] = (( i / 32 + j / 32 ) & 1 ) * 255;
+				break;
+			case 1: // smooth rings
+				pix[0] = (byte)(( sin( d * 30.0 ) + 1.0 ) * 126 );
+				pix[1] = (byte)(( sin( d * 27.723 ) + 1.0 ) * 126 );
+				pix[2] = (byte)(( sin( d * 42.41 ) + 1.0 ) * 126 );
+				break;
+			default: // gradient with noise, too many colors for histogram
+				seed = seed * 1664525 + 1013904223;
+				pix[0] = bound( 0, (int)( x * 400.0 + 128 ) + (int)(( seed >> 24 ) & 15 ), 255 );
+				pix[1] = bound( 0, (int)( y * 400.0 + 128 ) + (int)(( seed >> 16 ) & 15 ), 255 );
+				pix[2] = (byte)( d * 300.0 ) ^ (( seed >> 8 ) & 15 );
+				break;
+			}
+			pix[3] = 255;
+		}
+	}
+
+	return pic;
+}
+
+static void Test_QuantFreeImage( rgbdata_t *pic )
+{
+	Mem_Free( pic->buffer );
+	if( pic->palette ) Mem_Free( pic->palette );
+	Mem_Free( pic );
+}
+
+static double Test_QuantImage( int kind, float quality, double *error, qboolean *mapped )
+{
+	rgbdata_t	*src = Test_QuantMakeImage( kind, 512, 512 );
+	rgbdata_t	*pic = Test_QuantMakeImage( kind, 512, 512 );
+	float	oldquality = img_quantize_quality.value;
+	double	t, sum = 0.0;
+	int	i;
+
+	img_quantize_quality.value = quality;
+	t = Sys_DoubleTime();
+	Image_Quantize( pic );
+	t = Sys_DoubleTime() - t;
+	img_quantize_quality.value = oldquality;
+
+	*mapped = true;
+
+	for( i = 0; i < pic->size; i++ )
+	{
+		const byte	*in = &src->buffer[i*4];
+		const byte	*out = &pic->palette[pic->buffer[i]*3];
+
+		sum += abs( in[0] - out[0] ) + abs( in[1] - out[1] ) + abs( in[2] - out[2] );
+
+		// cached lookup must give the same index as full search
+		if( kind != 0 && pic->buffer[i] != inxsearch( in[0], in[1], in[2] ))
+			*mapped = false;
+	}
+
+	*error = sum / pic->size;
+
+	Test_QuantFreeImage( src );
+	Test_QuantFreeImage( pic );
+
+	return t * 1000.0;
+}
+
+void Test_RunImageQuantize( void )
+{
+	const char	*names[] = { "blocks", "rings", "noise" };
+	const float	maxerror[] = { 0.0f, 8.0f, 20.0f };
+	const float	qualities[] = { 4.0f, 10.0f, 100.0f };
+	int	i, j;
+
+	for( i = 0; i < sizeof( names ) / sizeof( names[0] ); i++ )
+	{
+		for( j = 0; j < sizeof( qualities ) / sizeof( qualities[0] ); j++ )
+		{
+			qboolean	mapped;
+			double	error, msec;
+
+			msec = Test_QuantImage( i, qualities[j], &error, &mapped );
+			Con_Printf( "Image_Quantize: %s quality %g: %.2f ms, mean error %.2f\n", names[i], qualities[j], msec, error );
+
+			TASSERT( mapped )
+			TASSERT( error <= maxerror[i] )
+		}
+	}
+}
+#endif /* XASH_ENGINE_TESTS */
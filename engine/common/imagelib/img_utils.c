@@ -144,6 +144,7 @@ void Image_Init( void )
 {
 	// init pools
 	host.imagepool = Mem_AllocPool( "ImageLib Pool" );
+	Cvar_RegisterVariable( &img_quantize_quality );
 
 	// install image formats (can be re-install later by Image_Setup)
 	switch( host.type )
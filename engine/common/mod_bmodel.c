@@ -24,6 +24,7 @@ GNU General Public License for more details.
 #include "client.h"
 #include "server.h"			// LUMP_ error codes
 #include "ref_common.h"
+#include "pm_local.h"
 #if defined( HAVE_OPENMP )
 #include <omp.h>
 #endif // HAVE_OPENMP
@@ -128,6 +129,8 @@ typedef struct
 	byte			*shadowdata_out;	// occlusion data pointer
 	dclipnode32_t		*clipnodes_out;	// temporary 32-bit array to hold clipnodes
 
+	struct mipwad_s		*mipwads;		// texture to WAD resolution, valid while textures are loading
+
 	// misc stuff
 	int       lightmap_samples;	// samples per lightmap (1 or 3)
 	int       version;		// model version
@@ -143,6 +146,13 @@ typedef struct
 	size_t		count;
 } mlumpstat_t;
 
+typedef struct mipwad_s
+{
+	searchpath_t	*sp;		// archive that contains the texture
+	int		pack_ind;		// lump index inside the archive
+	int		wadindex;		// index in world.wadlist or -1 if not found in WADs
+} mipwad_t;
+
 typedef struct
 {
 	char		name[64];		// just for debug
@@ -150,6 +160,17 @@ typedef struct
 	// count errors and warnings
 	int		numerrors;
 	int		numwarnings;
+
+	// load time breakdown, in seconds
+	double		totaltime;
+	double		lumpstime;
+	double		texturestime;	// including wadresolvetime
+	double		wadresolvetime;
+
+	// texture to WAD resolution stats
+	int		numwadarchives;
+	int		numwadprobes;
+	int		numwadtextures;
 } loadstat_t;
 
 #define CHECK_OVERFLOW	BIT( 0 )		// if some of lumps will be overflowed this non fatal for us. But some lumps are critical. mark them
@@ -176,6 +197,7 @@ typedef struct
 world_static_t		world;
 static dbspmodel_t		srcmodel;
 static loadstat_t		loadstat;
+static loadstat_t		worldloadstat;	// copy of the last world loadstat for mapstats
 static model_t		*worldmodel;
 static byte		g_visdata[(MAX_MAP_LEAFS+7)/8];	// intermediate buffer
 static mlumpstat_t worldstats[HEADER_LUMPS+EXTRA_LUMPS];
@@ -434,52 +456,37 @@ static mip_t *Mod_GetMipTexForTexture( dbspmodel_t *bmod, int i )
 }
 
 // Returns index of WAD that texture was found in, or -1 if not found.
-static int Mod_LoadTextureFromWadList( wadlist_t *list, const char *name, rgbdata_t **pic, char *texpath, size_t texpathlen )
+static int Mod_LoadTextureFromWad( const mipwad_t *entry, const char *name, rgbdata_t **pic, char *texpath, size_t texpathlen )
 {
-	int i;
+	const char *wadname;
+	fs_offset_t len;
+	byte *buf;
+	char file[MAX_VA_STRING];
 
-	if( !list || !COM_CheckString( name ))
+	if( !entry || entry->wadindex < 0 )
 		return -1;
 
-	// check wads in reverse order
-	for( i = list->count - 1; i >= 0; i-- )
-	{
-		searchpath_t *sp = NULL;
-
-		while(( sp = g_fsapi.GetArchiveByName( list->wadnames[i], sp )))
-		{
-			fs_offset_t len;
-			byte *buf;
-			char file[MAX_VA_STRING];
-			int pack_ind;
-
-			Q_snprintf( file, sizeof( file ), "%s.mip", name );
-			pack_ind = g_fsapi.FindFileInArchive( sp, file, NULL, 0 );
-
-			if( pack_ind < 0 )
-				continue;
+	wadname = world.wadlist.wadnames[entry->wadindex];
 
-			if( texpath != NULL )
-				Q_snprintf( texpath, texpathlen, "%s/%s.mip", list->wadnames[i], name );
+	if( texpath != NULL )
+		Q_snprintf( texpath, texpathlen, "%s/%s.mip", wadname, name );
 
-			if( pic == NULL )
-				return i; // dedicated server don't want to load the textures (why?)
+	if( pic == NULL )
+		return entry->wadindex; // dedicated server don't want to load the textures (why?)
 
-			if( !( buf = g_fsapi.LoadFileFromArchive( sp, file, pack_ind, &len, false )))
-			{
-				*pic = NULL;
-				return i; // corrupted file, don't ignore it
-			}
+	Q_snprintf( file, sizeof( file ), "%s.mip", name );
 
-			// tell imagelib to directly load this texture to save time
-			Q_snprintf( file, sizeof( file ), "#%s/%s.mip", list->wadnames[i], name );
-			*pic = FS_LoadImage( file, buf, len );
-			Mem_Free( buf );
-			return i; // if file is corrupted, it's fine, we want to tell the user about it
-		}
+	if( !( buf = g_fsapi.LoadFileFromArchive( entry->sp, file, entry->pack_ind, &len, false )))
+	{
+		*pic = NULL;
+		return entry->wadindex; // corrupted file, don't ignore it
 	}
 
-	return -1;
+	// tell imagelib to directly load this texture to save time
+	Q_snprintf( file, sizeof( file ), "#%s/%s.mip", wadname, name );
+	*pic = FS_LoadImage( file, buf, len );
+	Mem_Free( buf );
+	return entry->wadindex; // if file is corrupted, it's fine, we want to tell the user about it
 }
 
 static fs_offset_t Mod_CalculateMipTexSize( const mip_t *mt, qboolean palette )
@@ -752,6 +759,22 @@ static int Mod_GlobUsage( const char *szItem, int itemstorage, int maxstorage )
 	return itemstorage;
 }
 
+/*
+=============
+Mod_PrintLoadTimes
+
+Load time breakdown of the world
+=============
+*/
+static void Mod_PrintLoadTimes( const loadstat_t *stat, void (*pfnPrint)( const char *fmt, ... ))
+{
+	pfnPrint( "load time: %.1f ms (lumps %.1f ms, textures %.1f ms, other %.1f ms)\n", stat->totaltime * 1000.0,
+		stat->lumpstime * 1000.0, stat->texturestime * 1000.0,
+		( stat->totaltime - stat->lumpstime - stat->texturestime ) * 1000.0 );
+	pfnPrint( "wad textures: %i resolved with %i lookups in %i archives, %.2f ms\n", stat->numwadtextures,
+		stat->numwadprobes, stat->numwadarchives, stat->wadresolvetime * 1000.0 );
+}
+
 /*
 =============
 Mod_PrintWorldStats_f
@@ -795,6 +818,14 @@ void Mod_PrintWorldStats_f( void )
 	Con_Printf( "internal name: ^2%s\n", world.message[0] ? world.message : "none" );
 	Con_Printf( "map compiler: ^3%s\n", world.compiler[0] ? world.compiler : "unknown" );
 	Con_Printf( "map editor: ^2%s\n", world.generator[0] ? world.generator : "unknown" );
+
+	Mod_PrintLoadTimes( &worldloadstat, Con_Printf );
+
+	if( pm_surfcachestats.hits + pm_surfcachestats.misses )
+	{
+		Con_Printf( "surface trace cache: %u hits, %u misses (%.1f%% hit rate)\n", pm_surfcachestats.hits, pm_surfcachestats.misses,
+			pm_surfcachestats.hits * 100.0 / ( pm_surfcachestats.hits + pm_surfcachestats.misses ));
+	}
 }
 
 /*
@@ -2626,7 +2657,7 @@ static void Mod_LoadTextureData( model_t *mod, dbspmodel_t *bmod, int textureInd
 	if( !texture->gl_texturenum && (( r_wadtextures.value && world.wadlist.count > 0 ) || mipTex->offsets[0] <= 0 ))
 	{
 		rgbdata_t *pic = NULL;
-		int wadIndex = Mod_LoadTextureFromWadList( &world.wadlist, mipTex->name, Host_IsDedicated() ? NULL : &pic, texpath, sizeof( texpath ));
+		int wadIndex = Mod_LoadTextureFromWad( &bmod->mipwads[textureIndex], mipTex->name, Host_IsDedicated() ? NULL : &pic, texpath, sizeof( texpath ));
 
 		if( wadIndex >= 0 )
 		{
@@ -2697,7 +2728,7 @@ static void Mod_LoadTextureData( model_t *mod, dbspmodel_t *bmod, int textureInd
 			// NOTE: We can't load the _luma texture from the WAD as normal because it
 			// doesn't exist there. The original texture is already loaded, but cannot be modified.
 			// Instead, load the original texture again and convert it to luma.
-			wadIndex = Mod_LoadTextureFromWadList( &world.wadlist, texture->name, &pic, NULL, 0 );
+			wadIndex = Mod_LoadTextureFromWad( &bmod->mipwads[textureIndex], texture->name, &pic, NULL, 0 );
 
 			if( wadIndex >= 0 && pic != NULL )
 			{
@@ -2729,9 +2760,6 @@ static void Mod_LoadTexture( model_t *mod, dbspmodel_t *bmod, int textureIndex )
 		return;
 	}
 
-	if( mipTex->name[0] == '\0' )
-		Q_snprintf( mipTex->name, sizeof( mipTex->name ), "miptex_%i", textureIndex );
-
 	texture = (texture_t *)Mem_Calloc( mod->mempool, sizeof( *texture ));
 	mod->textures[textureIndex] = texture;
 
@@ -2744,12 +2772,112 @@ static void Mod_LoadTexture( model_t *mod, dbspmodel_t *bmod, int textureIndex )
 	Mod_LoadTextureData( mod, bmod, textureIndex );
 }
 
+/*
+=================
+Mod_ResolveWadTextures
+
+Finds the WAD for every miptex of the model in one pass,
+so texture loading doesn't search the whole wadlist per texture
+=================
+*/
+static void Mod_ResolveWadTextures( model_t *mod, dbspmodel_t *bmod )
+{
+	wadlist_t *list = &world.wadlist;
+	searchpath_t **archives = NULL;
+	int first[MAX_MAP_WADS + 1];
+	int i, j, k, numarchives = 0, maxarchives = 0;
+	char file[MAX_VA_STRING];
+
+	bmod->mipwads = Mem_Malloc( mod->mempool, mod->numtextures * sizeof( mipwad_t ));
+
+	for( i = 0; i < mod->numtextures; i++ )
+	{
+		mip_t *mipTex = Mod_GetMipTexForTexture( bmod, i );
+
+		bmod->mipwads[i].sp = NULL;
+		bmod->mipwads[i].pack_ind = -1;
+		bmod->mipwads[i].wadindex = -1;
+
+		if( mipTex && mipTex->name[0] == '\0' )
+			Q_snprintf( mipTex->name, sizeof( mipTex->name ), "miptex_%i", i );
+	}
+
+	if( list->count <= 0 )
+		return;
+
+	// index the archives of every WAD name once, wadlist can reference the same name in several search paths
+	for( i = 0; i < list->count; i++ )
+	{
+		searchpath_t *sp = NULL;
+
+		first[i] = numarchives;
+
+		while(( sp = g_fsapi.GetArchiveByName( list->wadnames[i], sp )))
+		{
+			if( numarchives == maxarchives )
+			{
+				maxarchives = maxarchives ? maxarchives * 2 : list->count;
+				archives = Z_Realloc( archives, maxarchives * sizeof( *archives ));
+			}
+
+			archives[numarchives++] = sp;
+		}
+	}
+
+	first[list->count] = numarchives;
+	loadstat.numwadarchives = numarchives;
+
+	// join miptex names against the archives, last WAD wins like before
+	for( i = 0; i < mod->numtextures && numarchives > 0; i++ )
+	{
+		mipwad_t *out = &bmod->mipwads[i];
+		const mip_t *mipTex = Mod_GetMipTexForTexture( bmod, i );
+
+		if( !mipTex )
+			continue;
+
+		// embedded texture and WADs aren't preferred, nothing to look for
+		if( !r_wadtextures.value && mipTex->offsets[0] > 0 )
+			continue;
+
+		Q_snprintf( file, sizeof( file ), "%s.mip", mipTex->name );
+
+		for( j = list->count - 1; j >= 0 && out->wadindex < 0; j-- )
+		{
+			for( k = first[j]; k < first[j + 1]; k++ )
+			{
+				loadstat.numwadprobes++;
+				out->pack_ind = g_fsapi.FindFileInArchive( archives[k], file, NULL, 0 );
+
+				if( out->pack_ind >= 0 )
+				{
+					out->sp = archives[k];
+					out->wadindex = j;
+					loadstat.numwadtextures++;
+					break;
+				}
+			}
+		}
+	}
+
+	if( archives )
+		Mem_Free( archives );
+}
+
 static void Mod_LoadAllTextures( model_t *mod, dbspmodel_t *bmod )
 {
+	double start = Sys_DoubleTime();
 	int i;
 
+	Mod_ResolveWadTextures( mod, bmod );
+	loadstat.wadresolvetime = Sys_DoubleTime() - start;
+
 	for( i = 0; i < mod->numtextures; i++ )
 		Mod_LoadTexture( mod, bmod, i );
+
+	Mem_Free( bmod->mipwads );
+	bmod->mipwads = NULL;
+	loadstat.texturestime = Sys_DoubleTime() - start;
 }
 
 static void Mod_SequenceAnimatedTexture( model_t *mod, int baseTextureIndex )
@@ -3442,6 +3570,7 @@ static void Mod_CalcPHS( model_t *mod )
 		total_compressed_size += compressed_size;
 	}
 
+	world.phssize = total_compressed_size;
 	t2 = Platform_DoubleTime();
 
 	if( vis_stats )
@@ -3472,8 +3601,538 @@ static void Mod_CalcPHS( model_t *mod )
 
 	// release uncompressed data
 	Mem_Free( uncompressed_pvs );
+}
+
+#define GRID_CELL_SIZE	32.0f	// initial cell size, doubled until grid fits
+#define GRID_MAX_CELLS	( 1 << 20 )
+#define GRID_MARGIN		1.0f	// keeps cells that touch a plane out of uniform set
+#define GRID_NODE_BUDGET	256	// give up classifying a box after this many nodes
+
+/*
+===========
+Mod_PlaneBoxDiff
+
+returns signed distances of the nearest and farthest box corners
+===========
+*/
+static void Mod_PlaneBoxDiff( const mplane_t *plane, const vec3_t mins, const vec3_t maxs, double *dmin, double *dmax )
+{
+	int	i;
+
+	if( plane->type < 3 )
+	{
+		*dmin = (double)mins[plane->type] - plane->dist;
+		*dmax = (double)maxs[plane->type] - plane->dist;
+		return;
+	}
+
+	*dmin = *dmax = -plane->dist;
+
+	for( i = 0; i < 3; i++ )
+	{
+		if( plane->normal[i] >= 0.0f )
+		{
+			*dmin += (double)plane->normal[i] * mins[i];
+			*dmax += (double)plane->normal[i] * maxs[i];
+		}
+		else
+		{
+			*dmin += (double)plane->normal[i] * maxs[i];
+			*dmax += (double)plane->normal[i] * mins[i];
+		}
+	}
+}
+
+/*
+===========
+Mod_HullBoxContents_r
+
+===========
+*/
+static int Mod_HullBoxContents_r( hull_t *hull, int num, const vec3_t mins, const vec3_t maxs, int *budget )
+{
+	const mplane_t	*plane;
+	int		children[2];
+	double		dmin, dmax;
+	int		c0, c1;
+
+	while( num >= 0 )
+	{
+		if( --( *budget ) < 0 )
+			return CONTENTS_NONE;
+
+		if( world.version == QBSP2_VERSION )
+		{
+			plane = &hull->planes[hull->clipnodes32[num].planenum];
+			children[0] = hull->clipnodes32[num].children[0];
+			children[1] = hull->clipnodes32[num].children[1];
+		}
+		else
+		{
+			plane = &hull->planes[hull->clipnodes16[num].planenum];
+			children[0] = hull->clipnodes16[num].children[0];
+			children[1] = hull->clipnodes16[num].children[1];
+		}
+
+		Mod_PlaneBoxDiff( plane, mins, maxs, &dmin, &dmax );
+
+		if( dmin >= 0.0 )
+			num = children[0];
+		else if( dmax < 0.0 )
+			num = children[1];
+		else
+		{
+			c0 = Mod_HullBoxContents_r( hull, children[0], mins, maxs, budget );
+			if( c0 == CONTENTS_NONE )
+				return CONTENTS_NONE;
+
+			c1 = Mod_HullBoxContents_r( hull, children[1], mins, maxs, budget );
+			return c0 == c1 ? c0 : CONTENTS_NONE;
+		}
+	}
+
+	return num;
+}
+
+/*
+===========
+Mod_HullBoxContents
+
+returns contents shared by every point of the box
+or CONTENTS_NONE if box crosses several leafs
+===========
+*/
+int Mod_HullBoxContents( hull_t *hull, const vec3_t mins, const vec3_t maxs )
+{
+	int	budget = GRID_NODE_BUDGET;
+
+	return Mod_HullBoxContents_r( hull, hull->firstclipnode, mins, maxs, &budget );
+}
+
+/*
+===========
+Mod_FillContentsGrid_r
+
+classify a block of cells at once, split it in half if it's not uniform
+===========
+*/
+static void Mod_FillContentsGrid_r( contentsgrid_t *grid, hull_t *hull, const int lo[3], const int hi[3], int *numfilled )
+{
+	const float	cellsize = 1.0f / grid->scale;
+	int		y, z, axis, contents;
+	int		mid[3];
+	vec3_t		mins, maxs;
+
+	for( axis = 0; axis < 3; axis++ )
+	{
+		mins[axis] = grid->origin[axis] + lo[axis] * cellsize - GRID_MARGIN;
+		maxs[axis] = grid->origin[axis] + hi[axis] * cellsize + GRID_MARGIN;
+	}
+
+	contents = Mod_HullBoxContents( hull, mins, maxs );
+
+	if( contents != CONTENTS_NONE && contents >= SCHAR_MIN )
+	{
+		for( z = lo[2]; z < hi[2]; z++ )
+		{
+			for( y = lo[1]; y < hi[1]; y++ )
+			{
+				signed char *row = &grid->cells[( z * grid->size[1] + y ) * grid->size[0]];
+				memset( &row[lo[0]], contents, hi[0] - lo[0] );
+			}
+		}
+
+		*numfilled += ( hi[0] - lo[0] ) * ( hi[1] - lo[1] ) * ( hi[2] - lo[2] );
+		return;
+	}
+
+	// split the longest side
+	axis = 0;
+	if( hi[1] - lo[1] > hi[axis] - lo[axis] ) axis = 1;
+	if( hi[2] - lo[2] > hi[axis] - lo[axis] ) axis = 2;
+
+	// a single mixed cell, leave it to the hull
+	if( hi[axis] - lo[axis] <= 1 )
+		return;
+
+	VectorCopy( hi, mid );
+	mid[axis] = ( lo[axis] + hi[axis] ) / 2;
+	Mod_FillContentsGrid_r( grid, hull, lo, mid, numfilled );
+
+	VectorCopy( lo, mid );
+	mid[axis] = ( lo[axis] + hi[axis] ) / 2;
+	Mod_FillContentsGrid_r( grid, hull, mid, hi, numfilled );
+}
+
+/*
+===========
+Mod_BuildContentsGrid
+
+precompute hull contents of uniform cells within the bounds,
+cells that cross any plane are left to the regular hull walk
+===========
+*/
+void Mod_BuildContentsGrid( contentsgrid_t *grid, hull_t *hull, const vec3_t mins, const vec3_t maxs, float cellsize, poolhandle_t mempool )
+{
+	int	lo[3] = { 0, 0, 0 };
+	int	numfilled = 0;
+	size_t	count;
+	int	i;
+
+	memset( grid, 0, sizeof( *grid ));
+
+	if( !hull || hull->firstclipnode > hull->lastclipnode )
+		return;
+
+	while( 1 )
+	{
+		for( i = 0; i < 3; i++ )
+			grid->size[i] = Q_max( 1, (int)ceilf(( maxs[i] - mins[i] ) / cellsize ));
+
+		count = (size_t)grid->size[0] * grid->size[1] * grid->size[2];
+		if( count <= GRID_MAX_CELLS )
+			break;
+
+		cellsize *= 2.0f;
+	}
+
+	VectorCopy( mins, grid->origin );
+	grid->scale = 1.0f / cellsize;
+	grid->cells = Mem_Calloc( mempool, count ); // CONTENTS_NONE
+
+	Mod_FillContentsGrid_r( grid, hull, lo, grid->size, &numfilled );
+
+	Con_Reportf( "Contents grid: %ix%ix%i cells of %g units, %s, %.1f%% uniform\n",
+		grid->size[0], grid->size[1], grid->size[2], cellsize, Q_memprint( count ), numfilled * 100.0 / count );
+}
+
+/*
+===========
+Mod_GridPointContents
+
+same as PM_HullPointContents but looks up the grid first
+===========
+*/
+int Mod_GridPointContents( const contentsgrid_t *grid, hull_t *hull, int num, const vec3_t p )
+{
+	if( grid && grid->cells && num == hull->firstclipnode )
+	{
+		float	x = ( p[0] - grid->origin[0] ) * grid->scale;
+		float	y = ( p[1] - grid->origin[1] ) * grid->scale;
+		float	z = ( p[2] - grid->origin[2] ) * grid->scale;
+
+		// also rejects NaNs
+		if( x >= 0.0f && y >= 0.0f && z >= 0.0f && x < grid->size[0] && y < grid->size[1] && z < grid->size[2] )
+		{
+			int contents = grid->cells[((int)z * grid->size[1] + (int)y ) * grid->size[0] + (int)x];
+
+			if( contents != CONTENTS_NONE )
+				return contents;
+		}
+	}
+
+	return PM_HullPointContents( hull, num, p );
+}
+
+/*
+===========
+Mod_WorldPointContents
+
+hull 0 contents of any brush model, uses the grid for world
+===========
+*/
+int Mod_WorldPointContents( model_t *mod, const vec3_t p )
+{
+	const contentsgrid_t *grid = FBitSet( mod->flags, MODEL_WORLD ) ? &world.contentsgrid : NULL;
+
+	return Mod_GridPointContents( grid, &mod->hulls[0], mod->hulls[0].firstclipnode, p );
+}
+
+/*
+===========
+Mod_CalcContentsGrid
+
+To be called while loading world
+===========
+*/
+static void Mod_CalcContentsGrid( model_t *mod )
+{
+	double	t1, t2;
+
+	// world hull 0 always starts from node 0, see SV_TruePointContents
+	if( mod->hulls[0].firstclipnode != 0 )
+		return;
+
+	t1 = Platform_DoubleTime();
+	Mod_BuildContentsGrid( &world.contentsgrid, &mod->hulls[0], mod->mins, mod->maxs, GRID_CELL_SIZE, mod->mempool );
+	t2 = Platform_DoubleTime();
+
+	Con_Reportf( "Contents grid building time: %.2f ms\n", ( t2 - t1 ) * 1000.0f );
+}
+
+/*
+===============================================================================
+
+			PRECOMPUTED WORLD DATA CACHE
+
+===============================================================================
+*/
+#define BSPCACHE_IDENT	(('C'<<24)+('S'<<16)+('B'<<8)+'X') // little-endian "XBSC"
+#define BSPCACHE_VERSION	1	// bump when PHS or contents grid building is changed
+
+typedef struct dbspcache_s
+{
+	int	ident;
+	int	version;
+	int	buildnum;		// engine build that wrote the file
+	dword	checksum;		// of the lumps that cached data is built from
+	int	numleafs;
+	int	visbytes;
+	int	phssize;		// compressed PHS size, 0 if wasn't built
+	int	gridsize[3];	// contents grid cells per axis, zeroes if wasn't built
+	vec3_t	gridorigin;
+	float	gridscale;
+} dbspcache_t;
+
+/*
+=================
+Mod_BspCacheChecksum
+
+PHS depends on visibility and leafs,
+contents grid on planes, nodes and world bounds
+=================
+*/
+static dword Mod_BspCacheChecksum( const byte *mod_base )
+{
+	const dheader_t *header = (const dheader_t *)mod_base;
+	const int lumps[] = { srclumps[1].lumpnumber, LUMP_VISIBILITY, LUMP_NODES, LUMP_LEAFS, LUMP_MODELS };
+	CRC32_t crc;
+	int i;
+
+	CRC32_Init( &crc );
+	CRC32_ProcessBuffer( &crc, &header->version, sizeof( header->version ));
+
+	for( i = 0; i < ARRAYSIZE( lumps ); i++ )
+	{
+		const dlump_t *l = &header->lumps[lumps[i]];
+
+		CRC32_ProcessBuffer( &crc, &l->filelen, sizeof( l->filelen ));
+		if( l->filelen > 0 )
+			CRC32_ProcessBuffer( &crc, mod_base + l->fileofs, l->filelen );
+	}
+
+	return CRC32_Final( crc );
+}
+
+/*
+=================
+Mod_BspCachePath
+=================
+*/
+static void Mod_BspCachePath( const model_t *mod, char *path, size_t size )
+{
+	Q_snprintf( path, size, "cache/%s", mod->name );
+	COM_ReplaceExtension( path, ".bspcache", size );
+}
+
+/*
+=================
+Mod_SaveBspCache
+
+write PHS and contents grid of the world
+=================
+*/
+static void Mod_SaveBspCache( model_t *mod, dword checksum )
+{
+	const contentsgrid_t *grid = &world.contentsgrid;
+	const size_t count = mod->numleafs + 1;
+	size_t numcells = 0;
+	char path[MAX_SYSPATH];
+	dbspcache_t hdr;
+	file_t *f;
+	size_t i;
+
+	memset( &hdr, 0, sizeof( hdr ));
+	hdr.ident = BSPCACHE_IDENT;
+	hdr.version = BSPCACHE_VERSION;
+	hdr.buildnum = Q_buildnum();
+	hdr.checksum = checksum;
+	hdr.numleafs = mod->numleafs;
+	hdr.visbytes = world.visbytes;
+
+	if( world.compressed_phs && world.phsofs )
+		hdr.phssize = world.phssize;
+
+	if( grid->cells )
+	{
+		VectorCopy( grid->size, hdr.gridsize );
+		VectorCopy( grid->origin, hdr.gridorigin );
+		hdr.gridscale = grid->scale;
+		numcells = (size_t)grid->size[0] * grid->size[1] * grid->size[2];
+	}
+
+	Mod_BspCachePath( mod, path, sizeof( path ));
+
+	if(( f = FS_Open( path, "wb", true )) == NULL )
+		return;
+
+	FS_Write( f, &hdr, sizeof( hdr ));
+
+	if( hdr.phssize )
+	{
+		for( i = 0; i < count; i++ )
+		{
+			uint32_t ofs = world.phsofs[i];
+			FS_Write( f, &ofs, sizeof( ofs ));
+		}
+		FS_Write( f, world.compressed_phs, hdr.phssize );
+	}
+
+	if( numcells )
+		FS_Write( f, grid->cells, numcells );
+
+	FS_Close( f );
+}
+
+/*
+=================
+Mod_LoadBspCache
+
+returns false if cache is missing, outdated
+or doesn't have everything that was requested
+=================
+*/
+static qboolean Mod_LoadBspCache( model_t *mod, dword checksum, qboolean needphs )
+{
+	const size_t count = mod->numleafs + 1;
+	size_t numcells = 0, expected;
+	char path[MAX_SYSPATH];
+	const dbspcache_t *hdr;
+	fs_offset_t length;
+	const byte *data;
+	byte *buf;
+	size_t i;
+
+	Mod_BspCachePath( mod, path, sizeof( path ));
+
+	if(( buf = FS_LoadFile( path, &length, false )) == NULL )
+		return false;
+
+	hdr = (const dbspcache_t *)buf;
+
+	if( length < sizeof( *hdr ) || hdr->ident != BSPCACHE_IDENT || hdr->version != BSPCACHE_VERSION
+		|| hdr->buildnum != Q_buildnum() || hdr->checksum != checksum || hdr->numleafs != mod->numleafs
+		|| hdr->visbytes != world.visbytes || hdr->phssize < 0 )
+	{
+		Mem_Free( buf );
+		return false;
+	}
+
+	// PHS can be only built if map has visibility
+	if( needphs && mod->visdata && !hdr->phssize )
+	{
+		Mem_Free( buf );
+		return false;
+	}
+
+	if( hdr->gridsize[0] > 0 && hdr->gridsize[1] > 0 && hdr->gridsize[2] > 0 )
+		numcells = (size_t)hdr->gridsize[0] * hdr->gridsize[1] * hdr->gridsize[2];
+
+	expected = sizeof( *hdr ) + numcells;
+	if( hdr->phssize )
+		expected += sizeof( uint32_t ) * count + hdr->phssize;
+
+	if( length != expected || numcells > GRID_MAX_CELLS )
+	{
+		Mem_Free( buf );
+		return false;
+	}
+
+	data = buf + sizeof( *hdr );
 
-	// TODO: cache the PHS somewhere, it might take a long time on giant maps
+	if( hdr->phssize )
+	{
+		world.phsofs = Mem_Malloc( mod->mempool, sizeof( *world.phsofs ) * count );
+
+		for( i = 0; i < count; i++ )
+		{
+			uint32_t ofs;
+
+			memcpy( &ofs, data, sizeof( ofs ));
+			data += sizeof( ofs );
+
+			if( ofs >= hdr->phssize )
+				break;
+
+			world.phsofs[i] = ofs;
+		}
+
+		if( i != count )
+		{
+			Mem_Free( world.phsofs );
+			world.phsofs = NULL;
+			Mem_Free( buf );
+			return false;
+		}
+
+		world.compressed_phs = Mem_Malloc( mod->mempool, hdr->phssize );
+		memcpy( world.compressed_phs, data, hdr->phssize );
+		world.phssize = hdr->phssize;
+		data += hdr->phssize;
+	}
+
+	memset( &world.contentsgrid, 0, sizeof( world.contentsgrid ));
+
+	if( numcells )
+	{
+		contentsgrid_t *grid = &world.contentsgrid;
+
+		VectorCopy( hdr->gridsize, grid->size );
+		VectorCopy( hdr->gridorigin, grid->origin );
+		grid->scale = hdr->gridscale;
+		grid->cells = Mem_Malloc( mod->mempool, numcells );
+		memcpy( grid->cells, data, numcells );
+	}
+
+	Mem_Free( buf );
+
+	return true;
+}
+
+/*
+=================
+Mod_CalcWorldData
+
+build data that isn't stored in BSP
+or load it from cache
+=================
+*/
+static void Mod_CalcWorldData( model_t *mod, const byte *mod_base )
+{
+	const qboolean needphs = SV_Active() && svs.maxclients > 1;
+	dword checksum = 0;
+	double t1, t2;
+
+	if( mod_bspcache.value )
+	{
+		t1 = Platform_DoubleTime();
+		checksum = Mod_BspCacheChecksum( mod_base );
+
+		if( Mod_LoadBspCache( mod, checksum, needphs ))
+		{
+			t2 = Platform_DoubleTime();
+			Con_Reportf( "PHS and contents grid loaded from cache in %.2f ms\n", ( t2 - t1 ) * 1000.0f );
+			return;
+		}
+	}
+
+	if( needphs )
+		Mod_CalcPHS( mod );
+
+	Mod_CalcContentsGrid( mod );
+
+	if( mod_bspcache.value )
+		Mod_SaveBspCache( mod, checksum );
 }
 
 /*
@@ -3678,6 +4337,7 @@ static qboolean Mod_LoadBmodelLumps( model_t *mod, const byte *mod_base, qboolea
 	size_t		len = 0;
 	int		i, ret, flags = 0;
 	qboolean wadlist_warn = false;
+	double		start = Sys_DoubleTime();
 
 	// always reset the intermediate struct
 	memset( bmod, 0, sizeof( dbspmodel_t ));
@@ -3735,6 +4395,8 @@ static qboolean Mod_LoadBmodelLumps( model_t *mod, const byte *mod_base, qboolea
 	for( i = 0; i < ARRAYSIZE( extlumps ); i++ )
 		Mod_LoadLump( mod_base, &extlumps[i], &worldstats[ARRAYSIZE( srclumps ) + i], flags );
 
+	loadstat.lumpstime = Sys_DoubleTime() - start;
+
 	if( !bmod->isworld && loadstat.numerrors )
 	{
 		Con_DPrintf( "Mod_Load%s: %i error(s), %i warning(s)\n", isworld ? "World" : "Brush", loadstat.numerrors, loadstat.numwarnings );
@@ -3772,8 +4434,7 @@ static qboolean Mod_LoadBmodelLumps( model_t *mod, const byte *mod_base, qboolea
 		world.shadowdata = bmod->shadowdata_out;	// occlusion data pointer
 #endif // XASH_DEDICATED
 
-		if( SV_Active() && svs.maxclients > 1 )
-			Mod_CalcPHS( mod );
+		Mod_CalcWorldData( mod, mod_base );
 	}
 
 	for( i = 0; i < world.wadlist.count; i++ )
@@ -3799,6 +4460,14 @@ static qboolean Mod_LoadBmodelLumps( model_t *mod, const byte *mod_base, qboolea
 		Con_Reportf( "Wad files required to run the map: \"%s\"\n", wadvalue );
 	}
 
+	loadstat.totaltime = Sys_DoubleTime() - start;
+
+	if( isworld )
+	{
+		worldloadstat = loadstat;
+		Mod_PrintLoadTimes( &worldloadstat, Con_Reportf );
+	}
+
 	return true;
 }
 
@@ -4176,3 +4845,196 @@ int GAME_EXPORT Mod_SaveLump( const char *filename, const int lump, void *lumpda
 	FS_Close( f );
 	return LUMP_SAVE_OK;
 }
+
+#if XASH_ENGINE_TESTS
+#include "tests.h"
+
+static void Test_ContentsGridHull( hull_t *hull )
+{
+	contentsgrid_t grid;
+	poolhandle_t mempool = Mem_AllocPool( "contents grid test" );
+	const vec3_t mins = { -128.0f, -128.0f, -128.0f };
+	const vec3_t maxs = { 128.0f, 128.0f, 128.0f };
+	int x, y, z, uniform = 0;
+	vec3_t p;
+
+	Mod_BuildContentsGrid( &grid, hull, mins, maxs, 16.0f, mempool );
+	TASSERT( grid.cells != NULL );
+
+	for( x = 0; x < grid.size[0] * grid.size[1] * grid.size[2]; x++ )
+	{
+		if( grid.cells[x] != CONTENTS_NONE )
+			uniform++;
+	}
+
+	// most of the cells must not cross any plane
+	TASSERT( uniform > grid.size[0] * grid.size[1] * grid.size[2] / 2 );
+
+	// also goes exactly over the planes and outside of the grid
+	for( x = -136; x <= 136; x += 4 )
+	{
+		for( y = -136; y <= 136; y += 4 )
+		{
+			for( z = -136; z <= 136; z += 4 )
+			{
+				int expected, contents;
+
+				VectorSet( p, x + 0.5f * ( y & 4 ), y, z - 0.25f * ( x & 4 ));
+				expected = PM_HullPointContents( hull, hull->firstclipnode, p );
+				contents = Mod_GridPointContents( &grid, hull, hull->firstclipnode, p );
+
+				if( expected != contents )
+				{
+					TASSERT_EQi( expected, contents );
+					Msg( "at %g %g %g\n", p[0], p[1], p[2] );
+				}
+			}
+		}
+	}
+
+	Mem_FreePool( &mempool );
+}
+
+static void Test_BspCacheWorld( model_t *mod, hull_t *hull )
+{
+	const int numleafs = 512;
+	contentsgrid_t grid;
+	byte *phs, *visrow, *vis;
+	size_t *phsofs, phssize;
+	double t1, t2, t3;
+	char path[MAX_SYSPATH];
+	uint seed = 1;
+	int i, j;
+
+	memset( mod, 0, sizeof( *mod ));
+	Q_strncpy( mod->name, "maps/test_bspcache.bsp", sizeof( mod->name ));
+	mod->mempool = Mem_AllocPool( "bsp cache test" );
+	mod->numleafs = numleafs;
+	mod->leafs = Mem_Calloc( mod->mempool, sizeof( *mod->leafs ) * ( numleafs + 1 ));
+	mod->hulls[0] = *hull;
+	VectorSet( mod->mins, -128.0f, -128.0f, -128.0f );
+	VectorSet( mod->maxs, 128.0f, 128.0f, 128.0f );
+
+	// every leaf sees a few random neighbours
+	world.visbytes = ( numleafs + 7 ) >> 3;
+	mod->visdata = vis = Mem_Calloc( mod->mempool, ( world.visbytes * 2 + 2 ) * numleafs );
+	visrow = Mem_Calloc( mod->mempool, world.visbytes );
+
+	for( i = 1; i <= numleafs; i++ )
+	{
+		memset( visrow, 0, world.visbytes );
+		for( j = 0; j < 4; j++ )
+		{
+			seed = seed * 1103515245 + 12345;
+			SetBits( visrow[(( seed >> 16 ) % numleafs ) >> 3], BIT(( seed >> 16 ) % numleafs & 7 ));
+		}
+
+		mod->leafs[i].compressed_vis = vis;
+		vis += Mod_CompressPVS( vis, visrow, world.visbytes );
+	}
+
+	// cold load
+	t1 = Platform_DoubleTime();
+	Mod_CalcPHS( mod );
+	Mod_CalcContentsGrid( mod );
+	t2 = Platform_DoubleTime();
+
+	TASSERT( world.compressed_phs != NULL );
+	TASSERT( world.contentsgrid.cells != NULL );
+
+	Mod_SaveBspCache( mod, 0x1234 );
+
+	// keep fresh data and load it again
+	phs = world.compressed_phs;
+	phsofs = world.phsofs;
+	phssize = world.phssize;
+	grid = world.contentsgrid;
+	world.compressed_phs = NULL;
+	world.phsofs = NULL;
+	world.phssize = 0;
+
+	TASSERT( !Mod_LoadBspCache( mod, 0x4321, true ));
+
+	t3 = Platform_DoubleTime();
+	TASSERT( Mod_LoadBspCache( mod, 0x1234, true ));
+	t3 = Platform_DoubleTime() - t3;
+
+	TASSERT( world.phssize == phssize );
+	TASSERT( world.phsofs && !memcmp( world.phsofs, phsofs, sizeof( *phsofs ) * ( numleafs + 1 )));
+	TASSERT( world.compressed_phs && !memcmp( world.compressed_phs, phs, phssize ));
+	TASSERT( VectorCompare( world.contentsgrid.origin, grid.origin ));
+	TASSERT( world.contentsgrid.scale == grid.scale );
+	TASSERT( !memcmp( world.contentsgrid.size, grid.size, sizeof( grid.size )));
+	TASSERT( world.contentsgrid.cells && !memcmp( world.contentsgrid.cells, grid.cells, grid.size[0] * grid.size[1] * grid.size[2] ));
+
+	Msg( "World data of %d leafs: cold %.2f ms, warm %.2f ms\n", numleafs, ( t2 - t1 ) * 1000.0, t3 * 1000.0 );
+
+	Mod_BspCachePath( mod, path, sizeof( path ));
+	FS_Delete( path );
+
+	Mem_FreePool( &mod->mempool );
+	world.compressed_phs = NULL;
+	world.phsofs = NULL;
+	world.phssize = 0;
+	world.visbytes = 0;
+	memset( &world.contentsgrid, 0, sizeof( world.contentsgrid ));
+}
+
+static void Test_MakeHull( hull_t *hull, mplane_t *planes, mclipnode16_t *clipnodes )
+{
+	memset( planes, 0, sizeof( *planes ) * 3 );
+
+	// non-axial plane
+	VectorSet( planes[0].normal, 0.6f, 0.8f, 0.0f );
+	planes[0].dist = 10.0f;
+	planes[0].type = PLANE_NONAXIAL;
+
+	// axial planes
+	VectorSet( planes[1].normal, 0.0f, 0.0f, 1.0f );
+	planes[1].dist = 32.0f;
+	planes[1].type = PLANE_Z;
+
+	VectorSet( planes[2].normal, 1.0f, 0.0f, 0.0f );
+	planes[2].dist = -40.0f;
+	planes[2].type = PLANE_X;
+
+	clipnodes[0].planenum = 0;
+	clipnodes[0].children[0] = 1;
+	clipnodes[0].children[1] = CONTENTS_WATER;
+	clipnodes[1].planenum = 1;
+	clipnodes[1].children[0] = CONTENTS_EMPTY;
+	clipnodes[1].children[1] = 2;
+	clipnodes[2].planenum = 2;
+	clipnodes[2].children[0] = CONTENTS_SOLID;
+	clipnodes[2].children[1] = CONTENTS_LAVA;
+
+	memset( hull, 0, sizeof( *hull ));
+	hull->clipnodes16 = clipnodes;
+	hull->planes = planes;
+	hull->firstclipnode = 0;
+	hull->lastclipnode = 2;
+}
+
+void Test_RunContentsGrid( void )
+{
+	mplane_t planes[3];
+	mclipnode16_t clipnodes[3];
+	hull_t hull;
+
+	Test_MakeHull( &hull, planes, clipnodes );
+
+	TRUN( Test_ContentsGridHull( &hull ));
+}
+
+void Test_RunBspCache( void )
+{
+	mplane_t planes[3];
+	mclipnode16_t clipnodes[3];
+	hull_t hull;
+	model_t mod;
+
+	Test_MakeHull( &hull, planes, clipnodes );
+
+	TRUN( Test_BspCacheWorld( &mod, &hull ));
+}
+#endif // XASH_ENGINE_TESTS
@@ -90,6 +90,14 @@ typedef struct wadlist_s
 	int  count;
 } wadlist_t;
 
+typedef struct contentsgrid_s
+{
+	signed char	*cells;		// hull 0 contents per cell, CONTENTS_NONE if cell is not uniform
+	vec3_t		origin;		// corner of the first cell
+	float		scale;		// 1.0f / cellsize
+	int		size[3];		// cells per axis
+} contentsgrid_t;
+
 typedef struct world_static_s
 {
 	qboolean		loading;		// true if worldmodel is loading
@@ -125,6 +133,10 @@ typedef struct world_static_s
 	// Potentially Hearable Set
 	byte   *compressed_phs;
 	size_t *phsofs;
+	size_t  phssize; // compressed size
+
+	// point contents acceleration
+	contentsgrid_t contentsgrid;
 
 	wadlist_t wadlist;
 } world_static_t;
@@ -135,6 +147,8 @@ extern poolhandle_t     com_studiocache;
 extern convar_t		mod_studiocache;
 extern convar_t		r_wadtextures;
 extern convar_t		r_showhull;
+extern convar_t		mod_cachesize;
+extern convar_t		mod_bspcache;
 extern const mclipnode16_t box_clipnodes16[6];
 extern const mclipnode32_t box_clipnodes32[6];
 
@@ -179,6 +193,10 @@ int Mod_SampleSizeForFace( const msurface_t *surf );
 byte *Mod_GetPVSForPoint( const vec3_t p );
 void Mod_UnloadBrushModel( model_t *mod );
 void Mod_PrintWorldStats_f( void );
+int Mod_HullBoxContents( hull_t *hull, const vec3_t mins, const vec3_t maxs );
+void Mod_BuildContentsGrid( contentsgrid_t *grid, hull_t *hull, const vec3_t mins, const vec3_t maxs, float cellsize, poolhandle_t mempool );
+int Mod_GridPointContents( const contentsgrid_t *grid, hull_t *hull, int num, const vec3_t p );
+int Mod_WorldPointContents( model_t *mod, const vec3_t p );
 
 //
 // mod_dbghulls.c
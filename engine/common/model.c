@@ -23,14 +23,25 @@ GNU General Public License for more details.
 #include "enginefeatures.h"
 #include "client.h"
 #include "server.h"
+#include "pm_local.h"
 
 static model_info_t	mod_crcinfo[MAX_MODELS];
 static model_t	mod_known[MAX_MODELS];
 static int	mod_numknown = 0;
+static uint	mod_lastused[MAX_MODELS];	// registration sequence when model was referenced last time
+static uint	mod_sequence = 0;		// increased on every map change
+static struct
+{
+	uint	hits;		// unreferenced model was kept and reused
+	uint	misses;		// model was loaded from disk
+	uint	evicted;		// unreferenced model was freed to fit the budget
+} mod_cachestats;
 poolhandle_t      com_studiocache;		// cache for submodels
 CVAR_DEFINE( mod_studiocache, "r_studiocache", "1", FCVAR_ARCHIVE, "enables studio cache for speedup tracing hitboxes" );
 CVAR_DEFINE_AUTO( r_wadtextures, "0", 0, "completely ignore textures in the bsp-file if enabled" );
 CVAR_DEFINE_AUTO( r_showhull, "0", 0, "draw collision hulls 1-3" );
+CVAR_DEFINE_AUTO( mod_bspcache, "0", FCVAR_ARCHIVE, "store PHS and contents grid of the world on disk to speed up next loads of the same map" );
+CVAR_DEFINE_AUTO( mod_cachesize, "0", FCVAR_ARCHIVE, "megabytes of models unused by current map to keep loaded across map changes, 0 frees them all" );
 
 /*
 ===============================================================================
@@ -48,6 +59,7 @@ static void Mod_Modellist_f( void )
 {
 	int	i, nummodels;
 	model_t	*mod;
+	size_t	size, total = 0, unused = 0;
 
 	Con_Printf( "\n" );
 	Con_Printf( "-----------------------------------\n" );
@@ -56,12 +68,24 @@ static void Mod_Modellist_f( void )
 	{
 		if( !COM_CheckStringEmpty( mod->name ) )
 			continue; // free slot
-		Con_Printf( "%s\n", mod->name );
+
+		size = Mem_PoolSize( mod->mempool );
+		total += size;
+
+		if( mod->needload == NL_UNREFERENCED )
+		{
+			Con_Printf( "%s %s (unused)\n", Q_memprint( size ), mod->name );
+			unused += size;
+		}
+		else Con_Printf( "%s %s\n", Q_memprint( size ), mod->name );
 		nummodels++;
 	}
 
 	Con_Printf( "-----------------------------------\n" );
 	Con_Printf( "%i total models\n", nummodels );
+	Con_Printf( "%s total memory, ", Q_memprint( total ));
+	Con_Printf( "%s unused\n", Q_memprint( unused ));
+	Con_Printf( "%u hits, %u misses, %u evicted\n", mod_cachestats.hits, mod_cachestats.misses, mod_cachestats.evicted );
 	Con_Printf( "\n" );
 }
 
@@ -109,6 +133,10 @@ void Mod_FreeModel( model_t *mod )
 		Mem_FreePool( &mod->mempool );
 	}
 
+	// cached surfaces may point into this model, stats are per map
+	if( mod->type == mod_brush )
+		PM_ClearSurfaceCache( FBitSet( mod->flags, MODEL_WORLD ) ? true : false );
+
 	if( mod->type == mod_brush && FBitSet( mod->flags, MODEL_WORLD ) )
 	{
 		world.version = 0;
@@ -119,6 +147,8 @@ void Mod_FreeModel( model_t *mod )
 		world.hull_models = NULL;
 		world.compressed_phs = NULL;
 		world.phsofs = NULL;
+		world.phssize = 0;
+		memset( &world.contentsgrid, 0, sizeof( world.contentsgrid ));
 	}
 
 	memset( mod, 0, sizeof( *mod ));
@@ -142,6 +172,8 @@ void Mod_Init( void )
 	Cvar_RegisterVariable( &mod_studiocache );
 	Cvar_RegisterVariable( &r_wadtextures );
 	Cvar_RegisterVariable( &r_showhull );
+	Cvar_RegisterVariable( &mod_cachesize );
+	Cvar_RegisterVariable( &mod_bspcache );
 
 	Cmd_AddCommand( "mapstats", Mod_PrintWorldStats_f, "show stats for currently loaded map" );
 	Cmd_AddCommand( "modellist", Mod_Modellist_f, "display loaded models list" );
@@ -198,6 +230,32 @@ void Mod_Shutdown( void )
 
 ===============================================================================
 */
+/*
+==================
+Mod_FindUnusedSlot
+
+returns least recently used model
+that isn't referenced by current map
+==================
+*/
+static model_t *Mod_FindUnusedSlot( void )
+{
+	model_t	*mod, *oldest = NULL;
+	int	i;
+
+	// never tries to release worldmodel
+	for( i = 1, mod = &mod_known[1]; i < mod_numknown; i++, mod++ )
+	{
+		if( mod->needload != NL_UNREFERENCED || !COM_CheckString( mod->name ) || mod->name[0] == '*' )
+			continue;
+
+		if( !oldest || mod_lastused[i] < mod_lastused[oldest - mod_known] )
+			oldest = mod;
+	}
+
+	return oldest;
+}
+
 /*
 ==================
 Mod_FindName
@@ -218,10 +276,15 @@ model_t *Mod_FindName( const char *filename, qboolean trackCRC )
 	{
 		if( !Q_stricmp( mod->name, modname ))
 		{
+			// kept from one of previous maps
+			if( mod->needload == NL_UNREFERENCED && mod->mempool && mod_lastused[i] != mod_sequence )
+				mod_cachestats.hits++;
+
 			if( mod->mempool || mod->name[0] == '*' )
 				mod->needload = NL_PRESENT;
 			else mod->needload = NL_NEEDS_LOADED;
 
+			mod_lastused[i] = mod_sequence;
 			return mod;
 		}
 	}
@@ -230,6 +293,18 @@ model_t *Mod_FindName( const char *filename, qboolean trackCRC )
 	for( i = 0, mod = mod_known; i < mod_numknown; i++, mod++ )
 		if( !COM_CheckStringEmpty( mod->name ) ) break; // this is a valid spot
 
+	if( i == mod_numknown && mod_numknown == MAX_MODELS )
+	{
+		// all slots are taken, reuse slot of the least recently used model
+		// that kept from previous maps
+		if(( mod = Mod_FindUnusedSlot( )) != NULL )
+		{
+			Mod_FreeModel( mod );
+			mod_cachestats.evicted++;
+			i = mod - mod_known;
+		}
+	}
+
 	if( i == mod_numknown )
 	{
 		if( mod_numknown == MAX_MODELS )
@@ -243,6 +318,7 @@ model_t *Mod_FindName( const char *filename, qboolean trackCRC )
 	else mod_crcinfo[i].flags = 0;
 	mod->needload = NL_NEEDS_LOADED;
 	mod_crcinfo[i].initialCRC = 0;
+	mod_lastused[i] = mod_sequence;
 
 	return mod;
 }
@@ -290,6 +366,7 @@ model_t *Mod_LoadModel( model_t *mod, qboolean crash )
 	}
 
 	Con_Reportf( "loading %s\n", mod->name );
+	mod_cachestats.misses++;
 	mod->needload = NL_PRESENT;
 	mod->type = mod_bad;
 
@@ -404,22 +481,17 @@ model_t *Mod_ForName( const char *name, qboolean crash, qboolean trackCRC )
 
 /*
 ==================
-Mod_PurgeStudioCache
+Mod_UnreferenceAll
 
-free studio cache on change level
+mark all models as unused before precaching new map
 ==================
 */
-static void Mod_PurgeStudioCache( void )
+static void Mod_UnreferenceAll( void )
 {
 	int	i;
 
-	// refresh hull data
-	SetBits( r_showhull.flags, FCVAR_CHANGED );
-#if !XASH_DEDICATED
-	Mod_ReleaseHullPolygons();
-#endif
-	// release previois map
-	Mod_FreeModel( mod_known );	// world is stuck on slot #0 always
+	// models referenced by the new map will get new sequence
+	mod_sequence++;
 
 	// we should release all the world submodels
 	// and clear studio sequences
@@ -431,6 +503,26 @@ static void Mod_PurgeStudioCache( void )
 			Mod_FreeModel( &mod_known[i] );
 		mod_known[i].needload = NL_UNREFERENCED;
 	}
+}
+
+/*
+==================
+Mod_PurgeStudioCache
+
+free studio cache on change level
+==================
+*/
+static void Mod_PurgeStudioCache( void )
+{
+	// refresh hull data
+	SetBits( r_showhull.flags, FCVAR_CHANGED );
+#if !XASH_DEDICATED
+	Mod_ReleaseHullPolygons();
+#endif
+	// release previois map
+	Mod_FreeModel( mod_known );	// world is stuck on slot #0 always
+
+	Mod_UnreferenceAll();
 
 	Mem_EmptyPool( com_studiocache );
 	Mod_ClearStudioCache();
@@ -474,14 +566,33 @@ Purge all unused models
 */
 void Mod_FreeUnused( void )
 {
+	size_t	budget, unused = 0;
 	model_t	*mod;
 	int	i;
 
+	budget = mod_cachesize.value > 0.0f ? (size_t)( mod_cachesize.value * 1024.0f * 1024.0f ) : 0;
+
 	// never tries to release worldmodel
 	for( i = 1, mod = &mod_known[1]; i < mod_numknown; i++, mod++ )
 	{
-		if( mod->needload == NL_UNREFERENCED && COM_CheckString( mod->name ))
-			Mod_FreeModel( mod );
+		if( mod->needload != NL_UNREFERENCED || !COM_CheckString( mod->name ))
+			continue;
+
+		// names without data are not worth keeping
+		if( budget && mod->mempool )
+			unused += Mem_PoolSize( mod->mempool );
+		else Mod_FreeModel( mod );
+	}
+
+	// release least recently used models until the rest fits into budget
+	while( unused > budget )
+	{
+		if(( mod = Mod_FindUnusedSlot( )) == NULL )
+			break;
+
+		unused -= Mem_PoolSize( mod->mempool );
+		Mod_FreeModel( mod );
+		mod_cachestats.evicted++;
 	}
 }
 
@@ -613,6 +724,79 @@ void Mod_NeedCRC( const char *name, qboolean needCRC )
 }
 
 #if XASH_ENGINE_TESTS
+#include "tests.h"
+
+static model_t *Test_FakeModel( const char *name, size_t size )
+{
+	model_t *mod = Mod_FindName( name, false );
+
+	if( !mod->mempool )
+	{
+		mod->mempool = Mem_AllocPool( name );
+		mod->type = mod_sprite;
+		mod->cache.data = Mem_Malloc( mod->mempool, size );
+	}
+	mod->needload = NL_PRESENT;
+
+	return mod;
+}
+
+void Test_RunModelCache( void )
+{
+	const size_t size = 256 * 1024;
+	float oldsize = mod_cachesize.value;
+
+	// freeing models calls into renderer, which isn't loaded yet
+	if( !Host_IsDedicated( ))
+		return;
+
+	memset( &mod_cachestats, 0, sizeof( mod_cachestats ));
+	mod_cachesize.value = 0.6f; // two models
+
+	// world is stuck on slot #0 always
+	Test_FakeModel( "maps/test.bsp", size );
+
+	// map 1
+	Mod_UnreferenceAll();
+	Test_FakeModel( "test_a.spr", size );
+	Test_FakeModel( "test_b.spr", size );
+	Mod_FreeUnused();
+
+	// map 2
+	Mod_UnreferenceAll();
+	Test_FakeModel( "test_c.spr", size );
+	Test_FakeModel( "test_d.spr", size );
+	Mod_FreeUnused();
+	TASSERT( Mod_FindUnusedSlot() != NULL );
+	TASSERT_EQi( mod_cachestats.evicted, 0 );
+
+	// map 1 again, both models are still here
+	Mod_UnreferenceAll();
+	Test_FakeModel( "test_a.spr", size );
+	Test_FakeModel( "test_b.spr", size );
+	TASSERT_EQi( mod_cachestats.hits, 2 );
+	Mod_FreeUnused();
+	TASSERT_EQi( mod_cachestats.evicted, 0 );
+
+	// map 3, unused models exceed budget and map 2 models are older
+	Mod_UnreferenceAll();
+	Test_FakeModel( "test_e.spr", size );
+	Mod_FreeUnused();
+	TASSERT_EQi( mod_cachestats.evicted, 2 );
+
+	Mod_UnreferenceAll();
+	Test_FakeModel( "test_a.spr", size );
+	Test_FakeModel( "test_c.spr", size );
+	TASSERT_EQi( mod_cachestats.hits, 3 );
+
+	// no budget, everything unreferenced is released
+	mod_cachesize.value = 0.0f;
+	Mod_FreeUnused();
+	TASSERT( Mod_FindUnusedSlot() == NULL );
+
+	mod_cachesize.value = oldsize;
+	Mod_FreeAll();
+}
 
 static const uint8_t *fuzz_data;
 static size_t fuzz_size;
@@ -20,6 +20,8 @@ GNU General Public License for more details.
 
 typedef int (*pfnIgnore)( physent_t *pe );	// custom trace filter
 
+#define PM_MAX_BATCHLINES	256	// lines traced together by PM_TestLinesExt
+
 //
 // pm_trace.c
 //
@@ -82,8 +84,18 @@ static inline void PM_InitPMTrace( pmtrace_t *trace, const vec3_t end )
 //
 // pm_surface.c
 //
+typedef struct
+{
+	uint	hits;
+	uint	misses;
+} pm_surfcachestats_t;
+
+extern pm_surfcachestats_t pm_surfcachestats;
+
+void PM_ClearSurfaceCache( qboolean resetstats );
 msurface_t *PM_RecursiveSurfCheck( model_t *model, mnode_t *node, vec3_t p1, vec3_t p2 );
 msurface_t *PM_TraceSurface( physent_t *pe, vec3_t start, vec3_t end );
 int PM_TestLineExt( playermove_t *pmove, physent_t *ents, int numents, const vec3_t start, const vec3_t end, int flags );
+void PM_TestLinesExt( playermove_t *pmove, physent_t *ents, int numents, const vec3_t *starts, const vec3_t *ends, int *contents, int numlines, int flags );
 
 #endif//PM_LOCAL_H
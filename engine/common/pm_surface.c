@@ -182,6 +182,96 @@ msurface_t *PM_RecursiveSurfCheck( model_t *mod, mnode_t *node, vec3_t p1, vec3_
 	return PM_RecursiveSurfCheck( mod, children[side^1], mid, p2 );
 }
 
+/*
+===============================================================================
+
+SURFACE TRACE CACHE
+
+footstep traces repeat each frame while player stands on the same face,
+so remember the last hit surface by model and exact local segment.
+Same segment gives the same descent, so result is always the nearest face
+
+===============================================================================
+*/
+#define SURFCACHE_SIZE	256	// must be power of two
+#define SURFCACHE_XFORMS	32	// must be power of two
+
+typedef struct
+{
+	model_t		*model;
+	vec3_t		start, end;	// local segment
+	msurface_t	*surf;
+} surfcache_t;
+
+typedef struct
+{
+	model_t		*model;
+	vec3_t		origin;		// physent origin + hull offset
+	vec3_t		angles;
+	matrix4x4		matrix;
+} surfxform_t;
+
+static surfcache_t	pm_surfcache[SURFCACHE_SIZE];
+static surfxform_t	pm_surfxform[SURFCACHE_XFORMS];
+pm_surfcachestats_t	pm_surfcachestats;
+
+/*
+==================
+PM_ClearSurfaceCache
+
+must be called when brush models are freed,
+stats are kept until the world is changed
+==================
+*/
+void PM_ClearSurfaceCache( qboolean resetstats )
+{
+	memset( pm_surfcache, 0, sizeof( pm_surfcache ));
+	memset( pm_surfxform, 0, sizeof( pm_surfxform ));
+
+	if( resetstats )
+		memset( &pm_surfcachestats, 0, sizeof( pm_surfcachestats ));
+}
+
+/*
+==================
+PM_SurfaceTransform
+
+returns inverse transform for rotated physent,
+rebuilds it only when entity has moved
+==================
+*/
+static surfxform_t *PM_SurfaceTransform( physent_t *pe, const vec3_t offset )
+{
+	surfxform_t	*xf = &pm_surfxform[((size_t)pe->model >> 4 ) & ( SURFCACHE_XFORMS - 1 )];
+
+	if( xf->model != pe->model || !VectorCompare( xf->origin, offset ) || !VectorCompare( xf->angles, pe->angles ))
+	{
+		xf->model = pe->model;
+		VectorCopy( offset, xf->origin );
+		VectorCopy( pe->angles, xf->angles );
+		Matrix4x4_CreateFromEntity( xf->matrix, pe->angles, offset, 1.0f );
+	}
+
+	return xf;
+}
+
+static surfcache_t *PM_SurfaceCacheSlot( model_t *mod, const vec3_t start, const vec3_t end )
+{
+	uint	hash = (uint)((size_t)mod >> 4 );
+	uint	bits;
+	int	i;
+
+	for( i = 0; i < 3; i++ )
+	{
+		memcpy( &bits, &start[i], sizeof( bits ));
+		hash = hash * 31 + bits;
+		memcpy( &bits, &end[i], sizeof( bits ));
+		hash = hash * 31 + bits;
+	}
+
+	return &pm_surfcache[( hash ^ ( hash >> 16 )) & ( SURFCACHE_SIZE - 1 )];
+}
+
 /*
 ==================
 PM_TraceTexture
@@ -192,11 +282,12 @@ assume physentity is valid
 */
 msurface_t *PM_TraceSurface( physent_t *pe, vec3_t start, vec3_t end )
 {
-	matrix4x4		matrix;
 	model_t		*bmodel;
 	hull_t		*hull;
 	vec3_t		start_l, end_l;
 	vec3_t		offset;
+	surfcache_t	*cache;
+	msurface_t	*surf;
 
 	bmodel = pe->model;
 
@@ -213,12 +304,32 @@ msurface_t *PM_TraceSurface( physent_t *pe, vec3_t start, vec3_t end )
 	// rotate start and end into the models frame of reference
 	if( !VectorIsNull( pe->angles ))
 	{
-		Matrix4x4_CreateFromEntity( matrix, pe->angles, offset, 1.0f );
-		Matrix4x4_VectorITransform( matrix, start, start_l );
-		Matrix4x4_VectorITransform( matrix, end, end_l );
+		surfxform_t	*xf = PM_SurfaceTransform( pe, offset );
+
+		Matrix4x4_VectorITransform( xf->matrix, start, start_l );
+		Matrix4x4_VectorITransform( xf->matrix, end, end_l );
+	}
+
+	cache = PM_SurfaceCacheSlot( bmodel, start_l, end_l );
+
+	if( cache->model == bmodel && !memcmp( cache->start, start_l, sizeof( vec3_t )) && !memcmp( cache->end, end_l, sizeof( vec3_t )))
+	{
+		pm_surfcachestats.hits++;
+		return cache->surf;
+	}
+
+	pm_surfcachestats.misses++;
+	surf = PM_RecursiveSurfCheck( bmodel, &bmodel->nodes[hull->firstclipnode], start_l, end_l );
+
+	if( surf )
+	{
+		cache->model = bmodel;
+		VectorCopy( start_l, cache->start );
+		VectorCopy( end_l, cache->end );
+		cache->surf = surf;
 	}
 
-	return PM_RecursiveSurfCheck( bmodel, &bmodel->nodes[hull->firstclipnode], start_l, end_l );
+	return surf;
 }
 
 /*
@@ -386,3 +497,510 @@ int PM_TestLineExt( playermove_t *pmove, physent_t *ents, int numents, const vec
 
 	return trace.contents;
 }
+
+/*
+==================
+PM_TestLineBatch_r
+
+descends whole packet of lines while they stay on the same side,
+lines that split on the node plane are continued one by one
+==================
+*/
+static void PM_TestLineBatch_r( model_t *mod, mnode_t *node, const vec3_t *starts, const vec3_t *ends, int *list, int count, linetrace_t *traces )
+{
+	mnode_t	*children[2];
+	int	i, lo, hi, tmp;
+
+	while( count > 0 )
+	{
+		if( node->contents < 0 )
+		{
+			for( i = 0; i < count; i++ )
+				PM_TestLine_r( mod, node, 0.0f, 1.0f, starts[list[i]], ends[list[i]], &traces[list[i]] );
+			return;
+		}
+
+		node_children( children, node, mod );
+
+		// partition: front side lines first, back side lines last
+		for( i = lo = 0, hi = count; i < hi; )
+		{
+			int	l = list[i];
+			float	front = PlaneDiff( starts[l], node->plane );
+			float	back = PlaneDiff( ends[l], node->plane );
+
+			if( front >= -FRAC_EPSILON && back >= -FRAC_EPSILON )
+			{
+				tmp = list[lo]; list[lo++] = l; list[i++] = tmp;
+			}
+			else if( front < FRAC_EPSILON && back < FRAC_EPSILON )
+			{
+				tmp = list[--hi]; list[hi] = l; list[i] = tmp;
+			}
+			else
+			{
+				// diverged, trace it from here like scalar path does
+				PM_TestLine_r( mod, node, 0.0f, 1.0f, starts[l], ends[l], &traces[l] );
+				i++;
+			}
+		}
+
+		PM_TestLineBatch_r( mod, children[0], starts, ends, list, lo, traces );
+
+		node = children[1];
+		list += hi;
+		count -= hi;
+	}
+}
+
+/*
+==================
+PM_TestLinesBatch
+
+up to PM_MAX_BATCHLINES lines
+==================
+*/
+static void PM_TestLinesBatch( playermove_t *pmove, physent_t *ents, int numents, const vec3_t *starts, const vec3_t *ends, int *contents, int numlines, int flags )
+{
+	linetrace_t	trace[PM_MAX_BATCHLINES], trace_bbox[PM_MAX_BATCHLINES];
+	vec3_t		start_l[PM_MAX_BATCHLINES], end_l[PM_MAX_BATCHLINES];
+	int		list[PM_MAX_BATCHLINES];
+	vec3_t		mins, maxs, offset;
+	matrix4x4		matrix;
+	hull_t		*hull;
+	physent_t		*pe;
+	int		i, j, count;
+
+	ClearBounds( mins, maxs );
+
+	for( j = 0; j < numlines; j++ )
+	{
+		trace[j].contents = CONTENTS_EMPTY;
+		trace[j].fraction = 1.0f;
+		trace[j].surface = NULL;
+		AddPointToBounds( starts[j], mins, maxs );
+		AddPointToBounds( ends[j], mins, maxs );
+	}
+
+	for( i = 0; i < numents; i++ )
+	{
+		qboolean	rotated, cull;
+
+		pe = &ents[i];
+
+		if( i != 0 && FBitSet( flags, PM_WORLD_ONLY ))
+			break;
+
+		if( !pe->model || pe->model->type != mod_brush || pe->solid != SOLID_BSP )
+			continue;
+
+		if( FBitSet( flags, PM_GLASS_IGNORE ) && pe->rendermode != kRenderNormal )
+			continue;
+
+		hull = PM_HullForBsp( pe, pmove, offset );
+		rotated = !VectorIsNull( pe->angles );
+
+		// space around brush entity is empty, unlike the world
+		cull = ( i != 0 && !rotated );
+
+		if( cull )
+		{
+			vec3_t	absmin, absmax;
+
+			VectorAdd( pe->origin, pe->model->mins, absmin );
+			VectorAdd( pe->origin, pe->model->maxs, absmax );
+
+			if( !BoundsIntersect( mins, maxs, absmin, absmax ))
+				continue; // whole batch misses this entity
+		}
+
+		if( rotated )
+			Matrix4x4_CreateFromEntity( matrix, pe->angles, offset, 1.0f );
+
+		for( j = count = 0; j < numlines; j++ )
+		{
+			if( rotated )
+			{
+				Matrix4x4_VectorITransform( matrix, starts[j], start_l[j] );
+				Matrix4x4_VectorITransform( matrix, ends[j], end_l[j] );
+			}
+			else
+			{
+				VectorSubtract( starts[j], pe->origin, start_l[j] );
+				VectorSubtract( ends[j], pe->origin, end_l[j] );
+			}
+
+			if( cull )
+			{
+				vec3_t	linemins, linemaxs;
+
+				ClearBounds( linemins, linemaxs );
+				AddPointToBounds( start_l[j], linemins, linemaxs );
+				AddPointToBounds( end_l[j], linemins, linemaxs );
+
+				if( !BoundsIntersect( linemins, linemaxs, pe->model->mins, pe->model->maxs ))
+					continue;
+			}
+
+			trace_bbox[j].contents = CONTENTS_EMPTY;
+			trace_bbox[j].fraction = 1.0f;
+			trace_bbox[j].surface = NULL;
+			list[count++] = j;
+		}
+
+		if( !count ) continue;
+
+		PM_TestLineBatch_r( pe->model, &pe->model->nodes[hull->firstclipnode], start_l, end_l, list, count, trace_bbox );
+
+		for( j = 0; j < count; j++ )
+		{
+			int	l = list[j];
+
+			if( trace_bbox[l].contents != CONTENTS_EMPTY || trace_bbox[l].fraction < trace[l].fraction )
+				trace[l] = trace_bbox[l];
+		}
+	}
+
+	for( j = 0; j < numlines; j++ )
+		contents[j] = trace[j].contents;
+}
+
+/*
+==================
+PM_TestLinesExt
+
+batched version of PM_TestLineExt, gives the same contents for each line
+==================
+*/
+void PM_TestLinesExt( playermove_t *pmove, physent_t *ents, int numents, const vec3_t *starts, const vec3_t *ends, int *contents, int numlines, int flags )
+{
+	int	i;
+
+	for( i = 0; i < numlines; i += PM_MAX_BATCHLINES )
+	{
+		int	count = Q_min( numlines - i, PM_MAX_BATCHLINES );
+
+		PM_TestLinesBatch( pmove, ents, numents, starts + i, ends + i, contents + i, count, flags );
+	}
+}
+
+#if XASH_ENGINE_TESTS
+#include "tests.h"
+
+#define TEST_WORLD_DEPTH	8
+#define TEST_WORLD_NODES	((1<<TEST_WORLD_DEPTH)-1)
+#define TEST_WORLD_LEAFS	(1<<TEST_WORLD_DEPTH)
+#define TEST_NUMLINES	4096
+#define TEST_NUMENTS	9
+
+typedef struct
+{
+	model_t	world, box;
+	mnode_t	nodes[TEST_WORLD_NODES + 6];
+	mleaf_t	leafs[TEST_WORLD_LEAFS + 2];
+	mplane_t	planes[TEST_WORLD_NODES + 6];
+	physent_t	ents[TEST_NUMENTS];
+	vec3_t	starts[TEST_NUMLINES], ends[TEST_NUMLINES];
+	int	contents[TEST_NUMLINES];
+	uint	seed;
+} testlines_t;
+
+static float Test_LinesRandom( testlines_t *t, float min, float max )
+{
+	t->seed = t->seed * 1664525 + 1013904223;
+	return min + ( max - min ) * (( t->seed >> 8 ) / (float)( 1 << 24 ));
+}
+
+static void Test_LinesSetModel( model_t *mod, mnode_t *nodes, mleaf_t *leafs, float size )
+{
+	mod->type = mod_brush;
+	mod->nodes = nodes;
+	mod->leafs = leafs;
+	VectorSet( mod->mins, -size, -size, -size );
+	VectorSet( mod->maxs, size, size, size );
+}
+
+// random tree for the world, solid box for brush entities
+static void Test_LinesMakeModels( testlines_t *t )
+{
+	mnode_t	*boxnodes = &t->nodes[TEST_WORLD_NODES];
+	mleaf_t	*boxleafs = &t->leafs[TEST_WORLD_LEAFS];
+	int	i, j;
+
+	for( i = 0; i < TEST_WORLD_NODES; i++ )
+	{
+		mplane_t	*plane = &t->planes[i];
+		int	type = (int)Test_LinesRandom( t, 0.0f, 4.0f );
+
+		if( type < 3 )
+		{
+			plane->normal[type] = 1.0f;
+			plane->type = type;
+		}
+		else
+		{
+			VectorSet( plane->normal, Test_LinesRandom( t, -1.0f, 1.0f ), Test_LinesRandom( t, -1.0f, 1.0f ), Test_LinesRandom( t, -1.0f, 1.0f ));
+			VectorNormalize( plane->normal );
+			plane->type = PLANE_NONAXIAL;
+		}
+		plane->dist = Test_LinesRandom( t, -256.0f, 256.0f );
+
+		t->nodes[i].plane = plane;
+
+		for( j = 0; j < 2; j++ )
+		{
+			int	child = i * 2 + 1 + j;
+
+			if( child < TEST_WORLD_NODES )
+				t->nodes[i].children_[j] = &t->nodes[child];
+			else t->nodes[i].children_[j] = (mnode_t *)&t->leafs[child - TEST_WORLD_NODES];
+		}
+	}
+
+	for( i = 0; i < TEST_WORLD_LEAFS; i++ )
+	{
+		switch( i % 8 )
+		{
+		case 0: case 3: t->leafs[i].contents = CONTENTS_SOLID; break;
+		case 5: t->leafs[i].contents = CONTENTS_SKY; break;
+		case 6: t->leafs[i].contents = CONTENTS_WATER; break;
+		default: t->leafs[i].contents = CONTENTS_EMPTY; break;
+		}
+	}
+
+	// box is a chain of nodes, each pair of them clips one axis
+	boxleafs[0].contents = CONTENTS_EMPTY;
+	boxleafs[1].contents = CONTENTS_SOLID;
+
+	for( i = 0; i < 6; i++ )
+	{
+		mplane_t	*plane = &t->planes[TEST_WORLD_NODES + i];
+		mnode_t	*next = ( i == 5 ) ? (mnode_t *)&boxleafs[1] : &boxnodes[i + 1];
+
+		plane->normal[i / 2] = 1.0f;
+		plane->type = i / 2;
+		plane->dist = ( i & 1 ) ? -16.0f : 16.0f;
+		boxnodes[i].plane = plane;
+		boxnodes[i].children_[0] = ( i & 1 ) ? next : (mnode_t *)&boxleafs[0];
+		boxnodes[i].children_[1] = ( i & 1 ) ? (mnode_t *)&boxleafs[0] : next;
+	}
+
+	Test_LinesSetModel( &t->world, t->nodes, t->leafs, 512.0f );
+	Test_LinesSetModel( &t->box, boxnodes, boxleafs, 16.0f );
+
+	for( i = 0; i < TEST_NUMENTS; i++ )
+	{
+		physent_t	*pe = &t->ents[i];
+
+		pe->model = i ? &t->box : &t->world;
+		pe->solid = SOLID_BSP;
+		pe->rendermode = ( i == 4 ) ? kRenderTransTexture : kRenderNormal;
+
+		if( !i ) continue;
+
+		VectorSet( pe->origin, Test_LinesRandom( t, -256.0f, 256.0f ), Test_LinesRandom( t, -256.0f, 256.0f ), Test_LinesRandom( t, -256.0f, 256.0f ));
+		if( i % 3 == 0 ) VectorSet( pe->angles, 0.0f, Test_LinesRandom( t, 0.0f, 360.0f ), 0.0f );
+	}
+}
+
+// coherent lines fan out from the same point like light gathering does
+static void Test_LinesMakeLines( testlines_t *t, qboolean coherent )
+{
+	vec3_t	center;
+	int	i;
+
+	VectorSet( center, 32.0f, -48.0f, 16.0f );
+
+	for( i = 0; i < TEST_NUMLINES; i++ )
+	{
+		vec3_t	dir;
+
+		if( coherent )
+		{
+			VectorCopy( center, t->starts[i] );
+			VectorSet( dir, Test_LinesRandom( t, -1.0f, 1.0f ), Test_LinesRandom( t, -1.0f, 1.0f ), Test_LinesRandom( t, -1.0f, 1.0f ));
+			VectorNormalize( dir );
+			VectorMA( center, Test_LinesRandom( t, 8.0f, 128.0f ), dir, t->ends[i] );
+		}
+		else
+		{
+			VectorSet( t->starts[i], Test_LinesRandom( t, -512.0f, 512.0f ), Test_LinesRandom( t, -512.0f, 512.0f ), Test_LinesRandom( t, -512.0f, 512.0f ));
+			VectorSet( t->ends[i], Test_LinesRandom( t, -512.0f, 512.0f ), Test_LinesRandom( t, -512.0f, 512.0f ), Test_LinesRandom( t, -512.0f, 512.0f ));
+		}
+	}
+}
+
+static void Test_LinesCompare( testlines_t *t, playermove_t *pmove, const char *name, int flags )
+{
+	double	scalar, batch;
+	int	i, mismatches = 0, solid = 0;
+
+	scalar = Sys_DoubleTime();
+	for( i = 0; i < TEST_NUMLINES; i++ )
+		t->contents[i] = PM_TestLineExt( pmove, t->ents, TEST_NUMENTS, t->starts[i], t->ends[i], flags );
+	scalar = Sys_DoubleTime() - scalar;
+
+	batch = Sys_DoubleTime();
+	PM_TestLinesExt( pmove, t->ents, TEST_NUMENTS, (const vec3_t *)t->starts, (const vec3_t *)t->ends, t->contents, TEST_NUMLINES, flags );
+	batch = Sys_DoubleTime() - batch;
+
+	for( i = 0; i < TEST_NUMLINES; i++ )
+	{
+		int	c = PM_TestLineExt( pmove, t->ents, TEST_NUMENTS, t->starts[i], t->ends[i], flags );
+
+		if( c != t->contents[i] )
+			mismatches++;
+		if( c != CONTENTS_EMPTY )
+			solid++;
+	}
+
+	Con_Printf( "PM_TestLinesExt: %d %s lines, flags %d: scalar %.2f ms, batch %.2f ms, %d blocked\n", TEST_NUMLINES, name, flags, scalar * 1000.0, batch * 1000.0, solid );
+
+	TASSERT_EQi( mismatches, 0 );
+	TASSERT( solid > 0 && solid < TEST_NUMLINES );
+}
+
+static void Test_TestLines( void )
+{
+	testlines_t	*t = Z_Calloc( sizeof( *t ));
+	playermove_t	*pmove = Z_Calloc( sizeof( *pmove ));
+
+	t->seed = 0x1337;
+	pmove->usehull = 2; // point hull
+
+	Test_LinesMakeModels( t );
+
+	Test_LinesMakeLines( t, false );
+	Test_LinesCompare( t, pmove, "random", 0 );
+	Test_LinesCompare( t, pmove, "random", PM_GLASS_IGNORE );
+
+	Test_LinesMakeLines( t, true );
+	Test_LinesCompare( t, pmove, "coherent", 0 );
+	Test_LinesCompare( t, pmove, "coherent", PM_WORLD_ONLY );
+
+	Z_Free( pmove );
+	Z_Free( t );
+}
+
+#define TEST_SURFLINES	65536
+
+typedef struct
+{
+	msurface_t	surfs[TEST_WORLD_NODES];
+	mextrasurf_t	info[TEST_WORLD_NODES];
+	mfacebevel_t	bevels[TEST_WORLD_NODES];
+	mplane_t		edges[TEST_WORLD_NODES * 4];
+} testsurfs_t;
+
+// put a rectangular face on every node plane of the test world
+static void Test_SurfMakeFaces( testlines_t *t, testsurfs_t *ts )
+{
+	int	i, j;
+
+	for( i = 0; i < TEST_WORLD_NODES; i++ )
+	{
+		mplane_t		*plane = t->nodes[i].plane;
+		mfacebevel_t	*fb = &ts->bevels[i];
+		vec3_t		axis[2];
+		float		half[2];
+
+		VectorVectors( plane->normal, axis[0], axis[1] );
+		VectorScale( plane->normal, plane->dist, fb->origin );
+
+		for( j = 0; j < 2; j++ )
+		{
+			half[j] = Test_LinesRandom( t, 8.0f, 128.0f );
+			VectorMA( fb->origin, Test_LinesRandom( t, -256.0f, 256.0f ), axis[j], fb->origin );
+		}
+
+		fb->edges = &ts->edges[i * 4];
+		fb->numedges = 4;
+		fb->radius = half[0] * half[0] + half[1] * half[1] + 1.0f;
+		fb->contents = ( i % 5 == 0 ) ? CONTENTS_EMPTY : CONTENTS_SOLID; // see-through fence texel
+
+		for( j = 0; j < 4; j++ )
+		{
+			mplane_t	*edge = &fb->edges[j];
+
+			if( j & 1 ) VectorNegate( axis[j >> 1], edge->normal );
+			else VectorCopy( axis[j >> 1], edge->normal );
+			edge->type = PLANE_NONAXIAL;
+			edge->dist = DotProduct( fb->origin, edge->normal ) + half[j >> 1];
+		}
+
+		ts->info[i].bevel = fb;
+		ts->info[i].surf = &ts->surfs[i];
+		ts->surfs[i].info = &ts->info[i];
+		ts->surfs[i].plane = plane;
+		t->nodes[i].firstsurface_0 = i;
+		t->nodes[i].numsurfaces_0 = 1;
+	}
+
+	t->world.surfaces = ts->surfs;
+	t->world.numsurfaces = TEST_WORLD_NODES;
+}
+
+static void Test_SurfaceCache( void )
+{
+	testlines_t	*t = Z_Calloc( sizeof( *t ));
+	testsurfs_t	*ts = Z_Calloc( sizeof( *ts ));
+	physent_t		pe;
+	vec3_t		start, end;
+	int		i, j, hits, found = 0, mismatches = 0;
+
+	t->seed = 0x5afe;
+	Test_LinesMakeModels( t );
+	Test_SurfMakeFaces( t, ts );
+
+	memset( &pe, 0, sizeof( pe ));
+	pe.model = &t->world;
+
+	PM_ClearSurfaceCache( true );
+
+	for( i = 0; i < TEST_SURFLINES; i++ )
+	{
+		// repeat the previous segment or move it slightly, like footsteps do
+		if( i == 0 || i % 4 == 0 )
+		{
+			for( j = 0; j < 3; j++ )
+			{
+				start[j] = Test_LinesRandom( t, -512.0f, 512.0f );
+				end[j] = Test_LinesRandom( t, -512.0f, 512.0f );
+			}
+		}
+		else if( i % 4 != 1 )
+		{
+			// stay within the same whole units
+			for( j = 0; j < 3; j++ )
+			{
+				start[j] = floor( start[j] ) + Test_LinesRandom( t, 0.0f, 1.0f );
+				end[j] = floor( end[j] ) + Test_LinesRandom( t, 0.0f, 1.0f );
+			}
+		}
+
+		if( PM_TraceSurface( &pe, start, end ) != PM_RecursiveSurfCheck( &t->world, t->nodes, start, end ))
+			mismatches++;
+
+		if( PM_TraceSurface( &pe, start, end ))
+			found++;
+	}
+
+	hits = pm_surfcachestats.hits;
+
+	// cache points into freed test models
+	PM_ClearSurfaceCache( true );
+
+	TASSERT_EQi( mismatches, 0 );
+	TASSERT( found > 0 && found < TEST_SURFLINES );
+	TASSERT( hits > 0 );
+
+	Z_Free( ts );
+	Z_Free( t );
+}
+
+void Test_RunTestLines( void )
+{
+	TRUN( Test_TestLines( ));
+	TRUN( Test_SurfaceCache( ));
+}
+#endif /* XASH_ENGINE_TESTS */
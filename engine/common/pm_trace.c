@@ -665,11 +665,11 @@ PM_TruePointContents
 */
 int PM_TruePointContents( playermove_t *pmove, const vec3_t p )
 {
-	hull_t	*hull = &pmove->physents[0].model->hulls[0];
+	model_t	*mod = pmove->physents[0].model;
 
-	if( hull )
+	if( mod )
 	{
-		return PM_HullPointContents( hull, hull->firstclipnode, p );
+		return Mod_WorldPointContents( mod, p );
 	}
 	else
 	{
@@ -695,7 +695,7 @@ int PM_PointContents( playermove_t *pmove, const vec3_t p )
 		return CONTENTS_NONE;
 
 	// get base contents from world
-	contents = PM_HullPointContents( &pmove->physents[0].model->hulls[0], 0, p );
+	contents = Mod_WorldPointContents( pmove->physents[0].model, p );
 
 	for( i = 1; i < pmove->numphysent; i++ )
 	{
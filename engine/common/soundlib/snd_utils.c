@@ -18,6 +18,21 @@ GNU General Public License for more details.
 // global sound variables
 sndlib_t	sound;
 
+// sound metadata index
+#define SOUNDINFO_HASH_SIZE	1024
+#define SOUNDINFO_PROBE_SIZE	64	// enough for RIFF, MPEG frame and Ogg headers
+
+typedef struct soundinfo_entry_s
+{
+	struct soundinfo_entry_s *next;
+	soundinfo_t	info;
+	char		name[];
+} soundinfo_entry_t;
+
+static soundinfo_entry_t *sound_info_hash[SOUNDINFO_HASH_SIZE];
+static int sound_info_generation;
+static int sound_info_probes; // header reads, for tests
+
 /*
 =============================================================================
 
@@ -74,49 +89,333 @@ void Sound_Init( void )
 	sound.streamformat = stream_game;
 
 	sound.tempbuffer = NULL;
+
+	memset( sound_info_hash, 0, sizeof( sound_info_hash ));
+	sound_info_generation = g_fsapi.GetGeneration( );
 }
 
 void Sound_Shutdown( void )
 {
 	Mem_Check(); // check for leaks
 	Mem_FreePool( &host.soundpool );
+
+	// entries were allocated from the sound pool
+	memset( sound_info_hash, 0, sizeof( sound_info_hash ));
 }
 
-uint GAME_EXPORT Sound_GetApproxWavePlayLen( const char *filepath )
+/*
+=============================================================================
+
+	SOUND METADATA INDEX
+
+=============================================================================
+*/
+/*
+=================
+Sound_FlushInfo
+
+drop whole index, called when filesystem changes
+=================
+*/
+static void Sound_FlushInfo( void )
 {
-	string    name;
-	file_t    *f;
-	wavehdr_t wav;
-	size_t    filesize;
-	uint      msecs;
+	soundinfo_entry_t *entry, *next;
+	int i;
+
+	for( i = 0; i < SOUNDINFO_HASH_SIZE; i++ )
+	{
+		for( entry = sound_info_hash[i]; entry; entry = next )
+		{
+			next = entry->next;
+			Mem_Free( entry );
+		}
+		sound_info_hash[i] = NULL;
+	}
+}
+
+/*
+=================
+Sound_LookupInfo
+
+returns index entry for specified path,
+creates empty entry if create is true
+=================
+*/
+static soundinfo_entry_t *Sound_LookupInfo( const char *filepath, qboolean create )
+{
+	soundinfo_entry_t *entry;
+	string name;
+	size_t len;
+	uint hash;
+
+	if( !host.soundpool )
+		return NULL;
+
+	// any change of search paths or written file invalidates the whole index
+	if( sound_info_generation != g_fsapi.GetGeneration( ))
+	{
+		Sound_FlushInfo();
+		sound_info_generation = g_fsapi.GetGeneration( );
+	}
 
 	Q_strncpy( name, filepath, sizeof( name ));
 	COM_FixSlashes( name );
+	hash = COM_HashKey( name, SOUNDINFO_HASH_SIZE );
 
-	f = FS_Open( name, "rb", false );
-	if( !f )
-		return 0;
+	for( entry = sound_info_hash[hash]; entry; entry = entry->next )
+	{
+		if( !Q_stricmp( entry->name, name ))
+			return entry;
+	}
+
+	if( !create )
+		return NULL;
 
-	if( FS_Read( f, &wav, sizeof( wav )) != sizeof( wav ))
+	len = strlen( name ) + 1;
+	entry = Mem_Calloc( host.soundpool, sizeof( *entry ) + len );
+	memcpy( entry->name, name, len );
+	entry->next = sound_info_hash[hash];
+	sound_info_hash[hash] = entry;
+
+	return entry;
+}
+
+/*
+=================
+Sound_ParseMPGFrame
+
+fills format from MPEG audio frame header
+=================
+*/
+static qboolean Sound_ParseMPGFrame( soundinfo_t *info, const byte *buf, size_t len )
+{
+	static const uint rates[3] = { 44100, 48000, 32000 };
+	int version, layer, rate;
+
+	if( len < 4 || buf[0] != 0xFF || ( buf[1] & 0xE0 ) != 0xE0 )
+		return false;
+
+	version = ( buf[1] >> 3 ) & 3;	// 0 - MPEG 2.5, 1 - reserved, 2 - MPEG 2, 3 - MPEG 1
+	layer = ( buf[1] >> 1 ) & 3;
+	rate = ( buf[2] >> 2 ) & 3;
+
+	if( version == 1 || layer == 0 || rate == 3 )
+		return false;
+
+	info->rate = rates[rate] >> ( version == 3 ? 0 : version == 2 ? 1 : 2 );
+	info->channels = ( buf[3] >> 6 ) == 3 ? 1 : 2;
+	info->width = 2;
+
+	return true;
+}
+
+/*
+=================
+Sound_ParseHeader
+
+recognize file format by it's first bytes
+and fill everything that can be known without decoding,
+returns offset to MPEG frame if it's not inside of buffer
+=================
+*/
+static size_t Sound_ParseHeader( soundinfo_t *info, const byte *buf, size_t len, fs_offset_t filesize )
+{
+	wavehdr_t wav;
+
+	info->type = WF_UNKNOWN;
+
+	if( len >= sizeof( wav ))
+		memcpy( &wav, buf, sizeof( wav ));
+
+	if( len >= sizeof( wav ) && wav.riff_id == RIFFHEADER && wav.wave_id == WAVEHEADER && wav.fmt_id == FORMHEADER )
 	{
-		FS_Close( f );
-		return 0;
+		fs_offset_t datasize = filesize - 128; // magic number from GoldSrc, seems to be header size
+
+		info->type = WF_PCMDATA;
+		info->rate = wav.nSamplesPerSec;
+		info->channels = wav.nChannels;
+		info->width = wav.nBitsPerSample / 8;
+
+		if( wav.nAvgBytesPerSec >= 1000 )
+			info->approxmsecs = (uint)((float)datasize / ((float)wav.nAvgBytesPerSec / 1000.0f));
+		else if( wav.nAvgBytesPerSec > 0 )
+			info->approxmsecs = (uint)(((float)datasize / (float)wav.nAvgBytesPerSec) * 1000.0f);
+	}
+	else if( len >= 28 && !memcmp( buf, "OggS", 4 ))
+	{
+		size_t packet = 27 + buf[26]; // skip page segment table
+
+		if( len >= packet + 16 && !memcmp( buf + packet, "\x01vorbis", 7 ))
+		{
+			info->type = WF_VORBISDATA;
+			info->channels = buf[packet + 11];
+			info->rate = buf[packet + 12] | ( buf[packet + 13] << 8 ) | ( buf[packet + 14] << 16 ) | ((uint)buf[packet + 15] << 24 );
+			info->width = 2;
+		}
+		else if( len >= packet + 10 && !memcmp( buf + packet, "OpusHead", 8 ))
+		{
+			info->type = WF_OPUSDATA;
+			info->channels = buf[packet + 9];
+			info->rate = 48000; // opus is always decoded at 48 kHz
+			info->width = 2;
+		}
+	}
+	else if( len >= 10 && !memcmp( buf, "ID3", 3 ))
+	{
+		// ID3v2 tag size is stored as syncsafe integer
+		size_t offset = 10 + (( buf[6] & 0x7F ) << 21 | ( buf[7] & 0x7F ) << 14 | ( buf[8] & 0x7F ) << 7 | ( buf[9] & 0x7F ));
+
+		info->type = WF_MPGDATA;
+
+		if( offset + 4 > len )
+			return offset;
+
+		Sound_ParseMPGFrame( info, buf + offset, len - offset );
+	}
+	else if( Sound_ParseMPGFrame( info, buf, len ))
+	{
+		info->type = WF_MPGDATA;
+	}
+
+	return 0;
+}
+
+/*
+=================
+Sound_ProbeInfo
+
+read only file header to fill index entry
+=================
+*/
+static void Sound_ProbeInfo( soundinfo_t *info, const char *filepath )
+{
+	byte buf[SOUNDINFO_PROBE_SIZE];
+	fs_offset_t filesize, len;
+	size_t offset;
+	file_t *f;
+
+	sound_info_probes++;
+	memset( info, 0, sizeof( *info ));
+
+	f = FS_Open( filepath, "rb", false );
+	if( !f )
+	{
+		info->missing = true;
+		return;
 	}
 
 	filesize = FS_FileLength( f );
-	filesize -= 128; // magic number from GoldSrc, seems to be header size
+	len = FS_Read( f, buf, sizeof( buf ));
+
+	if( len > 0 && ( offset = Sound_ParseHeader( info, buf, len, filesize )) != 0 )
+	{
+		// MPEG frame is behind the ID3 tag
+		FS_Seek( f, offset, SEEK_SET );
+		len = FS_Read( f, buf, 4 );
+		Sound_ParseMPGFrame( info, buf, len > 0 ? len : 0 );
+	}
 
 	FS_Close( f );
+}
 
-	// is real wav file ?
-	if( wav.riff_id != RIFFHEADER || wav.wave_id != WAVEHEADER || wav.fmt_id != FORMHEADER )
-		return 0;
+/*
+=================
+Sound_GetInfo
+
+returns format of the sound file without decoding it,
+header is read only once until filesystem changes
+=================
+*/
+qboolean Sound_GetInfo( const char *filepath, soundinfo_t *info )
+{
+	soundinfo_entry_t *entry;
+
+	if( !COM_CheckString( filepath ))
+		return false;
+
+	entry = Sound_LookupInfo( filepath, true );
+
+	if( !entry )
+	{
+		// soundlib isn't initialized yet
+		Sound_ProbeInfo( info, filepath );
+		return !info->missing && info->type != WF_UNKNOWN;
+	}
+
+	if( !entry->info.probed )
+	{
+		Sound_ProbeInfo( &entry->info, entry->name );
+		entry->info.probed = true;
+	}
 
-	if( wav.nAvgBytesPerSec >= 1000 )
-		msecs = (uint)((float)filesize / ((float)wav.nAvgBytesPerSec / 1000.0f));
-	else msecs = (uint)(((float)filesize / (float)wav.nAvgBytesPerSec) * 1000.0f);
+	*info = entry->info;
 
-	return msecs;
+	return !info->missing && info->type != WF_UNKNOWN;
+}
+
+/*
+=================
+Sound_FindInfo
+
+returns indexed information without touching the file
+=================
+*/
+const soundinfo_t *Sound_FindInfo( const char *filepath )
+{
+	soundinfo_entry_t *entry = Sound_LookupInfo( filepath, false );
+
+	return entry ? &entry->info : NULL;
+}
+
+/*
+=================
+Sound_SetInfo
+
+store information from loaded file and decoded sound,
+NULL sound marks the path as missing
+=================
+*/
+void Sound_SetInfo( const char *filepath, const wavdata_t *sc, const byte *buffer, fs_offset_t filesize )
+{
+	soundinfo_entry_t *entry = Sound_LookupInfo( filepath, true );
+
+	if( !entry )
+		return;
+
+	memset( &entry->info, 0, sizeof( entry->info ));
+	entry->info.probed = true;
+
+	if( !sc )
+	{
+		entry->info.missing = true;
+		return;
+	}
+
+	if( buffer && filesize > 0 )
+		Sound_ParseHeader( &entry->info, buffer, filesize, filesize );
+
+	// decoder knows better
+	entry->info.rate = sc->rate;
+	entry->info.width = sc->width;
+	entry->info.channels = sc->channels;
+	entry->info.samples = sc->samples;
+	entry->info.loopStart = sc->loopStart;
+	entry->info.flags = sc->flags;
+	entry->info.decoded = true;
+
+	if( entry->info.type == WF_UNKNOWN )
+		entry->info.type = sc->type;
+}
+
+uint GAME_EXPORT Sound_GetApproxWavePlayLen( const char *filepath )
+{
+	soundinfo_t info;
+
+	// only WAV files have approximated length, like in GoldSrc
+	if( !Sound_GetInfo( filepath, &info ) || info.type != WF_PCMDATA )
+		return 0;
+
+	return info.approxmsecs;
 }
 
 #define SOUND_FORMATCONVERT_BOILERPLATE( resamplemacro ) \
@@ -312,6 +611,119 @@ uint GAME_EXPORT Sound_GetApproxWavePlayLen( const char *filepath )
 	else \
 		return false; \
 
+// integer ratio of sample rates, index computation is exact
+#define SOUND_CONVERTDECIMATE_BOILERPLATE( multiplier ) \
+	if( inchannels == 1 ) \
+	{ \
+		if( outchannels == 1 ) \
+		{ \
+			for( i = 0; i < outcount; i++ ) \
+				outdata[i] = data[i * step] * ( multiplier ); \
+		} \
+		else if( outchannels == 2 ) \
+		{ \
+			for( i = 0; i < outcount; i++ ) \
+			{ \
+				outdata[i * 2 + 0] = data[i * step] * ( multiplier ); \
+				outdata[i * 2 + 1] = data[i * step] * ( multiplier ); \
+			} \
+		} \
+		else \
+			return false; \
+	} \
+	else if( inchannels == 2 ) \
+	{ \
+		if( outchannels == 1 ) \
+		{ \
+			for( i = 0; i < outcount; i++ ) \
+				outdata[i] = ( data[i * step * 2 + 0] + data[i * step * 2 + 1] ) * ( multiplier ) / 2; \
+		} \
+		else if( outchannels == 2 ) \
+		{ \
+			for( i = 0; i < outcount; i++ ) \
+			{ \
+				outdata[i * 2 + 0] = data[i * step * 2 + 0] * ( multiplier ); \
+				outdata[i * 2 + 1] = data[i * step * 2 + 1] * ( multiplier ); \
+			} \
+		} \
+		else \
+			return false; \
+	} \
+	else \
+		return false; \
+
+// power of two upsampling ratio, fractions are exact in double precision
+// so result is the same as with generic upsampling
+#define SOUND_CONVERTUPSAMPLEPOW2_BOILERPLATE( multiplier ) \
+	if( inchannels == 1 ) \
+	{ \
+		if( outchannels == 1 ) \
+		{ \
+			for( i = 0; i < outcount; i++ ) \
+			{ \
+				size_t j = i >> shift; \
+				outdata[i] = data[j] * ( multiplier ); \
+				if(( i & mask ) && (int)j < incount ) \
+				{ \
+					double frac = ( i & mask ) * fracstep * ( multiplier ); \
+					outdata[i] += ( data[j + 1] - data[j] ) * frac; \
+				} \
+			} \
+		} \
+		else if( outchannels == 2 ) \
+		{ \
+			for( i = 0; i < outcount; i++ ) \
+			{ \
+				size_t j = i >> shift; \
+				outdata[i * 2 + 0] = data[j] * ( multiplier ); \
+				if(( i & mask ) && (int)j < incount ) \
+				{ \
+					double frac = ( i & mask ) * fracstep * ( multiplier ); \
+					outdata[i * 2 + 0] += ( data[j + 1] - data[j] ) * frac; \
+				} \
+				outdata[i * 2 + 1] = outdata[i * 2 + 0]; \
+			} \
+		} \
+		else \
+			return false; \
+	} \
+	else if( inchannels == 2 ) \
+	{ \
+		if( outchannels == 1 ) \
+		{ \
+			for( i = 0; i < outcount; i++ ) \
+			{ \
+				size_t j = i >> shift; \
+				outdata[i] = ( data[j * 2 + 0] + data[j * 2 + 1] ) * ( multiplier ) / 2; \
+				if(( i & mask ) && (int)j < incount ) \
+				{ \
+					double frac = ( i & mask ) * fracstep * ( multiplier ) / 2; \
+					outdata[i] += ( data[( j + 1 ) * 2 + 0] - data[j * 2 + 0] ) * frac; \
+					outdata[i] += ( data[( j + 1 ) * 2 + 1] - data[j * 2 + 1] ) * frac; \
+				} \
+			} \
+		} \
+		else if( outchannels == 2 ) \
+		{ \
+			for( i = 0; i < outcount; i++ ) \
+			{ \
+				size_t j = i >> shift; \
+				outdata[i * 2 + 0] = data[j * 2 + 0] * ( multiplier ); \
+				outdata[i * 2 + 1] = data[j * 2 + 1] * ( multiplier ); \
+				if(( i & mask ) && (int)j < incount ) \
+				{ \
+					double frac = ( i & mask ) * fracstep * ( multiplier ); \
+					outdata[i * 2 + 0] += ( data[( j + 1 ) * 2 + 0] - data[j * 2 + 0] ) * frac; \
+					outdata[i * 2 + 1] += ( data[( j + 1 ) * 2 + 1] - data[j * 2 + 1] ) * frac; \
+				} \
+			} \
+		} \
+		else \
+			return false; \
+	} \
+	else \
+		return false; \
+
 static qboolean Sound_ConvertNoResample( wavdata_t *sc, int inwidth, int inchannels, int outwidth, int outchannels, int outcount )
 {
 	size_t i;
@@ -344,10 +756,34 @@ static qboolean Sound_ConvertUpsample( wavdata_t *sc, int inwidth, int inchannel
 	return true;
 }
 
+static qboolean Sound_ConvertDecimate( wavdata_t *sc, int inwidth, int inchannels, int outwidth, int outchannels, int outcount, size_t step )
+{
+	size_t i;
+
+	SOUND_FORMATCONVERT_BOILERPLATE( SOUND_CONVERTDECIMATE_BOILERPLATE )
+
+	return true;
+}
+
+static qboolean Sound_ConvertUpsamplePow2( wavdata_t *sc, int inwidth, int inchannels, int incount, int outwidth, int outchannels, int outcount, int shift )
+{
+	const size_t mask = ( 1 << shift ) - 1;
+	const double fracstep = 1.0 / ( 1 << shift );
+	size_t i;
+
+	incount--; // to not go past last sample while interpolating
+
+	SOUND_FORMATCONVERT_BOILERPLATE( SOUND_CONVERTUPSAMPLEPOW2_BOILERPLATE )
+
+	return true;
+}
+
 #undef SOUND_FORMATCONVERT_BOILERPLATE
 #undef SOUND_CONVERTNORESAMPLE_BOILERPLATE
 #undef SOUND_CONVERTDOWNSAMPLE_BOILERPLATE
 #undef SOUND_CONVERTUPSAMPLE_BOILERPLATE
+#undef SOUND_CONVERTDECIMATE_BOILERPLATE
+#undef SOUND_CONVERTUPSAMPLEPOW2_BOILERPLATE
 
 /*
 ================
@@ -366,6 +802,7 @@ static qboolean Sound_ResampleInternal( wavdata_t *sc, int outrate, int outwidth
 	double stepscale;
 	double t1, t2;
 	int	outcount;
+	int	upshift = 0;
 
 	if( inrate == outrate && inwidth == outwidth && inchannels == outchannels )
 		return false;
@@ -383,10 +820,26 @@ static qboolean Sound_ResampleInternal( wavdata_t *sc, int outrate, int outwidth
 
 	sound.tempbuffer = (byte *)Mem_Realloc( host.soundpool, sound.tempbuffer, sc->size );
 
+	// check for power of two upsampling ratio
+	if( outrate > inrate && outrate % inrate == 0 )
+	{
+		const int ratio = outrate / inrate;
+
+		if(( ratio & ( ratio - 1 )) == 0 )
+		{
+			while(( 1 << upshift ) < ratio )
+				upshift++;
+		}
+	}
+
 	if( inrate == outrate ) // no resampling, just copy data
 		handled = Sound_ConvertNoResample( sc, inwidth, inchannels, outwidth, outchannels, outcount );
+	else if( inrate > outrate && inrate % outrate == 0 ) // integer ratio, skip samples without floating point
+		handled = Sound_ConvertDecimate( sc, inwidth, inchannels, outwidth, outchannels, outcount, inrate / outrate );
 	else if( inrate > outrate ) // fast case, usually downsample but is also ok for upsampling
 		handled = Sound_ConvertDownsample( sc, inwidth, inchannels, outwidth, outchannels, outcount, stepscale );
+	else if( upshift > 0 ) // upsample by 2, 4, etc
+		handled = Sound_ConvertUpsamplePow2( sc, inwidth, inchannels, incount, outwidth, outchannels, outcount, upshift );
 	else // upsample case, w/ interpolation
 		handled = Sound_ConvertUpsample( sc, inwidth, inchannels, incount, outwidth, outchannels, outcount, stepscale );
 
@@ -457,3 +910,197 @@ qboolean Sound_SupportedFileFormat( const char *fileext )
 	}
 	return false;
 }
+
+#if XASH_ENGINE_TESTS
+#include "tests.h"
+
+static void Test_WriteSoundFile( const char *name, const byte *header, size_t headersize, size_t filesize )
+{
+	byte *buf = Z_Calloc( filesize );
+
+	memcpy( buf, header, headersize );
+	FS_WriteFile( name, buf, filesize );
+	Z_Free( buf );
+}
+
+void Test_RunSoundInfo( void )
+{
+	const byte mp3[] = { 'I', 'D', '3', 4, 0, 0, 0, 0, 0, 2, 0, 0, 0xFF, 0xFB, 0x90, 0xC4 };
+	const byte ogg[] = { 'O', 'g', 'g', 'S', 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 30,
+		1, 'v', 'o', 'r', 'b', 'i', 's', 0, 0, 0, 0, 2, 0x22, 0x56, 0, 0 };
+	const byte opus[] = { 'O', 'g', 'g', 'S', 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 19,
+		'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1, 1 };
+	wavehdr_t wav = { 0 };
+	soundinfo_t info;
+	int probes;
+
+	wav.riff_id = RIFFHEADER;
+	wav.wave_id = WAVEHEADER;
+	wav.fmt_id = FORMHEADER;
+	wav.pcm_header_len = 16;
+	wav.wFormatTag = 1;
+	wav.nChannels = 1;
+	wav.nSamplesPerSec = 22050;
+	wav.nAvgBytesPerSec = 44100;
+	wav.nBlockAlign = 2;
+	wav.nBitsPerSample = 16;
+
+	// one second of 22 kHz 16-bit sound plus GoldSrc header size
+	Test_WriteSoundFile( "test_info.wav", (byte *)&wav, sizeof( wav ), 44100 + 128 );
+	Test_WriteSoundFile( "test_info.mp3", mp3, sizeof( mp3 ), 1024 );
+	Test_WriteSoundFile( "test_info.ogg", ogg, sizeof( ogg ), 1024 );
+	Test_WriteSoundFile( "test_info.opus", opus, sizeof( opus ), 1024 );
+
+	TASSERT_EQi( Sound_GetApproxWavePlayLen( "test_info.wav" ), 1000 );
+	TASSERT( Sound_GetInfo( "test_info.wav", &info ));
+	TASSERT_EQi( info.type, WF_PCMDATA );
+	TASSERT_EQi( info.rate, 22050 );
+	TASSERT_EQi( info.width, 2 );
+	TASSERT_EQi( info.channels, 1 );
+
+	TASSERT( Sound_GetInfo( "test_info.mp3", &info ));
+	TASSERT_EQi( info.type, WF_MPGDATA );
+	TASSERT_EQi( info.rate, 44100 );
+	TASSERT_EQi( info.channels, 1 );
+	TASSERT_EQi( Sound_GetApproxWavePlayLen( "test_info.mp3" ), 0 );
+
+	TASSERT( Sound_GetInfo( "test_info.ogg", &info ));
+	TASSERT_EQi( info.type, WF_VORBISDATA );
+	TASSERT_EQi( info.rate, 22050 );
+	TASSERT_EQi( info.channels, 2 );
+
+	TASSERT( Sound_GetInfo( "test_info.opus", &info ));
+	TASSERT_EQi( info.type, WF_OPUSDATA );
+	TASSERT_EQi( info.rate, 48000 );
+
+	TASSERT( !Sound_GetInfo( "test_info_missing.wav", &info ));
+	TASSERT( info.missing );
+
+	// repeated queries must not touch the files
+	probes = sound_info_probes;
+	TASSERT_EQi( Sound_GetApproxWavePlayLen( "test_info.wav" ), 1000 );
+	TASSERT_EQi( Sound_GetApproxWavePlayLen( "test_info_missing.wav" ), 0 );
+	TASSERT( Sound_GetInfo( "test_info.mp3", &info ));
+	TASSERT_EQi( sound_info_probes, probes );
+
+	// decoder information is kept
+	{
+		wavdata_t sc = { 0 };
+
+		sc.type = WF_PCMDATA;
+		sc.rate = 22050;
+		sc.width = 2;
+		sc.channels = 1;
+		sc.samples = 22050;
+		sc.loopStart = 100;
+		sc.flags = SOUND_LOOPED;
+		Sound_SetInfo( "test_info.wav", &sc, NULL, 0 );
+		TASSERT( Sound_GetInfo( "test_info.wav", &info ));
+		TASSERT( info.decoded );
+		TASSERT_EQi( info.samples, 22050 );
+		TASSERT_EQi( info.loopStart, 100 );
+		TASSERT_EQi( sound_info_probes, probes );
+	}
+
+	// rewriting the file changes generation and invalidates the index
+	Test_WriteSoundFile( "test_info.wav", (byte *)&wav, sizeof( wav ), 22050 + 128 );
+	TASSERT_EQi( Sound_GetApproxWavePlayLen( "test_info.wav" ), 500 );
+	TASSERT_EQi( sound_info_probes, probes + 1 );
+	TASSERT( Sound_GetInfo( "test_info.wav", &info ));
+	TASSERT( !info.decoded );
+
+	FS_Delete( "test_info.wav" );
+	FS_Delete( "test_info.mp3" );
+	FS_Delete( "test_info.ogg" );
+	FS_Delete( "test_info.opus" );
+	TASSERT_EQi( Sound_GetApproxWavePlayLen( "test_info.wav" ), 0 );
+}
+
+static wavdata_t *Test_MakeSound( int rate, int width, int channels, int samples )
+{
+	size_t size = samples * width * channels;
+	wavdata_t *sc = Mem_Calloc( host.soundpool, sizeof( *sc ) + size );
+	uint seed = 0x12345678;
+	size_t i;
+
+	sc->type = WF_PCMDATA;
+	sc->rate = rate;
+	sc->width = width;
+	sc->channels = channels;
+	sc->samples = samples;
+	sc->size = size;
+
+	for( i = 0; i < size; i++ )
+	{
+		seed = seed * 1103515245 + 12345;
+		sc->buffer[i] = seed >> 24;
+	}
+
+	return sc;
+}
+
+static qboolean Test_ResampleMatches( int inrate, int inwidth, int inchannels, int outrate, int outwidth, int outchannels, double *reftime, double *fasttime )
+{
+	wavdata_t *sc = Test_MakeSound( inrate, inwidth, inchannels, 44101 );
+	const double stepscale = (double)inrate / outrate;
+	const int outcount = sc->samples / stepscale;
+	const size_t outsize = outcount * outwidth * outchannels;
+	qboolean result;
+	double t;
+	byte *ref;
+
+	// generic code is the reference
+	sound.tempbuffer = Mem_Realloc( host.soundpool, sound.tempbuffer, outsize );
+	t = Sys_DoubleTime();
+	if( inrate > outrate )
+		Sound_ConvertDownsample( sc, inwidth, inchannels, outwidth, outchannels, outcount, stepscale );
+	else Sound_ConvertUpsample( sc, inwidth, inchannels, sc->samples, outwidth, outchannels, outcount, stepscale );
+	*reftime += Sys_DoubleTime() - t;
+
+	ref = Mem_Malloc( host.soundpool, outsize );
+	memcpy( ref, sound.tempbuffer, outsize );
+
+	t = Sys_DoubleTime();
+	result = Sound_Process( &sc, outrate, outwidth, outchannels, SOUND_RESAMPLE );
+	*fasttime += Sys_DoubleTime() - t;
+
+	result = result && sc->size == outsize && !memcmp( sc->buffer, ref, outsize );
+
+	Mem_Free( ref );
+	Mem_Free( sc );
+
+	return result;
+}
+
+void Test_RunSoundResample( void )
+{
+	const int rates[][2] =
+	{
+		{ 44100, 22050 },
+		{ 44100, 11025 },
+		{ 33075, 11025 },
+		{ 11025, 22050 },
+		{ 11025, 44100 },
+		{ 22050, 44100 },
+	};
+	double reftime = 0.0, fasttime = 0.0;
+	int i, inwidth, inchannels, outwidth, outchannels;
+
+	for( i = 0; i < sizeof( rates ) / sizeof( rates[0] ); i++ )
+	{
+		for( inwidth = 1; inwidth <= 2; inwidth++ )
+		for( inchannels = 1; inchannels <= 2; inchannels++ )
+		for( outwidth = 1; outwidth <= 2; outwidth++ )
+		for( outchannels = 1; outchannels <= 2; outchannels++ )
+		{
+			qboolean match = Test_ResampleMatches( rates[i][0], inwidth, inchannels, rates[i][1], outwidth, outchannels, &reftime, &fasttime );
+
+			if( !match )
+				Msg( S_ERROR "resample mismatch from [%d bit %d Hz %dch] to [%d bit %d Hz %dch]\n", inwidth * 8, rates[i][0], inchannels, outwidth * 8, rates[i][1], outchannels );
+			TASSERT( match );
+		}
+	}
+
+	Msg( "Sound_Process integer ratios: generic %.3f ms, fast %.3f ms\n", reftime * 1000.0, fasttime * 1000.0 );
+}
+#endif /* XASH_ENGINE_TESTS */
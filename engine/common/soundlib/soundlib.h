@@ -75,6 +75,7 @@ struct stream_s
 	char		temp[OUTBUF_SIZE]; // mpeg decoder stuff
 	size_t		pos;	// actual track position (or actual buffer remains)
 	int		buffsize;	// cached buffer size
+	qboolean		ondisk;	// not inside of an archive
 };
 
 /*
@@ -112,11 +113,13 @@ typedef struct
 } chunkhdr_t;
 
 extern sndlib_t sound;
+void Sound_Reset( void );
 //
 // formats load
 //
 qboolean Sound_LoadWAV( const char *name, const byte *buffer, fs_offset_t filesize );
 qboolean Sound_LoadMPG( const char *name, const byte *buffer, fs_offset_t filesize );
+void Sound_BenchMPG_f( void );
 qboolean Sound_LoadOggVorbis( const char *name, const byte *buffer, fs_offset_t filesize );
 qboolean Sound_LoadOggOpus( const char *name, const byte *buffer, fs_offset_t filesize );
 
@@ -33,6 +33,7 @@ extern struct tests_stats_s tests_stats;
 	_TASSERT( Q_strcmp(( str1 ), ( str2 )), Msg( S_ERROR "assert failed at %s:%i, \"%s\" != \"%s\"\n", __FILE__, __LINE__, ( str1 ), ( str2 )))
 
 void Test_RunImagelib( void );
+void Test_RunImageQuantize( void );
 void Test_RunLibCommon( void );
 void Test_RunCommon( void );
 void Test_RunCmd( void );
@@ -44,6 +45,16 @@ void Test_RunGamma( void );
 void Test_RunDelta( void );
 void Test_RunBuffer( void );
 void Test_RunMunge( void );
+void Test_RunContentsGrid( void );
+void Test_RunTestLines( void );
+void Test_RunSoundInfo( void );
+void Test_RunSoundResample( void );
+void Test_RunModelCache( void );
+void Test_RunBspCache( void );
+void Test_RunCustomization( void );
+void Test_RunTouch( void );
+void Test_RunServerBrowser( void );
+void Test_RunPushCandidates( void );
 
 #define TEST_LIST_0 \
 	Test_RunLibCommon(); \
@@ -53,14 +64,25 @@ void Test_RunMunge( void );
 	Test_RunIPFilter(); \
 	Test_RunBuffer(); \
 	Test_RunDelta(); \
-	Test_RunMunge();
+	Test_RunMunge(); \
+	Test_RunContentsGrid(); \
+	Test_RunTestLines();
 
 #define TEST_LIST_0_CLIENT \
 	Test_RunCon(); \
-	Test_RunGamma();
+	Test_RunGamma(); \
+	Test_RunTouch(); \
+	Test_RunServerBrowser();
 
 #define TEST_LIST_1 \
-	Test_RunImagelib();
+	Test_RunImagelib(); \
+	Test_RunImageQuantize(); \
+	Test_RunSoundInfo(); \
+	Test_RunSoundResample(); \
+	Test_RunModelCache(); \
+	Test_RunBspCache(); \
+	Test_RunCustomization(); \
+	Test_RunPushCandidates();
 
 #define TEST_LIST_1_CLIENT \
 	Test_RunVOX();
@@ -440,6 +440,21 @@ qboolean Mem_IsAllocatedExt( poolhandle_t poolptr, void *data )
 	return Mem_CheckAlloc( pool, data );
 }
 
+/*
+========================
+Mem_PoolSize
+
+returns amount of memory allocated in pool
+========================
+*/
+size_t Mem_PoolSize( poolhandle_t poolptr )
+{
+	if( !poolptr )
+		return 0;
+
+	return Mem_FindPool( poolptr )->totalsize;
+}
+
 void _Mem_Check( const char *filename, int fileline )
 {
 	memheader_t *mem;
@@ -290,6 +290,97 @@ typedef struct
 	int		fixangle;
 } sv_pushed_t;
 
+typedef struct
+{
+	int		prev;
+	int		next;
+} sv_edictlink_t;
+
+typedef struct
+{
+	uint		allocated;	// total SV_AllocEdict calls
+	uint		reused;		// ...satisfied from the free queue
+	uint		freed;		// total freed edicts
+	int		sleeping;		// entities skipped by physics last frame
+	int		awake;		// entities simulated by physics last frame
+	int		predicted;	// world traces precomputed last frame
+	int		predictreused;	// ...and used by physics
+	int		mismatched;	// ...and differed from the real trace (verify mode)
+} sv_edictstats_t;
+
+typedef struct
+{
+	int		restframes;	// how long entity is resting
+	qboolean		asleep;
+	int		movetype;		// state when entity fell asleep
+	int		flags;
+	edict_t		*ground;
+	vec3_t		origin;
+	vec3_t		angles;
+	vec3_t		groundorigin;
+} sv_sleepstate_t;
+
+#define ENTITY_CLASS_HASH_SIZE	1024	// must be power of two
+
+typedef struct sv_entityclass_s
+{
+	struct sv_entityclass_s	*next;
+	void		*func;		// spawn function exported by game dll or NULL
+	char		name[];
+} sv_entityclass_t;
+
+typedef struct
+{
+	CRC32_t		crc;		// entity lump text checksum
+	size_t		length;		// entity lump text length
+	int		numtokens;
+	char		**tokens;		// followed by tokens text
+} sv_entlump_t;
+
+#define TRACE_CACHE_SIZE	1024	// must be power of two
+
+typedef struct
+{
+	edict_t		*passedict;
+	vec3_t		start;
+	vec3_t		end;
+	vec3_t		mins;
+	vec3_t		maxs;
+	int		type;
+	int		monsterclip;
+	int		groupinfo;	// passedict groupinfo
+	int		groupop;
+	int		traceflags;	// globals->trace_flags
+} sv_tracekey_t;
+
+typedef struct
+{
+	uint		generation;	// valid only for current generation
+	sv_tracekey_t	key;
+	trace_t		trace;
+} sv_tracecacheentry_t;
+
+typedef struct
+{
+	uint		generation;	// bumped when anything is linked or unlinked
+	uint		hits;
+	uint		misses;
+	uint		mismatches;	// verify mode
+	uint		invalidations;
+	sv_tracecacheentry_t	entries[TRACE_CACHE_SIZE];
+} sv_tracecache_t;
+
+typedef struct
+{
+	qboolean		valid;
+	int		framecount;	// sv.framecount when prediction was made
+	vec3_t		start;
+	vec3_t		end;
+	vec3_t		mins;
+	vec3_t		maxs;
+	trace_t		worldtrace;	// world hull part of the move
+} sv_tossmove_t;
+
 typedef struct
 {
 	qboolean		active;
@@ -326,6 +417,12 @@ typedef struct
 
 	edict_t		*edicts;			// solid array of server entities
 	int		numEntities;		// actual entities count
+	sv_edictlink_t	*freequeue;		// [GI->max_edicts + 1] freed edicts ordered by freetime, last is head
+	uint32_t		*activeedicts;		// bit per edict, set if edict is in use
+	sv_sleepstate_t	*sleepstates;		// [GI->max_edicts] resting entities state
+	sv_tossmove_t	*tossmoves;		// [GI->max_edicts] world traces precomputed by SV_PredictTossMoves
+	sv_tracecache_t	*tracecache;		// SV_Move results memoized until something is relinked
+	sv_edictstats_t	edictstats;		// edicts churn counters
 
 	movevars_t	movevars;			// movement variables curstate
 	movevars_t	oldmovevars;		// movement variables oldstate
@@ -333,6 +430,12 @@ typedef struct
 	sv_interp_t	interp[MAX_CLIENTS];	// interpolate clients
 	sv_pushed_t	pushed[MAX_PUSHED_ENTS];	// no reason to keep array for all edicts
 						// 256 it should be enough for any game situation
+	edict_t		**pushcheck;		// [GI->max_edicts] pusher broadphase candidates
+	sv_edictlink_t	*riderlinks;		// [GI->max_edicts * 2] entities filed by groundentity, second half are list heads
+	int		numriderlinks;		// edicts with valid rider links this frame
+	edict_t		**tosscheck;		// [GI->max_edicts] toss trace broadphase candidates
+	sv_entityclass_t	**entityclasses;		// [ENTITY_CLASS_HASH_SIZE] classname to spawn function cache
+	sv_entlump_t	entlump;			// tokenized entity lump of the last spawned map
 
 	globalvars_t	*globals;			// server globals
 
@@ -441,6 +544,9 @@ extern convar_t		sv_nat;
 extern convar_t		sv_speedhack_kick;
 extern convar_t		sv_pausable;		// allows pause in multiplayer
 extern convar_t		sv_check_errors;
+extern convar_t		sv_sleepents;
+extern convar_t		sv_parallel_toss;
+extern convar_t		sv_tracecache;
 extern convar_t		sv_lighting_modulate;
 extern convar_t		sv_novis;
 extern convar_t		sv_hostmap;
@@ -605,6 +711,8 @@ void SV_FreeEdicts( void );
 edict_t *SV_AllocEdict( void );
 void SV_FreeEdict( edict_t *pEdict );
 void SV_InitEdict( edict_t *pEdict );
+void SV_ClearFreeEdicts( void );
+int SV_NextActiveEdict( int num );
 const char *SV_ClassName( const edict_t *e );
 void SV_CopyTraceToGlobal( trace_t *trace );
 qboolean SV_CheckEdict( const edict_t *e, const char *file, const int line );
@@ -681,11 +789,15 @@ void SV_UnlinkEdict( edict_t *ent );
 void SV_ClipMoveToEntity( edict_t *ent, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, trace_t *trace );
 void SV_CustomClipMoveToEntity( edict_t *ent, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, trace_t *trace );
 trace_t SV_Move( const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int type, edict_t *e, qboolean monsterclip );
+void SV_InvalidateTraceCache( void );
+trace_t SV_MoveFromWorldTrace( const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int type, edict_t *e, qboolean monsterclip, const trace_t *worldtrace );
 trace_t SV_MoveNoEnts( const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int type, edict_t *e );
 const char *SV_TraceTexture( edict_t *ent, const vec3_t start, const vec3_t end );
 msurface_t *SV_TraceSurface( edict_t *ent, const vec3_t start, const vec3_t end );
 trace_t SV_MoveToss( edict_t *tossent, edict_t *ignore );
+trace_t SV_MoveTossStepped( edict_t *tossent, edict_t *ignore );
 void SV_LinkEdict( edict_t *ent, qboolean touch_triggers );
+int SV_AreaEdicts( const vec3_t mins, const vec3_t maxs, edict_t **list, int maxcount );
 int SV_TruePointContents( const vec3_t p );
 int SV_PointContents( const vec3_t p );
 void SV_SetLightStyle( int style, const char* s, float f );
@@ -928,6 +928,109 @@ static void SV_EdictUsage_f( void )
 	Con_Printf( "%5i edicts is used\n", active );
 	Con_Printf( "%5i edicts is free\n", GI->max_edicts - active );
 	Con_Printf( "%5i total\n", GI->max_edicts );
+	Con_Printf( "%5i highest edict number\n", svgame.numEntities - 1 );
+	Con_Printf( "%5u allocated (%u reused), %u freed\n", svgame.edictstats.allocated,
+		svgame.edictstats.reused, svgame.edictstats.freed );
+	Con_Printf( "%5i sleeping, %i awake last frame\n", svgame.edictstats.sleeping, svgame.edictstats.awake );
+	Con_Printf( "%5i toss moves predicted, %i reused, %i mismatched last frame\n", svgame.edictstats.predicted,
+		svgame.edictstats.predictreused, svgame.edictstats.mismatched );
+}
+
+/*
+===============
+SV_TossBench_f
+
+compares swept toss trace against the stepped one
+===============
+*/
+static void SV_TossBench_f( void )
+{
+	double	stepped_time = 0.0, swept_time = 0.0, t;
+	int	i, count, mismatches = 0, tested = 0;
+	vec3_t	saved_velocity;
+	float	saved_gravity;
+	trace_t	tr1, tr2;
+	edict_t	*ent;
+	int	num = 0;
+
+	if( sv.state != ss_active )
+	{
+		Con_Printf( "^3no server running.\n" );
+		return;
+	}
+
+	count = Cmd_Argc() > 1 ? Q_atoi( Cmd_Argv( 1 )) : 1000;
+
+	for( i = 0; i < count; i++ )
+	{
+		// throw from every entity in turn, like monsters do
+		num = SV_NextActiveEdict( num );
+		if( num >= svgame.numEntities )
+			num = SV_NextActiveEdict( 0 );
+		if( num >= svgame.numEntities )
+			break;
+
+		ent = EDICT_NUM( num );
+		if( !SV_IsValidEdict( ent ))
+			continue;
+
+		VectorCopy( ent->v.velocity, saved_velocity );
+		saved_gravity = ent->v.gravity;
+		ent->v.gravity = 1.0f;
+		VectorSet( ent->v.velocity, COM_RandomFloat( -800.0f, 800.0f ), COM_RandomFloat( -800.0f, 800.0f ), COM_RandomFloat( 0.0f, 600.0f ));
+
+		t = Platform_DoubleTime();
+		tr1 = SV_MoveTossStepped( ent, ent );
+		stepped_time += Platform_DoubleTime() - t;
+
+		t = Platform_DoubleTime();
+		tr2 = SV_MoveToss( ent, ent );
+		swept_time += Platform_DoubleTime() - t;
+
+		VectorCopy( saved_velocity, ent->v.velocity );
+		ent->v.gravity = saved_gravity;
+		tested++;
+
+		if( tr1.fraction != tr2.fraction || tr1.ent != tr2.ent || !VectorCompare( tr1.endpos, tr2.endpos )
+			|| !VectorCompare( tr1.plane.normal, tr2.plane.normal ) || tr1.allsolid != tr2.allsolid
+			|| tr1.startsolid != tr2.startsolid || tr1.inopen != tr2.inopen || tr1.inwater != tr2.inwater )
+		{
+			if( mismatches++ < 10 )
+				Con_Printf( S_WARN "toss from %s (%i) differs: %g %g %g vs %g %g %g\n", SV_ClassName( ent ), num,
+					tr1.endpos[0], tr1.endpos[1], tr1.endpos[2], tr2.endpos[0], tr2.endpos[1], tr2.endpos[2] );
+		}
+	}
+
+	Con_Printf( "%i toss traces, %i mismatches\n", tested, mismatches );
+	Con_Printf( "stepped: %.2f ms, swept: %.2f ms\n", stepped_time * 1000.0, swept_time * 1000.0 );
+}
+
+/*
+===============
+SV_TraceCacheInfo_f
+
+===============
+*/
+static void SV_TraceCacheInfo_f( void )
+{
+	const sv_tracecache_t *cache = svgame.tracecache;
+	uint total;
+
+	if( !cache )
+	{
+		Con_Printf( "^3no server running.\n" );
+		return;
+	}
+
+	total = cache->hits + cache->misses;
+	Con_Printf( "%u hits, %u misses (%.1f%% hit rate)\n", cache->hits, cache->misses, total ? cache->hits * 100.0 / total : 0.0 );
+	Con_Printf( "%u invalidations, %u mismatches\n", cache->invalidations, cache->mismatches );
+
+	if( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ))
+	{
+		svgame.tracecache->hits = svgame.tracecache->misses = 0;
+		svgame.tracecache->invalidations = svgame.tracecache->mismatches = 0;
+	}
 }
 
 /*
@@ -1058,6 +1161,8 @@ void SV_InitOperatorCommands( void )
 	Cmd_AddCommand( "entpatch", SV_EntPatch_f, "write entity patch to allow external editing" );
 	Cmd_AddCommand( "edict_usage", SV_EdictUsage_f, "show info about edicts usage" );
 	Cmd_AddCommand( "entity_info", SV_EntityInfo_f, "show more info about edicts" );
+	Cmd_AddCommand( "sv_tracecache_info", SV_TraceCacheInfo_f, "show trace cache hit rate, \"reset\" clears counters" );
+	Cmd_AddCommand( "sv_tossbench", SV_TossBench_f, "benchmark toss traces against the stepped reference (count is optional)" );
 	Cmd_AddCommand( "shutdownserver", SV_KillServer_f, "shutdown current server" );
 	Cmd_AddCommand( "changelevel", SV_ChangeLevel_f, "change level" );
 	Cmd_AddCommand( "changelevel2", SV_ChangeLevel2_f, "smooth change level" );
@@ -986,6 +986,81 @@ static void GAME_EXPORT SV_FreePrivateData( edict_t *pEdict )
 	pEdict->pvPrivateData = NULL;
 }
 
+/*
+==============
+SV_UnlinkFreeEdict
+
+remove edict from the free queue, if it was queued
+==============
+*/
+static void SV_UnlinkFreeEdict( int num )
+{
+	sv_edictlink_t	*link = &svgame.freequeue[num];
+
+	if( link->prev == -1 )
+		return;
+
+	svgame.freequeue[link->prev].next = link->next;
+	svgame.freequeue[link->next].prev = link->prev;
+	link->prev = link->next = -1;
+}
+
+/*
+==============
+SV_ClearFreeEdicts
+
+drop all queued edicts, must be called
+when svgame.numEntities was reset
+==============
+*/
+void SV_ClearFreeEdicts( void )
+{
+	int	i;
+
+	if( !svgame.freequeue )
+		return;
+
+	for( i = 0; i < GI->max_edicts; i++ )
+		svgame.freequeue[i].prev = svgame.freequeue[i].next = -1;
+
+	svgame.freequeue[GI->max_edicts].prev = svgame.freequeue[GI->max_edicts].next = GI->max_edicts;
+}
+
+/*
+==============
+SV_NextActiveEdict
+
+returns next used edict number after num
+or svgame.numEntities if there is no more
+==============
+*/
+int SV_NextActiveEdict( int num )
+{
+	uint32_t	bits;
+
+	for( num++; num < svgame.numEntities; num++ )
+	{
+		bits = svgame.activeedicts[num >> 5] >> ( num & 31 );
+
+		// skip whole unused words
+		if( !bits )
+		{
+			num |= 31;
+			continue;
+		}
+
+		while( !FBitSet( bits, 1 ))
+		{
+			bits >>= 1;
+			num++;
+		}
+
+		return Q_min( num, svgame.numEntities );
+	}
+
+	return svgame.numEntities;
+}
+
 /*
 ==============
 SV_InitEdict
@@ -995,8 +1070,16 @@ clear edict for reuse
 */
 void SV_InitEdict( edict_t *pEdict )
 {
+	int	num;
+
 	Assert( pEdict != NULL );
 
+	num = NUM_FOR_EDICT( pEdict );
+	SV_UnlinkFreeEdict( num );
+	SetBits( svgame.activeedicts[num >> 5], BIT( num & 31 ));
+	memset( &svgame.sleepstates[num], 0, sizeof( svgame.sleepstates[num] ));
+	svgame.tossmoves[num].valid = false;
+
 	SV_FreePrivateData( pEdict );
 	memset( &pEdict->v, 0, sizeof( entvars_t ));
 	pEdict->v.pContainingEntity = pEdict;
@@ -1016,6 +1099,8 @@ unlink edict from world and free it
 */
 void SV_FreeEdict( edict_t *pEdict )
 {
+	int	num;
+
 	Assert( pEdict != NULL );
 	if( pEdict->free ) return;
 
@@ -1042,6 +1127,23 @@ void SV_FreeEdict( edict_t *pEdict )
 	VectorClear( pEdict->v.angles );
 	VectorClear( pEdict->v.origin );
 	pEdict->free = true;
+
+	num = NUM_FOR_EDICT( pEdict );
+	ClearBits( svgame.activeedicts[num >> 5], BIT( num & 31 ));
+	svgame.edictstats.freed++;
+
+	// client slots are never reused by SV_AllocEdict
+	if( num > svs.maxclients )
+	{
+		sv_edictlink_t *head = &svgame.freequeue[GI->max_edicts];
+
+		// freetime is always increasing, so append to the tail
+		SV_UnlinkFreeEdict( num );
+		svgame.freequeue[num].next = GI->max_edicts;
+		svgame.freequeue[num].prev = head->prev;
+		svgame.freequeue[head->prev].next = num;
+		head->prev = num;
+	}
 }
 
 /*
@@ -1056,18 +1158,33 @@ edict_t *GAME_EXPORT SV_AllocEdict( void )
 	edict_t	*e;
 	int	i;
 
-	for( i = svs.maxclients + 1; i < svgame.numEntities; i++ )
+	svgame.edictstats.allocated++;
+
+	// queue is ordered by freetime, so only the oldest one needs to be checked
+	while(( i = svgame.freequeue[GI->max_edicts].next ) != GI->max_edicts )
 	{
+		// left from the moment when svgame.numEntities was decremented
+		if( i >= svgame.numEntities )
+		{
+			SV_UnlinkFreeEdict( i );
+			continue;
+		}
+
 		e = EDICT_NUM( i );
+
 		// the first couple seconds of server time can involve a lot of
 		// freeing and allocating, so relax the replacement policy
-		if( e->free && ( e->freetime < 2.0f || ( sv.time - e->freetime ) > 0.5f ))
+		if( e->freetime < 2.0f || ( sv.time - e->freetime ) > 0.5f )
 		{
+			svgame.edictstats.reused++;
 			SV_InitEdict( e );
 			return e;
 		}
+		break;
 	}
 
+	i = svgame.numEntities;
+
 	if( i >= GI->max_edicts )
 		Host_Error( "%s: no free edicts (max is %d)\n", __func__, GI->max_edicts );
 
@@ -1087,8 +1204,27 @@ get pointer for entity class
 */
 static LINK_ENTITY_FUNC SV_GetEntityClass( const char *pszClassName )
 {
+	uint		hash = COM_HashKey( pszClassName, ENTITY_CLASS_HASH_SIZE );
+	sv_entityclass_t	*cls;
+	size_t		len;
+
+	// symbol lookup is slow, remember the result even if there is no such export
+	for( cls = svgame.entityclasses[hash]; cls; cls = cls->next )
+	{
+		if( !Q_strcmp( cls->name, pszClassName ))
+			return (LINK_ENTITY_FUNC)cls->func;
+	}
+
+	len = Q_strlen( pszClassName ) + 1;
+	cls = Mem_Malloc( svgame.mempool, sizeof( *cls ) + len );
+	memcpy( cls->name, pszClassName, len );
+
 	// allocate edict private memory (passed by dlls)
-	return (LINK_ENTITY_FUNC)COM_GetProcAddress( svgame.hInstance, pszClassName );
+	cls->func = COM_GetProcAddress( svgame.hInstance, pszClassName );
+	cls->next = svgame.entityclasses[hash];
+	svgame.entityclasses[hash] = cls;
+
+	return (LINK_ENTITY_FUNC)cls->func;
 }
 
 /*
@@ -4878,15 +5014,117 @@ static void SV_FreeKeyValueStrings( KeyValueData *kvd, int numpairs )
 	}
 }
 
+/*
+====================
+SV_StoreEntityToken
+
+====================
+*/
+static void SV_StoreEntityToken( const char *token, char **tokens, char *text, int *numtokens, size_t *textsize )
+{
+	size_t	len = Q_strlen( token ) + 1;
+
+	// first pass only counts
+	if( tokens )
+	{
+		tokens[*numtokens] = text + *textsize;
+		memcpy( tokens[*numtokens], token, len );
+	}
+
+	(*numtokens)++;
+	*textsize += len;
+}
+
+/*
+====================
+SV_TokenizeEntities
+
+splits entity lump into tokens with the same
+buffer sizes SV_LoadFromFile and SV_ParseEdict used
+====================
+*/
+static void SV_TokenizeEntities( char *entities, char **tokens, char *text, int *numtokens, size_t *textsize )
+{
+	char	token[2048];
+	string	keyname;
+
+	*numtokens = 0;
+	*textsize = 0;
+
+	while(( entities = COM_ParseFile( entities, token, sizeof( token ))) != NULL )
+	{
+		SV_StoreEntityToken( token, tokens, text, numtokens, textsize );
+
+		// SV_LoadFromFile will throw an error
+		if( token[0] != '{' )
+			return;
+
+		while( 1 )
+		{
+			if(( entities = COM_ParseFile( entities, keyname, sizeof( keyname ))) == NULL )
+				return; // SV_ParseEdict will throw an error
+
+			SV_StoreEntityToken( keyname, tokens, text, numtokens, textsize );
+
+			if( keyname[0] == '}' )
+				break;
+
+			if(( entities = COM_ParseFile( entities, token, sizeof( token ))) == NULL )
+				return; // SV_ParseEdict will throw an error
+
+			SV_StoreEntityToken( token, tokens, text, numtokens, textsize );
+		}
+	}
+}
+
+/*
+====================
+SV_GetEntityLump
+
+returns tokenized entity lump, reuses tokens
+if the same map (or entity patch) is loaded again
+====================
+*/
+static const sv_entlump_t *SV_GetEntityLump( char *entities )
+{
+	sv_entlump_t	*lump = &svgame.entlump;
+	size_t		length = Q_strlen( entities );
+	size_t		textsize;
+	CRC32_t		crc;
+	int		numtokens;
+
+	CRC32_Init( &crc );
+	CRC32_ProcessBuffer( &crc, entities, length );
+	crc = CRC32_Final( crc );
+
+	if( lump->tokens && lump->crc == crc && lump->length == length )
+	{
+		Con_Reportf( "%s: reusing %i cached tokens\n", __func__, lump->numtokens );
+		return lump;
+	}
+
+	if( lump->tokens )
+		Mem_Free( lump->tokens );
+
+	SV_TokenizeEntities( entities, NULL, NULL, &numtokens, &textsize );
+
+	lump->tokens = Mem_Malloc( svgame.mempool, sizeof( *lump->tokens ) * numtokens + textsize );
+	SV_TokenizeEntities( entities, lump->tokens, (char *)( lump->tokens + numtokens ), &lump->numtokens, &textsize );
+	lump->crc = crc;
+	lump->length = length;
+
+	return lump;
+}
+
 /*
 ====================
 SV_ParseEdict
 
-Parses an edict out of the given string, returning the new position
+Parses an edict out of the tokenized entity lump, advancing the position
 ed should be a properly initialized empty edict.
 ====================
 */
-static qboolean SV_ParseEdict( char **pfile, edict_t *ent )
+static qboolean SV_ParseEdict( const sv_entlump_t *lump, int *pos, edict_t *ent )
 {
 	KeyValueData	pkvd[256]; // per one entity
 	qboolean		adjust_origin = false, customentity;
@@ -4901,15 +5139,17 @@ static qboolean SV_ParseEdict( char **pfile, edict_t *ent )
 		int len;
 
 		// parse key
-		if(( *pfile = COM_ParseFile( *pfile, keyname, sizeof( keyname ))) == NULL )
+		if( *pos >= lump->numtokens )
 			Host_Error( "%s: EOF without closing brace\n", __func__ );
+		Q_strncpy( keyname, lump->tokens[(*pos)++], sizeof( keyname ));
 
 		if( keyname[0] == '}' )
 			break; // end of desc
 
 		// parse value
-		if(( *pfile = COM_ParseFile( *pfile, value, sizeof( value ))) == NULL )
+		if( *pos >= lump->numtokens )
 			Host_Error( "%s: EOF without closing brace\n", __func__ );
+		Q_strncpy( value, lump->tokens[(*pos)++], sizeof( value ));
 
 		if( value[0] == '}' )
 			Host_Error( "%s: closing brace without data\n", __func__ );
@@ -5082,9 +5322,10 @@ parsing textual entity definitions out of an ent file.
 */
 static void SV_LoadFromFile( const char *mapname, char *entities )
 {
-	char	token[2048];
+	const sv_entlump_t	*lump;
+	const char	*token;
 	qboolean	create_world = true;
-	int	inhibited;
+	int	inhibited, pos;
 	edict_t	*ent;
 
 	Assert( entities != NULL );
@@ -5092,11 +5333,14 @@ static void SV_LoadFromFile( const char *mapname, char *entities )
 	// user dll can override spawn entities function (Xash3D extension)
 	if( !svgame.physFuncs.SV_LoadEntities || !svgame.physFuncs.SV_LoadEntities( mapname, entities ))
 	{
+		lump = SV_GetEntityLump( entities );
 		inhibited = 0;
 
 		// parse ents
-		while(( entities = COM_ParseFile( entities, token, sizeof( token ))) != NULL )
+		for( pos = 0; pos < lump->numtokens; )
 		{
+			token = lump->tokens[pos++];
+
 			if( token[0] != '{' )
 				Host_Error( "%s: found %s when expecting {\n", __func__, token );
 
@@ -5107,7 +5351,7 @@ static void SV_LoadFromFile( const char *mapname, char *entities )
 			}
 			else ent = SV_AllocEdict();
 
-			if( !SV_ParseEdict( &entities, ent ))
+			if( !SV_ParseEdict( lump, &pos, ent ))
 				continue;
 
 			if( svgame.dllFuncs.pfnSpawn( ent ) == -1 )
@@ -5343,6 +5587,17 @@ qboolean SV_LoadProgs( const char *name )
 	svgame.globals->maxEntities = GI->max_edicts;
 	svgame.globals->maxClients = svs.maxclients;
 	svgame.edicts = Mem_Calloc( svgame.mempool, sizeof( edict_t ) * GI->max_edicts );
+	svgame.freequeue = Mem_Malloc( svgame.mempool, sizeof( sv_edictlink_t ) * ( GI->max_edicts + 1 ));
+	svgame.activeedicts = Mem_Calloc( svgame.mempool, sizeof( uint32_t ) * (( GI->max_edicts + 31 ) >> 5 ));
+	svgame.sleepstates = Mem_Calloc( svgame.mempool, sizeof( sv_sleepstate_t ) * GI->max_edicts );
+	svgame.tossmoves = Mem_Calloc( svgame.mempool, sizeof( sv_tossmove_t ) * GI->max_edicts );
+	svgame.tracecache = Mem_Calloc( svgame.mempool, sizeof( *svgame.tracecache ));
+	svgame.tracecache->generation = 1;
+	svgame.pushcheck = Mem_Calloc( svgame.mempool, sizeof( edict_t * ) * GI->max_edicts );
+	svgame.riderlinks = Mem_Malloc( svgame.mempool, sizeof( sv_edictlink_t ) * GI->max_edicts * 2 );
+	svgame.numriderlinks = 0;
+	svgame.tosscheck = Mem_Calloc( svgame.mempool, sizeof( edict_t * ) * GI->max_edicts );
+	svgame.entityclasses = Mem_Calloc( svgame.mempool, sizeof( sv_entityclass_t * ) * ENTITY_CLASS_HASH_SIZE );
 	svs.static_entities = Z_Calloc( sizeof( entity_state_t ) * MAX_STATIC_ENTITIES );
 	svs.baselines = Z_Calloc( sizeof( entity_state_t ) * GI->max_edicts );
 	svgame.numEntities = svs.maxclients + 1; // clients + world
@@ -5350,6 +5605,9 @@ qboolean SV_LoadProgs( const char *name )
 	for( i = 0, e = svgame.edicts; i < GI->max_edicts; i++, e++ )
 		e->free = true; // mark all edicts as freed
 
+	SV_ClearFreeEdicts();
+	memset( &svgame.edictstats, 0, sizeof( svgame.edictstats ));
+
 	Cvar_FullSet( "host_gameloaded", "1", FCVAR_READ_ONLY );
 	SV_AllocStringPool();
 
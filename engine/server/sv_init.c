@@ -716,6 +716,7 @@ void SV_DeactivateServer( void )
 	svgame.globals->maxEntities = GI->max_edicts;
 	svgame.globals->maxClients = svs.maxclients;
 	svgame.numEntities = svs.maxclients + 1; // clients + world
+	SV_ClearFreeEdicts();
 	svgame.globals->startspot = 0;
 	svgame.globals->mapname = 0;
 }
@@ -826,6 +827,7 @@ static void SV_SetupClients( void )
 	// init network stuff
 	NET_Config(( svs.maxclients > 1 ), true );
 	svgame.numEntities = svs.maxclients + 1; // clients + world
+	SV_ClearFreeEdicts();
 	ClearBits( sv_maxclients.flags, FCVAR_CHANGED );
 }
 
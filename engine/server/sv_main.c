@@ -133,6 +133,9 @@ CVAR_DEFINE_AUTO( sv_novis, "0", 0, "force to ignore server visibility" );			//
 CVAR_DEFINE( sv_pausable, "pausable", "1", 0, "allow players to pause or not" );
 CVAR_DEFINE( sv_maxclients, "maxplayers", "1", FCVAR_LATCH, "server max capacity" );
 CVAR_DEFINE_AUTO( sv_check_errors, "0", FCVAR_ARCHIVE, "check edicts for errors" );
+CVAR_DEFINE_AUTO( sv_sleepents, "0", FCVAR_ARCHIVE, "skip physics for toss and step entities resting on static ground" );
+CVAR_DEFINE_AUTO( sv_tracecache, "0", FCVAR_ARCHIVE, "reuse results of identical traces until any entity is relinked, 2 - also verify results" );
+CVAR_DEFINE_AUTO( sv_parallel_toss, "0", FCVAR_ARCHIVE, "trace toss, bounce and fly entities against the world in parallel before physics, 2 - also verify results" );
 CVAR_DEFINE_AUTO( sv_validate_changelevel, "0", 0, "test change level for level-designer errors" );
 CVAR_DEFINE( sv_hostmap, "hostmap", "", 0, "keep name of last entered map" );
 
@@ -923,6 +926,9 @@ void SV_Init( void )
 	Cvar_RegisterVariable( &sv_stopspeed );
 	Cvar_RegisterVariable( &sv_maxclients );
 	Cvar_RegisterVariable( &sv_check_errors );
+	Cvar_RegisterVariable( &sv_sleepents );
+	Cvar_RegisterVariable( &sv_parallel_toss );
+	Cvar_RegisterVariable( &sv_tracecache );
 	Cvar_RegisterVariable( &public_server );
 	Cvar_RegisterVariable( &sv_failuretime );
 	Cvar_RegisterVariable( &sv_unlag );
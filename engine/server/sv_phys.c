@@ -42,6 +42,8 @@ solid_edge items only clip against bsp models.
 */
 #define MOVE_EPSILON	0.01f
 #define MAX_CLIP_PLANES	5
+#define PUSH_RIDER_EPSILON	2.0f	// how far riders can stand from pusher's absbox
+#define SLEEP_REST_FRAMES	10	// frames at rest before entity falls asleep
 
 static const vec3_t current_table[] =
 {
@@ -783,6 +785,213 @@ static qboolean SV_AllowPushRotate( edict_t *ent )
 	return false;
 }
 
+/*
+===============================================================================
+
+PARALLEL TOSS
+
+===============================================================================
+*/
+/*
+============
+SV_ClampVelocity
+
+same as SV_CheckVelocity but without console output,
+so it can be used from worker threads
+============
+*/
+static void SV_ClampVelocity( vec3_t velocity )
+{
+	float	wishspd;
+	float	maxspd;
+	int	i;
+
+	for( i = 0; i < 3; i++ )
+	{
+		if( IS_NAN( velocity[i] ))
+			velocity[i] = 0.0f;
+	}
+
+	wishspd = DotProduct( velocity, velocity );
+	maxspd = sv_maxvelocity.value * sv_maxvelocity.value * 1.73f; // half-diagonal
+
+	if( wishspd > maxspd )
+	{
+		wishspd = sqrt( wishspd );
+		wishspd = sv_maxvelocity.value / wishspd;
+		VectorScale( velocity, wishspd, velocity );
+	}
+}
+
+/*
+============
+SV_PredictTossMove
+
+repeats SV_Physics_Entity and SV_Physics_Toss math on a copy
+of velocity and traces the result against the world hull.
+Think function can change anything, so prediction is used only
+if SV_PushEntity is called with exactly the same move
+============
+*/
+static void SV_PredictTossMove( edict_t *ent, sv_tossmove_t *move )
+{
+	vec3_t	velocity, basevelocity, delta;
+	float	ent_gravity;
+	int	i;
+
+	move->valid = false;
+
+	if( !SV_IsValidEdict( ent ) || svgame.sleepstates[NUM_FOR_EDICT( ent )].asleep )
+		return;
+
+	switch( ent->v.movetype )
+	{
+	case MOVETYPE_FLY:
+	case MOVETYPE_TOSS:
+	case MOVETYPE_BOUNCE:
+	case MOVETYPE_FLYMISSILE:
+	case MOVETYPE_BOUNCEMISSILE:
+		break;
+	default:
+		return;
+	}
+
+	// resting, nothing to trace
+	if( FBitSet( ent->v.flags, FL_ONGROUND ) && VectorIsNull( ent->v.velocity ) && VectorIsNull( ent->v.basevelocity ))
+		return;
+
+	for( i = 0; i < 3; i++ )
+	{
+		if( IS_NAN( ent->v.origin[i] ))
+			return;
+	}
+
+	VectorCopy( ent->v.velocity, velocity );
+	VectorCopy( ent->v.basevelocity, basevelocity );
+
+	// SV_Physics_Entity
+	if( !FBitSet( ent->v.flags, FL_BASEVELOCITY ) && !VectorIsNull( basevelocity ))
+	{
+		VectorMA( velocity, 1.0f + (sv.frametime * 0.5f), basevelocity, velocity );
+		VectorClear( basevelocity );
+	}
+
+	// SV_Physics_Toss
+	SV_ClampVelocity( velocity );
+
+	switch( ent->v.movetype )
+	{
+	case MOVETYPE_FLY:
+	case MOVETYPE_FLYMISSILE:
+	case MOVETYPE_BOUNCEMISSILE:
+		break;
+	default:
+		ent_gravity = ent->v.gravity ? ent->v.gravity : 1.0f;
+		velocity[2] -= ( ent_gravity * sv_gravity.value * sv.frametime );
+		velocity[2] += ( basevelocity[2] * sv.frametime );
+		basevelocity[2] = 0.0f;
+		SV_ClampVelocity( velocity );
+		break;
+	}
+
+	VectorAdd( velocity, basevelocity, velocity );
+	SV_ClampVelocity( velocity );
+
+	// same operations order, so the end point matches bit by bit
+	VectorScale( velocity, sv.frametime, delta );
+	VectorCopy( ent->v.origin, move->start );
+	VectorAdd( move->start, delta, move->end );
+	VectorCopy( ent->v.mins, move->mins );
+	VectorCopy( ent->v.maxs, move->maxs );
+
+	SV_ClipMoveToEntity( EDICT_NUM( 0 ), move->start, move->mins, move->maxs, move->end, &move->worldtrace );
+
+	move->framecount = sv.framecount;
+	move->valid = true;
+}
+
+/*
+============
+SV_PredictTossMoves
+
+first phase of parallel toss, world hull is static so
+its traces can be done in any order from any thread
+============
+*/
+static void SV_PredictTossMoves( void )
+{
+	int	i, count = 0;
+
+	svgame.edictstats.predicted = svgame.edictstats.predictreused = svgame.edictstats.mismatched = 0;
+
+	// world hull selection can be overriden by game dll, which is not thread safe
+	if( !sv_parallel_toss.value || svgame.physFuncs.SV_HullForBsp != NULL )
+		return;
+
+#pragma omp parallel for schedule( dynamic, 32 ) reduction( + : count )
+	for( i = svs.maxclients + 1; i < svgame.numEntities; i++ )
+	{
+		sv_tossmove_t *move = &svgame.tossmoves[i];
+
+		SV_PredictTossMove( EDICT_NUM( i ), move );
+
+		if( move->valid )
+			count++;
+	}
+
+	svgame.edictstats.predicted = count;
+}
+
+/*
+============
+SV_PredictedMove
+
+second phase of parallel toss, called in usual edict order
+returns false if move wasn't predicted
+============
+*/
+static qboolean SV_PredictedMove( edict_t *ent, const vec3_t end, int type, qboolean monsterclip, trace_t *trace )
+{
+	sv_tossmove_t	*move;
+	trace_t		worldtrace;
+
+	if( !sv_parallel_toss.value )
+		return false;
+
+	move = &svgame.tossmoves[NUM_FOR_EDICT( ent )];
+
+	if( !move->valid || move->framecount != sv.framecount )
+		return false;
+
+	if( !VectorCompare( move->start, ent->v.origin ) || !VectorCompare( move->end, end ))
+		return false;
+
+	if( !VectorCompare( move->mins, ent->v.mins ) || !VectorCompare( move->maxs, ent->v.maxs ))
+		return false;
+
+	svgame.edictstats.predictreused++;
+
+	if( sv_parallel_toss.value >= 2.0f )
+	{
+		SV_ClipMoveToEntity( EDICT_NUM( 0 ), ent->v.origin, ent->v.mins, ent->v.maxs, end, &worldtrace );
+
+		if( worldtrace.fraction != move->worldtrace.fraction || !VectorCompare( worldtrace.endpos, move->worldtrace.endpos )
+			|| !VectorCompare( worldtrace.plane.normal, move->worldtrace.plane.normal ) || worldtrace.plane.dist != move->worldtrace.plane.dist
+			|| worldtrace.allsolid != move->worldtrace.allsolid || worldtrace.startsolid != move->worldtrace.startsolid
+			|| worldtrace.inopen != move->worldtrace.inopen || worldtrace.inwater != move->worldtrace.inwater
+			|| worldtrace.ent != move->worldtrace.ent || worldtrace.hitgroup != move->worldtrace.hitgroup )
+		{
+			Con_Printf( S_WARN "%s: world trace mismatch for %s (%i)\n", __func__, SV_ClassName( ent ), NUM_FOR_EDICT( ent ));
+			svgame.edictstats.mismatched++;
+			move->worldtrace = worldtrace;
+		}
+	}
+
+	*trace = SV_MoveFromWorldTrace( ent->v.origin, ent->v.mins, ent->v.maxs, end, type, ent, monsterclip, &move->worldtrace );
+
+	return true;
+}
+
 /*
 ============
 SV_PushEntity
@@ -807,7 +1016,9 @@ static trace_t SV_PushEntity( edict_t *ent, const vec3_t lpush, const vec3_t apu
 		type = MOVE_NOMONSTERS; // only clip against bmodels
 	else type = MOVE_NORMAL;
 
-	trace = SV_Move( ent->v.origin, ent->v.mins, ent->v.maxs, end, type, ent, monsterClip );
+	// world part may be already traced by SV_PredictTossMoves
+	if( !SV_PredictedMove( ent, end, type, monsterClip, &trace ))
+		trace = SV_Move( ent->v.origin, ent->v.mins, ent->v.maxs, end, type, ent, monsterClip );
 
 	if( trace.fraction != 0.0f )
 	{
@@ -890,6 +1101,155 @@ static qboolean SV_CanBlock( edict_t *ent )
 	return true;
 }
 
+/*
+============
+SV_PushCandidatesCompare
+
+keep edicts order, so push results doesn't depend on area tree
+============
+*/
+static int SV_PushCandidatesCompare( const void *a, const void *b )
+{
+	const edict_t *e1 = *(const edict_t **)a;
+	const edict_t *e2 = *(const edict_t **)b;
+
+	return ( e1 > e2 ) - ( e1 < e2 );
+}
+
+/*
+============
+SV_InitRiderLinks
+
+make rider links valid for edicts below num
+============
+*/
+static void SV_InitRiderLinks( int num )
+{
+	int	i, head;
+
+	for( i = svgame.numriderlinks; i < num; i++ )
+	{
+		head = GI->max_edicts + i;
+		svgame.riderlinks[head].prev = svgame.riderlinks[head].next = head;
+		svgame.riderlinks[i].prev = svgame.riderlinks[i].next = -1;
+	}
+
+	if( svgame.numriderlinks < num )
+		svgame.numriderlinks = num;
+}
+
+/*
+============
+SV_FileRider
+
+move entity into riders list of it's groundentity
+============
+*/
+static void SV_FileRider( edict_t *ent )
+{
+	int		num = NUM_FOR_EDICT( ent );
+	sv_edictlink_t	*link;
+	int		ground, head;
+
+	SV_InitRiderLinks( num + 1 );
+	link = &svgame.riderlinks[num];
+
+	if( link->prev != -1 )
+	{
+		svgame.riderlinks[link->prev].next = link->next;
+		svgame.riderlinks[link->next].prev = link->prev;
+		link->prev = link->next = -1;
+	}
+
+	if( ent->free || !FBitSet( ent->v.flags, FL_ONGROUND ) || !ent->v.groundentity )
+		return;
+
+	ground = NUM_FOR_EDICT( ent->v.groundentity );
+	if( ground < 0 || ground >= GI->max_edicts )
+		return;
+
+	SV_InitRiderLinks( ground + 1 );
+	head = GI->max_edicts + ground;
+
+	link->next = head;
+	link->prev = svgame.riderlinks[head].prev;
+	svgame.riderlinks[link->prev].next = num;
+	svgame.riderlinks[head].prev = num;
+}
+
+/*
+============
+SV_BuildRiderLinks
+
+file every entity by it's groundentity, called once per frame.
+Entities are refiled after their own physics, so the lists
+may only contain stale riders that pushers must filter out
+============
+*/
+static void SV_BuildRiderLinks( void )
+{
+	int	i;
+
+	svgame.numriderlinks = 0;
+	SV_InitRiderLinks( svgame.numEntities );
+
+	for( i = SV_NextActiveEdict( 0 ); i < svgame.numEntities; i = SV_NextActiveEdict( i ))
+		SV_FileRider( EDICT_NUM( i ));
+}
+
+/*
+============
+SV_PushCandidates
+
+collect entities that pusher may affect: everything linked
+around the area swept by pusher plus anything standing on it.
+Pusher must be already linked at it's final position
+============
+*/
+static int SV_PushCandidates( edict_t *pusher, const vec3_t oldmins, const vec3_t oldmaxs )
+{
+	vec3_t	mins, maxs;
+	int	i, count, numlinked, head;
+	edict_t	*check;
+
+	for( i = 0; i < 3; i++ )
+	{
+		// riders are linked right above the pusher, so expand bounds a bit
+		mins[i] = Q_min( oldmins[i], pusher->v.absmin[i] ) - PUSH_RIDER_EPSILON;
+		maxs[i] = Q_max( oldmaxs[i], pusher->v.absmax[i] ) + PUSH_RIDER_EPSILON;
+	}
+
+	count = numlinked = SV_AreaEdicts( mins, maxs, svgame.pushcheck, GI->max_edicts );
+
+	if( numlinked > 1 )
+		qsort( svgame.pushcheck, numlinked, sizeof( *svgame.pushcheck ), SV_PushCandidatesCompare );
+
+	// riders are moved whatever their bounds are, unlinked or stale ones
+	// may be missing in the area tree, so take them from the rider links
+	if( NUM_FOR_EDICT( pusher ) < svgame.numriderlinks )
+	{
+		head = GI->max_edicts + NUM_FOR_EDICT( pusher );
+
+		for( i = svgame.riderlinks[head].next; i != head; i = svgame.riderlinks[i].next )
+		{
+			check = EDICT_NUM( i );
+
+			if( !FBitSet( check->v.flags, FL_ONGROUND ) || check->v.groundentity != pusher )
+				continue; // left the pusher since it was filed
+
+			if( bsearch( &check, svgame.pushcheck, numlinked, sizeof( *svgame.pushcheck ), SV_PushCandidatesCompare ))
+				continue; // already found in the area tree
+
+			svgame.pushcheck[count++] = check;
+		}
+	}
+
+	if( count > numlinked )
+		qsort( svgame.pushcheck, count, sizeof( *svgame.pushcheck ), SV_PushCandidatesCompare );
+
+	return count;
+}
+
 /*
 ============
 SV_PushMove
@@ -899,9 +1259,11 @@ SV_PushMove
 static edict_t *SV_PushMove( edict_t *pusher, float movetime )
 {
 	int		i, e, block;
-	int		num_moved, oldsolid;
+	int		num_moved, numcheck, oldsolid;
 	vec3_t		mins, maxs, lmove;
+	vec3_t		oldmins, oldmaxs;
 	sv_pushed_t	*p, *pushed_p;
+	qboolean		rider;
 	edict_t		*check;
 
 	if( svgame.globals->changelevel || VectorIsNull( pusher->v.velocity ))
@@ -917,6 +1279,9 @@ static edict_t *SV_PushMove( edict_t *pusher, float movetime )
 		maxs[i] = pusher->v.absmax[i] + lmove[i];
 	}
 
+	VectorCopy( pusher->v.absmin, oldmins );
+	VectorCopy( pusher->v.absmax, oldmaxs );
+
 	pushed_p = svgame.pushed;
 
 	// save the pusher's original position
@@ -937,23 +1302,21 @@ static edict_t *SV_PushMove( edict_t *pusher, float movetime )
 
 	// see if any solid entities are inside the final position
 	num_moved = 0;
+	numcheck = SV_PushCandidates( pusher, oldmins, oldmaxs );
 
-	for( e = 1; e < svgame.numEntities; e++ )
+	for( e = 0; e < numcheck; e++ )
 	{
-		check = EDICT_NUM( e );
+		check = svgame.pushcheck[e];
 		if( !SV_IsValidEdict( check )) continue;
 
 		// filter movetypes to collide with
 		if( !SV_CanPushed( check ))
 			continue;
 
-		pusher->v.solid = SOLID_NOT;
-		block = SV_TestEntityPosition( check, pusher );
-		pusher->v.solid = oldsolid;
-		if( block ) continue;
-
 		// if the entity is standing on the pusher, it will definately be moved
-		if( !( FBitSet( check->v.flags, FL_ONGROUND ) && check->v.groundentity == pusher ))
+		rider = FBitSet( check->v.flags, FL_ONGROUND ) && check->v.groundentity == pusher;
+
+		if( !rider )
 		{
 			if( check->v.absmin[0] >= maxs[0]
 			 || check->v.absmin[1] >= maxs[1]
@@ -962,12 +1325,17 @@ static edict_t *SV_PushMove( edict_t *pusher, float movetime )
 			 || check->v.absmax[1] <= mins[1]
 			 || check->v.absmax[2] <= mins[2] )
 				continue;
-
-			// see if the ent's bbox is inside the pusher's final position
-			if( !SV_TestEntityPosition( check, NULL ))
-				continue;
 		}
 
+		pusher->v.solid = SOLID_NOT;
+		block = SV_TestEntityPosition( check, pusher );
+		pusher->v.solid = oldsolid;
+		if( block ) continue;
+
+		// see if the ent's bbox is inside the pusher's final position
+		if( !rider && !SV_TestEntityPosition( check, NULL ))
+			continue;
+
 		// remove the onground flag for non-players
 		if( check->v.movetype != MOVETYPE_WALK )
 			check->v.flags &= ~FL_ONGROUND;
@@ -1016,10 +1384,13 @@ SV_PushRotate
 static edict_t *SV_PushRotate( edict_t *pusher, float movetime )
 {
 	int		i, e, block, oldsolid;
+	int		numcheck;
 	matrix4x4		start_l, end_l;
 	vec3_t		lmove, amove;
+	vec3_t		oldmins, oldmaxs;
 	sv_pushed_t	*p, *pushed_p;
 	vec3_t		org, org2, temp;
+	qboolean		rider;
 	edict_t		*check;
 
 	if( svgame.globals->changelevel || VectorIsNull( pusher->v.avelocity ))
@@ -1033,6 +1404,8 @@ static edict_t *SV_PushRotate( edict_t *pusher, float movetime )
 
 	// create pusher initial position
 	Matrix4x4_CreateFromEntity( start_l, pusher->v.angles, pusher->v.origin, 1.0f );
+	VectorCopy( pusher->v.absmin, oldmins );
+	VectorCopy( pusher->v.absmax, oldmaxs );
 
 	pushed_p = svgame.pushed;
 
@@ -1056,9 +1429,11 @@ static edict_t *SV_PushRotate( edict_t *pusher, float movetime )
 	Matrix4x4_CreateFromEntity( end_l, pusher->v.angles, pusher->v.origin, 1.0f );
 
 	// see if any solid entities are inside the final position
-	for( e = 1; e < svgame.numEntities; e++ )
+	numcheck = SV_PushCandidates( pusher, oldmins, oldmaxs );
+
+	for( e = 0; e < numcheck; e++ )
 	{
-		check = EDICT_NUM( e );
+		check = svgame.pushcheck[e];
 		if( !SV_IsValidEdict( check ))
 			continue;
 
@@ -1066,13 +1441,10 @@ static edict_t *SV_PushRotate( edict_t *pusher, float movetime )
 		if( !SV_CanPushed( check ))
 			continue;
 
-		pusher->v.solid = SOLID_NOT;
-		block = SV_TestEntityPosition( check, pusher );
-		pusher->v.solid = oldsolid;
-		if( block ) continue;
-
 		// if the entity is standing on the pusher, it will definately be moved
-		if( !(( check->v.flags & FL_ONGROUND ) && check->v.groundentity == pusher ))
+		rider = ( check->v.flags & FL_ONGROUND ) && check->v.groundentity == pusher;
+
+		if( !rider )
 		{
 			if( check->v.absmin[0] >= pusher->v.absmax[0]
 			|| check->v.absmin[1] >= pusher->v.absmax[1]
@@ -1081,12 +1453,17 @@ static edict_t *SV_PushRotate( edict_t *pusher, float movetime )
 			|| check->v.absmax[1] <= pusher->v.absmin[1]
 			|| check->v.absmax[2] <= pusher->v.absmin[2] )
 				continue;
-
-			// see if the ent's bbox is inside the pusher's final position
-			if( !SV_TestEntityPosition( check, NULL ))
-				continue;
 		}
 
+		pusher->v.solid = SOLID_NOT;
+		block = SV_TestEntityPosition( check, pusher );
+		pusher->v.solid = oldsolid;
+		if( block ) continue;
+
+		// see if the ent's bbox is inside the pusher's final position
+		if( !rider && !SV_TestEntityPosition( check, NULL ))
+			continue;
+
 		// save original position of contacted entity
 		pushed_p->ent = check;
 		VectorCopy( check->v.origin, pushed_p->origin );
@@ -1720,14 +2097,134 @@ static void SV_Physics_None( edict_t *ent )
 	SV_RunThink( ent );
 }
 
-//============================================================================
-static void SV_Physics_Entity( edict_t *ent )
+/*
+=============
+SV_IsStaticGround
+
+ground that never moves by itself
+=============
+*/
+static qboolean SV_IsStaticGround( edict_t *ground )
 {
-	// user dll can override movement type (Xash3D extension)
-	if( svgame.physFuncs.SV_PhysicsEntity && svgame.physFuncs.SV_PhysicsEntity( ent ))
-		return; // overrided
+	if( ground == svgame.edicts )
+		return true;
 
-	SV_UpdateBaseVelocity( ent );
+	if( !SV_IsValidEdict( ground ) || ground->v.movetype != MOVETYPE_NONE )
+		return false;
+
+	if( FBitSet( ground->v.flags, FL_CONVEYOR|FL_MONSTER|FL_CLIENT ))
+		return false;
+
+	return true;
+}
+
+/*
+=============
+SV_CheckSleep
+
+puts toss and step entities to sleep after they was resting
+on static ground out of water for a while. Sleeping entities skip physics
+=============
+*/
+static void SV_CheckSleep( edict_t *ent )
+{
+	sv_sleepstate_t	*ss = &svgame.sleepstates[NUM_FOR_EDICT( ent )];
+
+	switch( ent->v.movetype )
+	{
+	case MOVETYPE_TOSS:
+	case MOVETYPE_BOUNCE:
+	case MOVETYPE_STEP:
+		break;
+	default:
+		ss->restframes = 0;
+		return;
+	}
+
+	if( !sv_sleepents.value || svgame.globals->force_retouch != 0.0f
+	 || FBitSet( ent->v.flags, FL_KILLME|FL_CLIENT|FL_FAKECLIENT ) || !FBitSet( ent->v.flags, FL_ONGROUND )
+	 || !VectorIsNull( ent->v.velocity ) || !VectorIsNull( ent->v.avelocity ) || !VectorIsNull( ent->v.basevelocity )
+	 || !SV_IsStaticGround( ent->v.groundentity ) || ent->v.waterlevel != 0 )
+	{
+		ss->restframes = 0;
+		return;
+	}
+
+	if( ++ss->restframes < SLEEP_REST_FRAMES )
+		return;
+
+	ss->asleep = true;
+	ss->movetype = ent->v.movetype;
+	ss->flags = ent->v.flags;
+	ss->ground = ent->v.groundentity;
+	VectorCopy( ent->v.origin, ss->origin );
+	VectorCopy( ent->v.angles, ss->angles );
+	VectorCopy( ss->ground->v.origin, ss->groundorigin );
+}
+
+/*
+=============
+SV_StillAsleep
+
+check if anything was changed since entity fell asleep:
+velocity or origin writes, think scheduling, ground changes
+=============
+*/
+static qboolean SV_StillAsleep( edict_t *ent )
+{
+	sv_sleepstate_t	*ss = &svgame.sleepstates[NUM_FOR_EDICT( ent )];
+	float		thinktime = ent->v.nextthink;
+
+	if( !ss->asleep )
+		return false;
+
+	if( !sv_sleepents.value || svgame.globals->force_retouch != 0.0f )
+		goto wakeup;
+
+	// don't miss the think
+	if( thinktime > 0.0f && thinktime <= ( sv.time + sv.frametime ))
+		goto wakeup;
+
+	if( ent->v.movetype != ss->movetype || ent->v.flags != ss->flags || ent->v.groundentity != ss->ground )
+		goto wakeup;
+
+	// air, drowning and lava damage are updated only while entity runs physics
+	if( ent->v.waterlevel != 0 )
+		goto wakeup;
+
+	if( !VectorIsNull( ent->v.velocity ) || !VectorIsNull( ent->v.avelocity ) || !VectorIsNull( ent->v.basevelocity ))
+		goto wakeup;
+
+	if( !VectorCompare( ent->v.origin, ss->origin ) || !VectorCompare( ent->v.angles, ss->angles ))
+		goto wakeup;
+
+	if( !SV_IsStaticGround( ss->ground ) || !VectorCompare( ss->ground->v.origin, ss->groundorigin ))
+		goto wakeup;
+
+	return true;
+
+wakeup:
+	ss->asleep = false;
+	ss->restframes = 0;
+	return false;
+}
+
+//============================================================================
+static void SV_Physics_Entity( edict_t *ent )
+{
+	// user dll can override movement type (Xash3D extension)
+	if( svgame.physFuncs.SV_PhysicsEntity && svgame.physFuncs.SV_PhysicsEntity( ent ))
+		return; // overrided
+
+	if( SV_StillAsleep( ent ))
+	{
+		svgame.edictstats.sleeping++;
+		return;
+	}
+
+	svgame.edictstats.awake++;
+
+	SV_UpdateBaseVelocity( ent );
 
 	if( !FBitSet( ent->v.flags, FL_BASEVELOCITY ) && !VectorIsNull( ent->v.basevelocity ))
 	{
@@ -1781,6 +2278,9 @@ static void SV_Physics_Entity( edict_t *ent )
 	// this produce a corrupted baselines
 	if( sv.state == ss_active && FBitSet( ent->v.flags, FL_KILLME ))
 		SV_FreeEdict( ent );
+
+	if( !ent->free )
+		SV_CheckSleep( ent );
 }
 
 static void SV_RunLightStyles( void )
@@ -1823,8 +2323,19 @@ void SV_Physics( void )
 	// let the progs know that a new frame has started
 	svgame.dllFuncs.pfnStartFrame();
 
-	// treat each object in turn
-	for( i = 0; i < svgame.numEntities; i++ )
+	svgame.edictstats.sleeping = svgame.edictstats.awake = 0;
+
+	// animations and time have changed
+	SV_InvalidateTraceCache();
+
+	// entities stay the same, only world traces are done ahead
+	SV_PredictTossMoves();
+
+	// pushers take their riders from here
+	SV_BuildRiderLinks();
+
+	// treat each object in turn, skip the unused slots
+	for( i = 0; i < svgame.numEntities; i = SV_NextActiveEdict( i ))
 	{
 		ent = EDICT_NUM( i );
 
@@ -1835,6 +2346,7 @@ void SV_Physics( void )
 			continue;
 
 		SV_Physics_Entity( ent );
+		SV_FileRider( ent );
 	}
 
 	if( svgame.globals->force_retouch != 0.0f )
@@ -2164,3 +2676,368 @@ qboolean SV_InitPhysicsAPI( void )
 	Host_ValidateEngineFeatures( ENGINE_FEATURES_MASK, 0 );
 	return true;
 }
+
+#if XASH_ENGINE_TESTS
+#include "tests.h"
+
+#define TEST_PUSH_EDICTS	512
+#define TEST_PUSH_PUSHERS	64
+
+typedef struct
+{
+	svgame_static_t	svgame;
+	gameinfo_t	*gameinfo;
+	model_t		*worldmodel;
+} test_pushsaved_t;
+
+static gameinfo_t	test_pushgameinfo;
+static model_t	test_pushworld;
+static globalvars_t	test_pushglobals;
+
+static void Test_PushSetAbsBox( edict_t *ent )
+{
+	VectorAdd( ent->v.origin, ent->v.mins, ent->v.absmin );
+	VectorAdd( ent->v.origin, ent->v.maxs, ent->v.absmax );
+}
+
+static void Test_PushTouch( edict_t *pentTouched, edict_t *pentOther )
+{
+}
+
+static float Test_PushRandom( uint *seed, float min, float max )
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return min + ( max - min ) * (( *seed >> 8 ) / (float)( 1 << 24 ));
+}
+
+/*
+============
+Test_PushSetup
+
+fill synthetic world: pushers first, then random bodies,
+some of them are riders, unlinked or freed
+============
+*/
+static void Test_PushSetup( test_pushsaved_t *saved, uint seed )
+{
+	int	i;
+
+	saved->svgame = svgame;
+	saved->gameinfo = GI;
+	saved->worldmodel = sv.worldmodel;
+
+	memset( &test_pushgameinfo, 0, sizeof( test_pushgameinfo ));
+	test_pushgameinfo.max_edicts = TEST_PUSH_EDICTS;
+	GI = &test_pushgameinfo;
+
+	memset( &test_pushworld, 0, sizeof( test_pushworld ));
+	VectorSet( test_pushworld.mins, -4096.0f, -4096.0f, -4096.0f );
+	VectorSet( test_pushworld.maxs, 4096.0f, 4096.0f, 4096.0f );
+	sv.worldmodel = &test_pushworld;
+
+	memset( &test_pushglobals, 0, sizeof( test_pushglobals ));
+	memset( &svgame.dllFuncs, 0, sizeof( svgame.dllFuncs ));
+	memset( &svgame.dllFuncs2, 0, sizeof( svgame.dllFuncs2 ));
+	memset( &svgame.physFuncs, 0, sizeof( svgame.physFuncs ));
+	svgame.globals = &test_pushglobals;
+	svgame.dllFuncs.pfnSetAbsBox = Test_PushSetAbsBox;
+	svgame.dllFuncs.pfnTouch = Test_PushTouch;
+
+	svgame.edicts = Z_Calloc( sizeof( edict_t ) * TEST_PUSH_EDICTS );
+	svgame.activeedicts = Z_Calloc( sizeof( uint32_t ) * (( TEST_PUSH_EDICTS + 31 ) >> 5 ));
+	svgame.pushcheck = Z_Calloc( sizeof( edict_t * ) * TEST_PUSH_EDICTS );
+	svgame.riderlinks = Z_Calloc( sizeof( sv_edictlink_t ) * TEST_PUSH_EDICTS * 2 );
+	svgame.numriderlinks = 0;
+	svgame.numEntities = TEST_PUSH_EDICTS;
+	svgame.tracecache = NULL;
+	SV_ClearWorld();
+
+	// world has no hulls here and clips as a box at it's origin, keep it away
+	VectorSet( EDICT_NUM( 0 )->v.origin, 0.0f, 0.0f, -8192.0f );
+
+	for( i = 1; i < TEST_PUSH_EDICTS; i++ )
+	{
+		edict_t	*ent = EDICT_NUM( i );
+		float	size = Test_PushRandom( &seed, 4.0f, 64.0f );
+
+		if( i % 7 == 0 )
+		{
+			ent->free = true;
+			continue;
+		}
+
+		SetBits( svgame.activeedicts[i >> 5], BIT( i & 31 ));
+
+		VectorSet( ent->v.origin, Test_PushRandom( &seed, -1024.0f, 1024.0f ), Test_PushRandom( &seed, -1024.0f, 1024.0f ), Test_PushRandom( &seed, -256.0f, 256.0f ));
+		VectorSet( ent->v.mins, -size, -size, -size );
+		VectorSet( ent->v.maxs, size, size, size );
+		VectorSubtract( ent->v.maxs, ent->v.mins, ent->v.size );
+		VectorSet( ent->v.velocity, Test_PushRandom( &seed, -640.0f, 640.0f ), Test_PushRandom( &seed, -640.0f, 640.0f ), Test_PushRandom( &seed, -640.0f, 640.0f ));
+		ent->v.solid = ( i % 3 ) ? SOLID_BBOX : SOLID_NOT;
+		ent->v.movetype = ( i < TEST_PUSH_PUSHERS ) ? MOVETYPE_PUSH : MOVETYPE_STEP;
+
+		if( i % 5 == 0 )
+			Test_PushSetAbsBox( ent ); // never linked
+		else SV_LinkEdict( ent, false );
+
+		// some riders are far away from their pusher
+		if( i >= TEST_PUSH_PUSHERS && i % 4 == 0 )
+		{
+			SetBits( ent->v.flags, FL_ONGROUND );
+			ent->v.groundentity = EDICT_NUM( 1 + (int)Test_PushRandom( &seed, 0.0f, TEST_PUSH_PUSHERS - 2 ));
+		}
+	}
+}
+
+static void Test_PushShutdown( test_pushsaved_t *saved )
+{
+	Z_Free( svgame.edicts );
+	Z_Free( svgame.activeedicts );
+	Z_Free( svgame.pushcheck );
+	Z_Free( svgame.riderlinks );
+
+	svgame = saved->svgame;
+	sv.worldmodel = saved->worldmodel;
+	GI = saved->gameinfo;
+}
+
+/*
+============
+Test_PushMoveScan
+
+SV_PushMove before SV_PushCandidates: every edict is checked
+============
+*/
+static edict_t *Test_PushMoveScan( edict_t *pusher, float movetime )
+{
+	int		i, e, block, oldsolid;
+	vec3_t		mins, maxs, lmove;
+	sv_pushed_t	*p, *pushed_p;
+	edict_t		*check;
+
+	if( svgame.globals->changelevel || VectorIsNull( pusher->v.velocity ))
+	{
+		pusher->v.ltime += movetime;
+		return NULL;
+	}
+
+	for( i = 0; i < 3; i++ )
+	{
+		lmove[i] = pusher->v.velocity[i] * movetime;
+		mins[i] = pusher->v.absmin[i] + lmove[i];
+		maxs[i] = pusher->v.absmax[i] + lmove[i];
+	}
+
+	pushed_p = svgame.pushed;
+
+	// save the pusher's original position
+	pushed_p->ent = pusher;
+	VectorCopy( pusher->v.origin, pushed_p->origin );
+	VectorCopy( pusher->v.angles, pushed_p->angles );
+	pushed_p++;
+
+	// move the pusher to it's final position
+	SV_LinearMove( pusher, movetime, 0.0f );
+	SV_LinkEdict( pusher, false );
+	pusher->v.ltime += movetime;
+	oldsolid = pusher->v.solid;
+
+	// non-solid pushers can't push anything
+	if( pusher->v.solid == SOLID_NOT )
+		return NULL;
+
+	for( e = 1; e < svgame.numEntities; e++ )
+	{
+		check = EDICT_NUM( e );
+		if( !SV_IsValidEdict( check )) continue;
+
+		// filter movetypes to collide with
+		if( !SV_CanPushed( check ))
+			continue;
+
+		pusher->v.solid = SOLID_NOT;
+		block = SV_TestEntityPosition( check, pusher );
+		pusher->v.solid = oldsolid;
+		if( block ) continue;
+
+		// if the entity is standing on the pusher, it will definately be moved
+		if( !( FBitSet( check->v.flags, FL_ONGROUND ) && check->v.groundentity == pusher ))
+		{
+			// unlinked bodies are no longer pushed, unless they ride on pusher
+			if( !check->area.prev )
+				continue;
+
+			if( check->v.absmin[0] >= maxs[0]
+			 || check->v.absmin[1] >= maxs[1]
+			 || check->v.absmin[2] >= maxs[2]
+			 || check->v.absmax[0] <= mins[0]
+			 || check->v.absmax[1] <= mins[1]
+			 || check->v.absmax[2] <= mins[2] )
+				continue;
+
+			// see if the ent's bbox is inside the pusher's final position
+			if( !SV_TestEntityPosition( check, NULL ))
+				continue;
+		}
+
+		// remove the onground flag for non-players
+		if( check->v.movetype != MOVETYPE_WALK )
+			check->v.flags &= ~FL_ONGROUND;
+
+		// save original position of contacted entity
+		pushed_p->ent = check;
+		VectorCopy( check->v.origin, pushed_p->origin );
+		VectorCopy( check->v.angles, pushed_p->angles );
+		pushed_p++;
+
+		// try moving the contacted entity
+		pusher->v.solid = SOLID_NOT;
+		SV_PushEntity( check, lmove, vec3_origin, &block, pusher->v.dmg );
+		pusher->v.solid = oldsolid;
+
+		// if it is still inside the pusher, block
+		if( SV_TestEntityPosition( check, NULL ) && block )
+		{
+			if( !SV_CanBlock( check ))
+				continue;
+
+			pusher->v.ltime -= movetime;
+
+			// move back any entities we already moved
+			// go backwards, so if the same entity was pushed
+			// twice, it goes back to the original position
+			for( p = pushed_p - 1; p >= svgame.pushed; p-- )
+			{
+				VectorCopy( p->origin, p->ent->v.origin );
+				VectorCopy( p->angles, p->ent->v.angles );
+				SV_LinkEdict( p->ent, (p->ent == check) ? true : false );
+			}
+			return check;
+		}
+	}
+
+	return NULL;
+}
+
+static void Test_PushCandidates( void )
+{
+	test_pushsaved_t	saved;
+	int		i, j, count, outside = 0, mismatches = 0;
+	uint		seed = 0x5eed;
+
+	Test_PushSetup( &saved, 0x5eed );
+	SV_BuildRiderLinks();
+
+	for( i = 1; i < TEST_PUSH_PUSHERS; i++ )
+	{
+		edict_t	*pusher = EDICT_NUM( i );
+		vec3_t	oldmins, oldmaxs, lmove;
+
+		if( pusher->free || !pusher->area.prev )
+			continue;
+
+		VectorCopy( pusher->v.absmin, oldmins );
+		VectorCopy( pusher->v.absmax, oldmaxs );
+		VectorSet( lmove, Test_PushRandom( &seed, -64.0f, 64.0f ), Test_PushRandom( &seed, -64.0f, 64.0f ), Test_PushRandom( &seed, -64.0f, 64.0f ));
+		VectorAdd( pusher->v.origin, lmove, pusher->v.origin );
+		SV_LinkEdict( pusher, false );
+
+		count = SV_PushCandidates( pusher, oldmins, oldmaxs );
+
+		// edict order, no duplicates
+		for( j = 1; j < count; j++ )
+		{
+			if( svgame.pushcheck[j - 1] >= svgame.pushcheck[j] )
+				mismatches++;
+		}
+
+		// every rider and every linked body touching the final position
+		for( j = 1; j < TEST_PUSH_EDICTS; j++ )
+		{
+			edict_t	*check = EDICT_NUM( j );
+			qboolean	rider = FBitSet( check->v.flags, FL_ONGROUND ) && check->v.groundentity == pusher;
+
+			if( check->free )
+				continue;
+
+			if( !rider && ( !check->area.prev || !BoundsIntersect( check->v.absmin, check->v.absmax, pusher->v.absmin, pusher->v.absmax )))
+				continue;
+
+			if( !bsearch( &check, svgame.pushcheck, count, sizeof( *svgame.pushcheck ), SV_PushCandidatesCompare ))
+				mismatches++;
+
+			if( !BoundsIntersect( check->v.absmin, check->v.absmax, pusher->v.absmin, pusher->v.absmax ))
+				outside++;
+		}
+	}
+
+	TASSERT_EQi( mismatches, 0 );
+	TASSERT( outside > 0 ); // riders away from pusher were checked
+
+	Test_PushShutdown( &saved );
+}
+
+static void Test_PushResults( void )
+{
+	test_pushsaved_t	saved;
+	vec3_t		*origins = Z_Malloc( sizeof( vec3_t ) * TEST_PUSH_EDICTS );
+	vec3_t		*initial = Z_Malloc( sizeof( vec3_t ) * TEST_PUSH_EDICTS );
+	int		i, frame, blocked[2] = { 0 }, moved = 0, mismatches = 0;
+
+	// same world twice, pushed by the old full scan and by SV_PushMove
+	Test_PushSetup( &saved, 0xb10c );
+
+	for( i = 0; i < TEST_PUSH_EDICTS; i++ )
+		VectorCopy( EDICT_NUM( i )->v.origin, initial[i] );
+
+	for( frame = 0; frame < 4; frame++ )
+	{
+		for( i = 1; i < TEST_PUSH_PUSHERS; i++ )
+		{
+			if( !EDICT_NUM( i )->free && Test_PushMoveScan( EDICT_NUM( i ), 0.1f ))
+				blocked[0]++;
+		}
+	}
+
+	for( i = 0; i < TEST_PUSH_EDICTS; i++ )
+		VectorCopy( EDICT_NUM( i )->v.origin, origins[i] );
+
+	Test_PushShutdown( &saved );
+	Test_PushSetup( &saved, 0xb10c );
+
+	for( frame = 0; frame < 4; frame++ )
+	{
+		SV_BuildRiderLinks();
+
+		for( i = 1; i < TEST_PUSH_PUSHERS; i++ )
+		{
+			if( !EDICT_NUM( i )->free && SV_PushMove( EDICT_NUM( i ), 0.1f ))
+				blocked[1]++;
+			SV_FileRider( EDICT_NUM( i ));
+		}
+	}
+
+	for( i = TEST_PUSH_PUSHERS; i < TEST_PUSH_EDICTS; i++ )
+	{
+		if( !VectorCompare( origins[i], EDICT_NUM( i )->v.origin ))
+			mismatches++;
+
+		if( !VectorCompare( initial[i], EDICT_NUM( i )->v.origin ))
+			moved++;
+	}
+
+	TASSERT_EQi( mismatches, 0 );
+	TASSERT_EQi( blocked[0], blocked[1] );
+	TASSERT( moved > 0 ); // something was really pushed
+
+	Test_PushShutdown( &saved );
+	Z_Free( origins );
+	Z_Free( initial );
+}
+
+void Test_RunPushCandidates( void )
+{
+	TRUN( Test_PushCandidates( ));
+	TRUN( Test_PushResults( ));
+}
+#endif /* XASH_ENGINE_TESTS */
@@ -410,6 +410,7 @@ ENTITY AREA CHECKING
 */
 static int	iTouchLinkSemaphore = 0;	// prevent recursion when SV_TouchLinks is active
 areanode_t	sv_areanodes[AREA_NODES];
+static link_t	sv_nonsolid_edicts[AREA_NODES];	// SOLID_NOT bodies, kept out of areanode_t to keep physics API intact
 static int	sv_numareanodes;
 
 /*
@@ -426,6 +427,7 @@ static areanode_t *SV_CreateAreaNode( int depth, vec3_t mins, vec3_t maxs )
 	vec3_t		mins1, maxs1;
 	vec3_t		mins2, maxs2;
 
+	ClearLink( &sv_nonsolid_edicts[sv_numareanodes] );
 	anode = &sv_areanodes[sv_numareanodes++];
 
 	ClearLink( &anode->trigger_edicts );
@@ -493,6 +495,8 @@ void SV_UnlinkEdict( edict_t *ent )
 	// not linked in anywhere
 	if( !ent->area.prev ) return;
 
+	SV_InvalidateTraceCache();
+
 	RemoveLink( &ent->area );
 	ent->area.prev = NULL;
 	ent->area.next = NULL;
@@ -646,6 +650,8 @@ void GAME_EXPORT SV_LinkEdict( edict_t *ent, qboolean touch_triggers )
 	if( ent == svgame.edicts ) return;		// don't add the world
 	if( !SV_IsValidEdict( ent )) return;		// never add freed ents
 
+	SV_InvalidateTraceCache();
+
 	// set the abs box
 	svgame.dllFuncs.pfnSetAbsBox( ent );
 
@@ -673,10 +679,6 @@ void GAME_EXPORT SV_LinkEdict( edict_t *ent, qboolean touch_triggers )
 		}
 	}
 
-	// ignore non-solid bodies
-	if( ent->v.solid == SOLID_NOT && ent->v.skin >= CONTENTS_EMPTY )
-		return;
-
 	// find the first node that the ent's box crosses
 	node = sv_areanodes;
 
@@ -690,6 +692,13 @@ void GAME_EXPORT SV_LinkEdict( edict_t *ent, qboolean touch_triggers )
 		else break; // crosses the node
 	}
 
+	// non-solid bodies never clip or touch, but still can be pushed
+	if( ent->v.solid == SOLID_NOT && ent->v.skin >= CONTENTS_EMPTY )
+	{
+		InsertLinkBefore( &ent->area, &sv_nonsolid_edicts[node - sv_areanodes] );
+		return;
+	}
+
 	// link it in
 	if( ent->v.solid == SOLID_TRIGGER )
 		InsertLinkBefore( &ent->area, &node->trigger_edicts );
@@ -705,6 +714,68 @@ void GAME_EXPORT SV_LinkEdict( edict_t *ent, qboolean touch_triggers )
 	}
 }
 
+/*
+====================
+SV_AreaEdicts_r
+
+====================
+*/
+static void SV_AreaEdicts_r( areanode_t *node, const vec3_t mins, const vec3_t maxs, edict_t **list, int maxcount, int *count )
+{
+	link_t	*chains[4], *l, *start;
+	edict_t	*check;
+	int	i;
+
+	chains[0] = &node->solid_edicts;
+	chains[1] = &node->trigger_edicts;
+	chains[2] = &node->portal_edicts;
+	chains[3] = &sv_nonsolid_edicts[node - sv_areanodes];
+
+	for( i = 0; i < ARRAYSIZE( chains ); i++ )
+	{
+		start = chains[i];
+
+		for( l = start->next; l != start; l = l->next )
+		{
+			check = EDICT_FROM_AREA( l );
+
+			if( !BoundsIntersect( mins, maxs, check->v.absmin, check->v.absmax ))
+				continue;
+
+			if( *count == maxcount )
+				return;
+
+			list[(*count)++] = check;
+		}
+	}
+
+	// recurse down both sides
+	if( node->axis == -1 ) return;
+
+	if( maxs[node->axis] > node->dist )
+		SV_AreaEdicts_r( node->children[0], mins, maxs, list, maxcount, count );
+	if( mins[node->axis] < node->dist )
+		SV_AreaEdicts_r( node->children[1], mins, maxs, list, maxcount, count );
+}
+
+/*
+====================
+SV_AreaEdicts
+
+fills list with every linked edict (solid, trigger,
+portal or non-solid) which absbox intersects the given bounds
+returns number of edicts written
+====================
+*/
+int SV_AreaEdicts( const vec3_t mins, const vec3_t maxs, edict_t **list, int maxcount )
+{
+	int	count = 0;
+
+	SV_AreaEdicts_r( sv_areanodes, mins, maxs, list, maxcount, &count );
+
+	return count;
+}
+
 /*
 ===============================================================================
 
@@ -795,7 +866,7 @@ int SV_TruePointContents( const vec3_t p )
 	if( !p ) return CONTENTS_NONE;
 
 	// get base contents from world
-	cont = PM_HullPointContents( &sv.worldmodel->hulls[0], 0, p );
+	cont = Mod_WorldPointContents( sv.worldmodel, p );
 
 	// check all water entities
 	SV_WaterLinks( p, &cont, sv_areanodes );
@@ -1306,16 +1377,143 @@ static void SV_ClipToWorldBrush( areanode_t *node, moveclip_t *clip )
 		SV_ClipToWorldBrush( node->children[1], clip );
 }
 
+/*
+==================
+SV_InvalidateTraceCache
+
+called whenever world changes
+==================
+*/
+void SV_InvalidateTraceCache( void )
+{
+	if( !svgame.tracecache )
+		return;
+
+	svgame.tracecache->generation++;
+	svgame.tracecache->invalidations++;
+
+	// don't mistake stale entries for fresh after wrap
+	if( svgame.tracecache->generation == 0 )
+	{
+		memset( svgame.tracecache->entries, 0, sizeof( svgame.tracecache->entries ));
+		svgame.tracecache->generation = 1;
+	}
+}
+
+/*
+==================
+SV_TraceCacheEntry
+
+fills the key and returns the slot for it
+==================
+*/
+static sv_tracecacheentry_t *SV_TraceCacheEntry( sv_tracekey_t *key, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int type, edict_t *e, qboolean monsterclip )
+{
+	CRC32_t	crc;
+
+	// clear the padding, keys are compared with memcmp
+	memset( key, 0, sizeof( *key ));
+	key->passedict = e;
+	VectorCopy( start, key->start );
+	VectorCopy( end, key->end );
+	VectorCopy( mins, key->mins );
+	VectorCopy( maxs, key->maxs );
+	key->type = type;
+	key->monsterclip = monsterclip;
+	key->groupinfo = SV_IsValidEdict( e ) ? e->v.groupinfo : 0;
+	key->groupop = svs.groupop;
+	key->traceflags = svgame.globals->trace_flags;
+
+	CRC32_Init( &crc );
+	CRC32_ProcessBuffer( &crc, key, sizeof( *key ));
+	crc = CRC32_Final( crc );
+
+	return &svgame.tracecache->entries[crc & ( TRACE_CACHE_SIZE - 1 )];
+}
+
+/*
+==================
+SV_TraceEqual
+
+==================
+*/
+static qboolean SV_TraceEqual( const trace_t *a, const trace_t *b )
+{
+	return a->fraction == b->fraction && VectorCompare( a->endpos, b->endpos )
+		&& VectorCompare( a->plane.normal, b->plane.normal ) && a->plane.dist == b->plane.dist
+		&& a->allsolid == b->allsolid && a->startsolid == b->startsolid
+		&& a->inopen == b->inopen && a->inwater == b->inwater
+		&& a->ent == b->ent && a->hitgroup == b->hitgroup;
+}
+
 /*
 ==================
 SV_Move
 ==================
 */
 trace_t SV_Move( const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int type, edict_t *e, qboolean monsterclip )
+{
+	sv_tracecacheentry_t *entry = NULL;
+	sv_tracekey_t key;
+	trace_t worldtrace, trace;
+	uint generation = 0;
+
+	if( sv_tracecache.value && svgame.tracecache )
+	{
+		generation = svgame.tracecache->generation;
+		entry = SV_TraceCacheEntry( &key, start, mins, maxs, end, type, e, monsterclip );
+
+		if( entry->generation == svgame.tracecache->generation && !memcmp( &entry->key, &key, sizeof( key )))
+		{
+			svgame.tracecache->hits++;
+
+			if( sv_tracecache.value < 2.0f )
+			{
+				SV_CopyTraceToGlobal( &entry->trace );
+				return entry->trace;
+			}
+		}
+		else svgame.tracecache->misses++;
+	}
+
+	SV_ClipMoveToEntity( EDICT_NUM( 0 ), start, mins, maxs, end, &worldtrace );
+	trace = SV_MoveFromWorldTrace( start, mins, maxs, end, type, e, monsterclip, &worldtrace );
+
+	if( entry )
+	{
+		// verify mode, cached result must be the same
+		if( entry->generation == svgame.tracecache->generation && !memcmp( &entry->key, &key, sizeof( key ))
+			&& !SV_TraceEqual( &entry->trace, &trace ))
+		{
+			Con_Printf( S_WARN "%s: cached trace mismatch (%g %g %g to %g %g %g)\n", __func__,
+				start[0], start[1], start[2], end[0], end[1], end[2] );
+			svgame.tracecache->mismatches++;
+		}
+
+		// don't store if game dll relinked something from inside of the trace
+		if( generation == svgame.tracecache->generation )
+		{
+			entry->generation = generation;
+			entry->key = key;
+			entry->trace = trace;
+		}
+	}
+
+	return trace;
+}
+
+/*
+==================
+SV_MoveFromWorldTrace
+
+same as SV_Move, but world hull was already traced
+==================
+*/
+trace_t SV_MoveFromWorldTrace( const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int type, edict_t *e, qboolean monsterclip, const trace_t *worldtrace )
 {
 	moveclip_t clip = { 0 };
 
-	SV_ClipMoveToEntity( EDICT_NUM( 0 ), start, mins, maxs, end, &clip.trace );
+	clip.trace = *worldtrace;
 
 	if( clip.trace.fraction != 0.0f )
 	{
@@ -1458,12 +1656,19 @@ const char *SV_TraceTexture( edict_t *ent, const vec3_t start, const vec3_t end
 	return surf->texinfo->texture->name;
 }
 
+#define TOSS_STEPS		200
+#define TOSS_STEP_TIME	0.05f
+#define TOSS_WORLD_SPAN	32	// max steps checked against the world at once
+#define TOSS_WORLD_RETRY	4	// steps to wait after the world box check failed
+
 /*
 ==================
-SV_MoveToss
+SV_MoveTossStepped
+
+reference implementation, does a full SV_Move for every step
 ==================
 */
-trace_t SV_MoveToss( edict_t *tossent, edict_t *ignore )
+trace_t SV_MoveTossStepped( edict_t *tossent, edict_t *ignore )
 {
 	float 	gravity;
 	vec3_t	move, end;
@@ -1478,14 +1683,14 @@ trace_t SV_MoveToss( edict_t *tossent, edict_t *ignore )
 	VectorCopy( tossent->v.velocity, original_velocity );
 	VectorCopy( tossent->v.angles, original_angles );
 	VectorCopy( tossent->v.avelocity, original_avelocity );
-	gravity = tossent->v.gravity * sv_gravity.value * 0.05f;
+	gravity = tossent->v.gravity * sv_gravity.value * TOSS_STEP_TIME;
 
-	for( i = 0; i < 200; i++ )
+	for( i = 0; i < TOSS_STEPS; i++ )
 	{
 		SV_CheckVelocity( tossent );
 		tossent->v.velocity[2] -= gravity;
-		VectorMA( tossent->v.angles, 0.05f, tossent->v.avelocity, tossent->v.angles );
-		VectorScale( tossent->v.velocity, 0.05f, move );
+		VectorMA( tossent->v.angles, TOSS_STEP_TIME, tossent->v.avelocity, tossent->v.angles );
+		VectorScale( tossent->v.velocity, TOSS_STEP_TIME, move );
 		VectorAdd( tossent->v.origin, move, end );
 		trace = SV_Move( tossent->v.origin, tossent->v.mins, tossent->v.maxs, end, MOVE_NORMAL, tossent, false );
 		VectorCopy( trace.endpos, tossent->v.origin );
@@ -1500,6 +1705,255 @@ trace_t SV_MoveToss( edict_t *tossent, edict_t *ignore )
 	return trace;
 }
 
+/*
+====================
+SV_TossCandidates_r
+
+same walk as SV_ClipToLinks and SV_ClipToPortals
+so candidates come in the same order
+====================
+*/
+static void SV_TossCandidates_r( areanode_t *node, const vec3_t mins, const vec3_t maxs, qboolean portals, edict_t **list, int maxcount, int *count )
+{
+	link_t	*start = portals ? &node->portal_edicts : &node->solid_edicts;
+	link_t	*l;
+	edict_t	*check;
+
+	for( l = start->next; l != start; l = l->next )
+	{
+		check = EDICT_FROM_AREA( l );
+
+		if( !BoundsIntersect( mins, maxs, check->v.absmin, check->v.absmax ))
+			continue;
+
+		if( *count == maxcount )
+			return;
+
+		list[(*count)++] = check;
+	}
+
+	// recurse down both sides
+	if( node->axis == -1 ) return;
+
+	if( maxs[node->axis] > node->dist )
+		SV_TossCandidates_r( node->children[0], mins, maxs, portals, list, maxcount, count );
+	if( mins[node->axis] < node->dist )
+		SV_TossCandidates_r( node->children[1], mins, maxs, portals, list, maxcount, count );
+}
+
+/*
+====================
+SV_TossWorldContents
+
+returns contents of the world around several steps of
+trajectory or CONTENTS_NONE if they need a real hull trace
+====================
+*/
+static int SV_TossWorldContents( hull_t *hull, const vec3_t offset, vec3_t *starts, vec3_t *ends, int count )
+{
+	vec3_t	mins, maxs;
+	int	i, j, contents;
+
+	ClearBounds( mins, maxs );
+
+	for( i = 0; i < count; i++ )
+	{
+		AddPointToBounds( starts[i], mins, maxs );
+		AddPointToBounds( ends[i], mins, maxs );
+	}
+
+	// move into hull space, leave some room for rounding errors
+	for( j = 0; j < 3; j++ )
+	{
+		mins[j] -= offset[j] + 1.0f;
+		maxs[j] -= offset[j] - 1.0f;
+	}
+
+	contents = Mod_HullBoxContents( hull, mins, maxs );
+
+	return contents == CONTENTS_SOLID ? CONTENTS_NONE : contents;
+}
+
+/*
+==================
+SV_MoveTossSegment
+
+same as SV_Move but clips only against prepared
+candidates and may skip the world hull trace
+==================
+*/
+static trace_t SV_MoveTossSegment( edict_t *tossent, const vec3_t start, const vec3_t end, int worldcontents, edict_t **list, int numsolids, int numportals )
+{
+	moveclip_t	clip = { 0 };
+	edict_t		*touch;
+	int		i;
+
+	if( worldcontents != CONTENTS_NONE )
+	{
+		// the same thing hull trace would return for a move in one contents
+		PM_InitTrace( &clip.trace, end );
+		clip.trace.allsolid = false;
+
+		if( worldcontents == CONTENTS_EMPTY )
+			clip.trace.inopen = true;
+		else clip.trace.inwater = true;
+	}
+	else SV_ClipMoveToEntity( EDICT_NUM( 0 ), start, tossent->v.mins, tossent->v.maxs, end, &clip.trace );
+
+	if( clip.trace.fraction != 0.0f )
+	{
+		const float trace_fraction = clip.trace.fraction;
+		vec3_t trace_endpos;
+		VectorCopy( clip.trace.endpos, trace_endpos );
+
+		clip.trace.fraction = 1.0f;
+		clip.start = start;
+		clip.end = trace_endpos;
+		clip.type = MOVE_NORMAL;
+		clip.passedict = tossent;
+		clip.mins = tossent->v.mins;
+		clip.maxs = tossent->v.maxs;
+		VectorCopy( tossent->v.mins, clip.mins2 );
+		VectorCopy( tossent->v.maxs, clip.maxs2 );
+
+		World_MoveBounds( start, clip.mins2, clip.maxs2, trace_endpos, clip.boxmins, clip.boxmaxs );
+
+		for( i = 0; i < numsolids + numportals; i++ )
+		{
+			touch = list[i];
+
+			// far from this segment
+			if( !BoundsIntersect( clip.boxmins, clip.boxmaxs, touch->v.absmin, touch->v.absmax ))
+				continue;
+
+			if( !SV_ClipToEntity( touch, &clip ))
+				break; // trace.allsolid
+		}
+
+		clip.trace.fraction *= trace_fraction;
+		svgame.globals->trace_ent = clip.trace.ent;
+	}
+
+	SV_CopyTraceToGlobal( &clip.trace );
+
+	return clip.trace;
+}
+
+/*
+==================
+SV_MoveToss
+
+predicts the whole flight first, collects entities around
+it once and checks the world for several steps at once
+where it's possible. Gives the same result as SV_MoveTossStepped
+==================
+*/
+trace_t SV_MoveToss( edict_t *tossent, edict_t *ignore )
+{
+	vec3_t	starts[TOSS_STEPS];
+	vec3_t	ends[TOSS_STEPS];
+	float 	gravity;
+	vec3_t	move, end;
+	vec3_t	original_origin;
+	vec3_t	original_velocity;
+	vec3_t	original_angles;
+	vec3_t	original_avelocity;
+	vec3_t	boxmins, boxmaxs;
+	vec3_t	mins, maxs;
+	vec3_t	offset;
+	edict_t	*world = EDICT_NUM( 0 );
+	hull_t	*hull = NULL;
+	int	numsolids = 0, numportals = 0;
+	int	worldcontents = CONTENTS_NONE;
+	int	worldvalid = 0, worldretry = 0;
+	int	span = TOSS_WORLD_SPAN;
+	trace_t	trace;
+	int	i, n;
+
+	VectorCopy( tossent->v.origin, original_origin );
+	VectorCopy( tossent->v.velocity, original_velocity );
+	VectorCopy( tossent->v.angles, original_angles );
+	VectorCopy( tossent->v.avelocity, original_avelocity );
+	gravity = tossent->v.gravity * sv_gravity.value * TOSS_STEP_TIME;
+
+	// free flight, it's exact up to the first impact because
+	// trace with fraction 1.0 always ends at the end point
+	ClearBounds( mins, maxs );
+
+	for( i = 0; i < TOSS_STEPS; i++ )
+	{
+		SV_CheckVelocity( tossent );
+		tossent->v.velocity[2] -= gravity;
+		VectorScale( tossent->v.velocity, TOSS_STEP_TIME, move );
+		VectorCopy( tossent->v.origin, starts[i] );
+		VectorAdd( tossent->v.origin, move, ends[i] );
+		VectorCopy( ends[i], tossent->v.origin );
+
+		World_MoveBounds( starts[i], tossent->v.mins, tossent->v.maxs, ends[i], boxmins, boxmaxs );
+		AddPointToBounds( boxmins, mins, maxs );
+		AddPointToBounds( boxmaxs, mins, maxs );
+	}
+
+	VectorCopy( original_origin, tossent->v.origin );
+	VectorCopy( original_velocity, tossent->v.velocity );
+
+	// gather broadphase candidates once for the whole parabola
+	SV_TossCandidates_r( sv_areanodes, mins, maxs, false, svgame.tosscheck, GI->max_edicts, &numsolids );
+	SV_TossCandidates_r( sv_areanodes, mins, maxs, true, svgame.tosscheck + numsolids, GI->max_edicts - numsolids, &numportals );
+
+	if( world->v.solid == SOLID_BSP && VectorIsNull( world->v.angles ))
+	{
+		hull = SV_HullForEntity( world, tossent->v.mins, tossent->v.maxs, offset );
+
+		// empty hull has its own trace result
+		if( hull->firstclipnode >= hull->lastclipnode )
+			hull = NULL;
+	}
+
+	for( i = 0; i < TOSS_STEPS; i++ )
+	{
+		SV_CheckVelocity( tossent );
+		tossent->v.velocity[2] -= gravity;
+		VectorMA( tossent->v.angles, TOSS_STEP_TIME, tossent->v.avelocity, tossent->v.angles );
+		VectorScale( tossent->v.velocity, TOSS_STEP_TIME, move );
+		VectorAdd( tossent->v.origin, move, end );
+
+		// find out how far we can go without tracing the world
+		if( hull && i >= worldvalid && i >= worldretry )
+		{
+			for( n = Q_min( span, TOSS_STEPS - i ); n > 0; n >>= 1 )
+			{
+				worldcontents = SV_TossWorldContents( hull, offset, &starts[i], &ends[i], n );
+				if( worldcontents != CONTENTS_NONE )
+					break;
+			}
+
+			if( n > 0 )
+			{
+				worldvalid = i + n;
+				span = Q_min( span * 2, TOSS_WORLD_SPAN );
+			}
+			else
+			{
+				worldretry = i + TOSS_WORLD_RETRY;
+				span = 2;
+			}
+		}
+
+		trace = SV_MoveTossSegment( tossent, tossent->v.origin, end, i < worldvalid ? worldcontents : CONTENTS_NONE,
+			svgame.tosscheck, numsolids, numportals );
+		VectorCopy( trace.endpos, tossent->v.origin );
+		if( trace.fraction < 1.0f ) break;
+	}
+
+	VectorCopy( original_origin, tossent->v.origin );
+	VectorCopy( original_velocity, tossent->v.velocity );
+	VectorCopy( original_angles, tossent->v.angles );
+	VectorCopy( original_avelocity, tossent->v.avelocity );
+
+	return trace;
+}
+
 /*
 ===============================================================================
 
@@ -57,6 +57,7 @@ char          fs_rootdir[MAX_SYSPATH];
 searchpath_t *fs_writepath;
 
 static searchpath_t *fs_searchpaths = NULL;	// chain
+static int fs_generation = 0;	// changes with search paths or files in write path
 static char fs_basedir[MAX_SYSPATH];	// base game directory
 static char fs_gamedir[MAX_SYSPATH];	// game current directory
 static char fs_rodir[MAX_SYSPATH];
@@ -401,6 +402,7 @@ static searchpath_t *FS_AddArchive_Fullpath( const fs_archive_t *archive, const
 
 	search->next = fs_searchpaths;
 	fs_searchpaths = search;
+	fs_generation++;
 
 	// time to add in search list all the wads from this archive
 	if( archive->load_wads && !FBitSet( flags, FS_SKIP_ARCHIVED_WADS ))
@@ -518,6 +520,8 @@ void FS_ClearSearchPath( void )
 		Mem_Free( cur );
 	}
 
+	fs_generation++;
+
 	for( i = 0; i < FI.numgames; i++ )
 	{
 		if( FI.games[i] )
@@ -2300,6 +2304,7 @@ file_t *FS_Open( const char *filepath, const char *mode, qboolean gamedironly )
 			return NULL;
 
 		FS_CreatePath( real_path ); // Create directories up to the file
+		fs_generation++; // file contents might change
 
 		return FS_SysOpen( real_path, mode );
 	}
@@ -3203,6 +3208,7 @@ qboolean FS_Rename( const char *oldname, const char *newname )
 		return false;
 	}
 
+	fs_generation++;
 	return true;
 }
 
@@ -3238,9 +3244,24 @@ qboolean GAME_EXPORT FS_Delete( const char *path )
 		return false;
 	}
 
+	fs_generation++;
 	return true;
 }
 
+/*
+==================
+FS_GetGeneration
+
+returns counter that changes every time when search paths
+are changed or files in write path are modified,
+can be used by engine to invalidate cached lookups
+==================
+*/
+static int FS_GetGeneration( void )
+{
+	return fs_generation;
+}
+
 /*
 ==================
 FS_FileCopy
@@ -3514,6 +3535,8 @@ const fs_api_t g_api =
 	FS_GetRootDirectory,
 
 	FS_MakeGameInfo,
+
+	FS_GetGeneration,
 };
 
 int EXPORT GetFSAPI( int version, fs_api_t *api, fs_globals_t **globals, fs_interface_t *engfuncs );
@@ -32,8 +32,8 @@ extern "C"
 {
 #endif // __cplusplus
 
-#define FS_API_VERSION 3 // not stable yet!
-#define FS_API_CREATEINTERFACE_TAG   "XashFileSystem002" // follow FS_API_VERSION!!!
+#define FS_API_VERSION 4 // not stable yet!
+#define FS_API_CREATEINTERFACE_TAG   "XashFileSystem003" // follow FS_API_VERSION!!!
 #define FILESYSTEM_INTERFACE_VERSION "VFileSystem009" // never change this!
 
 // search path flags
@@ -238,6 +238,9 @@ typedef struct fs_api_t
 	qboolean (*GetRootDirectory)( char *path, size_t size );
 
 	void (*MakeGameInfo)( void );
+
+	// changes every time search paths or files in write path are modified
+	int (*GetGeneration)( void );
 } fs_api_t;
 
 typedef struct fs_interface_t
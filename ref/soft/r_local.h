@@ -464,6 +464,7 @@ void Matrix4x4_CreateModelview( matrix4x4 out );
 void CL_DrawParticlesExternal( const ref_viewpass_t *rvp, qboolean trans_pass, float frametime );
 void CL_DrawParticles( double frametime, particle_t *cl_active_particles, float partsize );
 void CL_DrawTracers( double frametime, particle_t *cl_active_tracers );
+void R_ParticleBench_f( void );
 
 
 //
@@ -1054,6 +1055,7 @@ extern convar_t sw_surfcacheoverride;
 extern convar_t sw_texfilt;
 extern convar_t r_traceglow;
 extern convar_t sw_noalphabrushes;
+extern convar_t sw_particlesplat;
 extern convar_t r_studio_sort_textures;
 
 extern struct qfrustum_s
@@ -1092,6 +1094,7 @@ extern aliastriangleparms_t aliastriangleparms;
 
 extern int   r_aliasblendcolor;
 
+extern float aliastransform[3][4];
 extern float aliasxscale, aliasyscale, aliasxcenter, aliasycenter;
 extern float s_ziscale;
 
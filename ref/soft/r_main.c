@@ -69,6 +69,7 @@ static CVAR_DEFINE_AUTO( sw_notransbrushes, "0", FCVAR_GLCONFIG, "do not apply t
 CVAR_DEFINE_AUTO( sw_noalphabrushes, "0", FCVAR_GLCONFIG, "do not draw brush holes (faster)" );
 CVAR_DEFINE_AUTO( r_traceglow, "0", FCVAR_GLCONFIG, "cull flares behind models" );
 CVAR_DEFINE_AUTO( sw_texfilt, "0", FCVAR_GLCONFIG, "texture dither" );
+CVAR_DEFINE_AUTO( sw_particlesplat, "1", FCVAR_GLCONFIG, "draw small particles and tracers as projected squares (faster)" );
 static CVAR_DEFINE_AUTO( r_novis, "0", 0, "" );
 
 
@@ -1508,6 +1509,9 @@ qboolean GAME_EXPORT R_Init( void )
 #endif
 	gEngfuncs.Cvar_RegisterVariable( &r_novis );
 	gEngfuncs.Cvar_RegisterVariable( &r_studio_sort_textures );
+	gEngfuncs.Cvar_RegisterVariable( &sw_particlesplat );
+
+	gEngfuncs.Cmd_AddCommand( "particlebench", R_ParticleBench_f, "compare particle splat and triangle drawing speed" );
 
 	r_temppool = Mem_AllocPool( "ref_soft zone" );
 
@@ -1562,6 +1566,7 @@ qboolean GAME_EXPORT R_Init( void )
 
 void GAME_EXPORT R_Shutdown( void )
 {
+	gEngfuncs.Cmd_RemoveCommand( "particlebench" );
 	R_ShutdownImages();
 	gEngfuncs.R_Free_Video();
 }
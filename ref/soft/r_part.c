@@ -38,6 +38,181 @@ static color24 gTracerColors[] =
 	{ 255, 120, 70 },  // Darker red streaks (garg)
 };
 
+#define PARTICLE_SPLAT_MAX 32 // bigger projections go through the triangle setup
+
+/*
+================
+R_ProjectParticle
+
+transform point by the world transform and project it,
+returns false if it's behind the near clip plane
+================
+*/
+static qboolean R_ProjectParticle( const vec3_t org, float *u, float *v, float *zi )
+{
+	float z;
+
+	z = DotProduct( org, aliastransform[2] ) + aliastransform[2][3];
+
+	if( z < ALIAS_Z_CLIP_PLANE )
+		return false;
+
+	*zi = 1.0f / z;
+	*u = ( DotProduct( org, aliastransform[0] ) + aliastransform[0][3] ) * aliasxscale * *zi + aliasxcenter;
+	*v = ( DotProduct( org, aliastransform[1] ) + aliastransform[1][3] ) * aliasyscale * *zi + aliasycenter;
+
+	return true;
+}
+
+/*
+================
+R_DrawParticleSplat
+
+draw screen aligned square of given side centered at projected point
+with currently bound texture, depth tested and added to the framebuffer
+================
+*/
+static void R_DrawParticleSplat( float u, float v, float zi, int side )
+{
+	const pixel_t *pskin = r_affinetridesc.pskin;
+	int           x0, y0, x1, y1, x, y;
+	int           sstep, tstep, sbase, t;
+	pixel_t       *pdest, texel;
+	short         *pz;
+	int           izi;
+
+	if( !pskin )
+		return;
+
+	izi = (int)( zi * s_ziscale ) >> 16;
+
+	x0 = Q_rint( u - side * 0.5f );
+	y0 = Q_rint( v - side * 0.5f );
+	x1 = x0 + side;
+	y1 = y0 + side;
+
+	// single pixel is the most common case for distant particles
+	if( side == 1 )
+	{
+		if( x0 < RI.aliasvrect.x || x0 >= RI.aliasvrectright || y0 < RI.aliasvrect.y || y0 >= RI.aliasvrectbottom )
+			return;
+
+		pz = d_pzbuffer + y0 * d_zwidth + x0;
+
+		if( izi < *pz )
+			return;
+
+		texel = pskin[( r_affinetridesc.skinheight >> 1 ) * r_affinetridesc.skinwidth + ( r_affinetridesc.skinwidth >> 1 )];
+
+		if( texel )
+		{
+			pdest = d_viewbuffer + y0 * r_screenwidth + x0;
+			texel = BLEND_COLOR( texel, vid.color );
+			*pdest = BLEND_ADD( texel, *pdest );
+		}
+		return;
+	}
+
+	sstep = ( r_affinetridesc.skinwidth << 16 ) / side;
+	tstep = ( r_affinetridesc.skinheight << 16 ) / side;
+	sbase = sstep >> 1;
+	t = tstep >> 1;
+
+	// clip against the view rectangle, skipping texels accordingly
+	if( x0 < RI.aliasvrect.x )
+	{
+		sbase += ( RI.aliasvrect.x - x0 ) * sstep;
+		x0 = RI.aliasvrect.x;
+	}
+
+	if( y0 < RI.aliasvrect.y )
+	{
+		t += ( RI.aliasvrect.y - y0 ) * tstep;
+		y0 = RI.aliasvrect.y;
+	}
+
+	x1 = Q_min( x1, RI.aliasvrectright );
+	y1 = Q_min( y1, RI.aliasvrectbottom );
+
+	for( y = y0; y < y1; y++, t += tstep )
+	{
+		const pixel_t *prow = pskin + ( t >> 16 ) * r_affinetridesc.skinwidth;
+		int           s = sbase;
+
+		pdest = d_viewbuffer + y * r_screenwidth + x0;
+		pz = d_pzbuffer + y * d_zwidth + x0;
+
+		for( x = x0; x < x1; x++, pdest++, pz++, s += sstep )
+		{
+			if( izi < *pz )
+				continue;
+
+			texel = prow[s >> 16];
+
+			// black adds nothing
+			if( !texel )
+				continue;
+
+			texel = BLEND_COLOR( texel, vid.color );
+			*pdest = BLEND_ADD( texel, *pdest );
+		}
+	}
+}
+
+/*
+================
+R_DrawParticleQuad
+
+draw particle as two triangles through TriAPI
+================
+*/
+static void R_DrawParticleQuad( const vec3_t org, float size )
+{
+	vec3_t right, up;
+
+	// scale the axes by radius
+	VectorScale( RI.cull_vright, size, right );
+	VectorScale( RI.cull_vup, size, up );
+
+	TriBegin( TRI_QUADS );
+	TriTexCoord2f( 0.0f, 1.0f );
+	TriVertex3f( org[0] - right[0] + up[0], org[1] - right[1] + up[1], org[2] - right[2] + up[2] );
+	TriTexCoord2f( 0.0f, 0.0f );
+	TriVertex3f( org[0] + right[0] + up[0], org[1] + right[1] + up[1], org[2] + right[2] + up[2] );
+	TriTexCoord2f( 1.0f, 0.0f );
+	TriVertex3f( org[0] + right[0] - up[0], org[1] + right[1] - up[1], org[2] + right[2] - up[2] );
+	TriTexCoord2f( 1.0f, 1.0f );
+	TriVertex3f( org[0] - right[0] - up[0], org[1] - right[1] - up[1], org[2] - right[2] - up[2] );
+	TriEnd();
+}
+
+/*
+================
+R_DrawSingleParticle
+
+project particle once and splat it if it's small enough,
+otherwise let the triangle code deal with clipping
+================
+*/
+static void R_DrawSingleParticle( const vec3_t org, float size, qboolean splat )
+{
+	float u, v, zi;
+	int   side;
+
+	if( splat && R_ProjectParticle( org, &u, &v, &zi ))
+	{
+		side = Q_rint( size * 2.0f * aliasxscale * zi );
+
+		if( side <= PARTICLE_SPLAT_MAX )
+		{
+			R_DrawParticleSplat( u, v, zi, Q_max( side, 1 ));
+			return;
+		}
+	}
+
+	R_DrawParticleQuad( org, size );
+}
+
 /*
 ================
 CL_DrawParticles
@@ -48,10 +223,10 @@ update particle color, position, free expired and draw it
 void GAME_EXPORT CL_DrawParticles( double frametime, particle_t *cl_active_particles, float partsize )
 {
 	particle_t *p;
-	vec3_t     right, up;
 	color24    color;
 	int        alpha;
 	float      size;
+	qboolean   splat = sw_particlesplat.value != 0.0f;
 
 	if( !cl_active_particles )
 		return; // nothing to draw?
@@ -81,10 +256,6 @@ void GAME_EXPORT CL_DrawParticles( double frametime, particle_t *cl_active_parti
 			else
 				size = partsize + size * 0.002f;
 
-			// scale the axes by radius
-			VectorScale( RI.cull_vright, size, right );
-			VectorScale( RI.cull_vup, size, up );
-
 			p->color = bound( 0, p->color, 255 );
 			color = tr.palette[p->color];
 
@@ -98,16 +269,7 @@ void GAME_EXPORT CL_DrawParticles( double frametime, particle_t *cl_active_parti
 			// TriBrightness( alpha / 255.0f );
 			_TriColor4f( 1.0f * alpha / 255 / 255 * color.r, 1.0f * alpha / 255 / 255 * color.g, 1.0f * alpha / 255 / 255 * color.b, 1.0f );
 
-			TriBegin( TRI_QUADS );
-			TriTexCoord2f( 0.0f, 1.0f );
-			TriVertex3f( p->org[0] - right[0] + up[0], p->org[1] - right[1] + up[1], p->org[2] - right[2] + up[2] );
-			TriTexCoord2f( 0.0f, 0.0f );
-			TriVertex3f( p->org[0] + right[0] + up[0], p->org[1] + right[1] + up[1], p->org[2] + right[2] + up[2] );
-			TriTexCoord2f( 1.0f, 0.0f );
-			TriVertex3f( p->org[0] + right[0] - up[0], p->org[1] + right[1] - up[1], p->org[2] + right[2] - up[2] );
-			TriTexCoord2f( 1.0f, 1.0f );
-			TriVertex3f( p->org[0] - right[0] - up[0], p->org[1] - right[1] - up[1], p->org[2] - right[2] - up[2] );
-			TriEnd();
+			R_DrawSingleParticle( p->org, size, splat );
 			r_stats.c_particle_count++;
 		}
 
@@ -156,6 +318,80 @@ static qboolean CL_CullTracer( particle_t *p, const vec3_t start, const vec3_t e
 	return R_CullBox( mins, maxs );*/
 }
 
+/*
+================
+R_DrawTracerSplat
+
+streak that is no longer than it is wide is just a dot on the screen,
+returns false if tracer must be drawn as quad
+================
+*/
+static qboolean R_DrawTracerSplat( const vec3_t start, const vec3_t end, float size )
+{
+	float u0, v0, zi0, u1, v1, zi1;
+	float width, length;
+
+	if( !R_ProjectParticle( start, &u0, &v0, &zi0 ) || !R_ProjectParticle( end, &u1, &v1, &zi1 ))
+		return false;
+
+	width = size * 2.0f * aliasxscale * Q_max( zi0, zi1 );
+	length = Q_max( fabs( u1 - u0 ), fabs( v1 - v0 ));
+
+	if( length > width || width > PARTICLE_SPLAT_MAX )
+		return false;
+
+	R_DrawParticleSplat(( u0 + u1 ) * 0.5f, ( v0 + v1 ) * 0.5f, Q_max( zi0, zi1 ), Q_max( Q_rint( width ), 1 ));
+
+	return true;
+}
+
+/*
+================
+R_DrawTracerQuad
+
+draw tracer streak as two triangles through TriAPI
+================
+*/
+static void R_DrawTracerQuad( const vec3_t start, const vec3_t end, const vec3_t delta, float size )
+{
+	vec3_t screenLast, screen;
+	vec3_t verts[4], tmp2;
+	vec3_t tmp, normal;
+
+	// Transform point into screen space
+	TriWorldToScreen( start, screen );
+	TriWorldToScreen( end, screenLast );
+
+	// build world-space normal to screen-space direction vector
+	VectorSubtract( screen, screenLast, tmp );
+
+	// we don't need Z, we're in screen space
+	tmp[2] = 0;
+	VectorNormalize( tmp );
+
+	// build point along noraml line (normal is -y, x)
+	VectorScale( RI.cull_vup, tmp[0] * size, normal );
+	VectorScale( RI.cull_vright, -tmp[1] * size, tmp2 );
+	VectorSubtract( normal, tmp2, normal );
+
+	// compute four vertexes
+	VectorSubtract( start, normal, verts[0] );
+	VectorAdd( start, normal, verts[1] );
+	VectorAdd( verts[0], delta, verts[2] );
+	VectorAdd( verts[1], delta, verts[3] );
+
+	TriBegin( TRI_QUADS );
+	TriTexCoord2f( 0.0f, 0.8f );
+	TriVertex3fv( verts[2] );
+	TriTexCoord2f( 1.0f, 0.8f );
+	TriVertex3fv( verts[3] );
+	TriTexCoord2f( 1.0f, 0.0f );
+	TriVertex3fv( verts[1] );
+	TriTexCoord2f( 0.0f, 0.0f );
+	TriVertex3fv( verts[0] );
+	TriEnd();
+}
+
 /*
 ================
 CL_DrawTracers
@@ -166,9 +402,9 @@ update tracer color, position, free expired and draw it
 void GAME_EXPORT CL_DrawTracers( double frametime, particle_t *cl_active_tracers )
 {
 	float      scale, atten, gravity;
-	vec3_t     screenLast, screen;
 	vec3_t     start, end, delta;
 	particle_t *p;
+	qboolean   splat = sw_particlesplat.value != 0.0f;
 
 	// update tracer color if this is changed
 	if( FBitSet( tracerred->flags | tracergreen->flags | tracerblue->flags | traceralpha->flags, FCVAR_CHANGED ))
@@ -213,33 +449,9 @@ void GAME_EXPORT CL_DrawTracers( double frametime, particle_t *cl_active_tracers
 
 		if( !CL_CullTracer( p, start, end ))
 		{
-			vec3_t  verts[4], tmp2;
-			vec3_t  tmp, normal;
 			color24 color;
 			short   alpha = p->packedColor;
 
-			// Transform point into screen space
-			TriWorldToScreen( start, screen );
-			TriWorldToScreen( end, screenLast );
-
-			// build world-space normal to screen-space direction vector
-			VectorSubtract( screen, screenLast, tmp );
-
-			// we don't need Z, we're in screen space
-			tmp[2] = 0;
-			VectorNormalize( tmp );
-
-			// build point along noraml line (normal is -y, x)
-			VectorScale( RI.cull_vup, tmp[0] * gTracerSize[p->type], normal );
-			VectorScale( RI.cull_vright, -tmp[1] * gTracerSize[p->type], tmp2 );
-			VectorSubtract( normal, tmp2, normal );
-
-			// compute four vertexes
-			VectorSubtract( start, normal, verts[0] );
-			VectorAdd( start, normal, verts[1] );
-			VectorAdd( verts[0], delta, verts[2] );
-			VectorAdd( verts[1], delta, verts[3] );
-
 			if( p->color < 0 || p->color >= sizeof( gTracerColors ) / sizeof( gTracerColors[0] ))
 			{
 				p->color = TRACER_COLORINDEX_DEFAULT;
@@ -249,17 +461,8 @@ void GAME_EXPORT CL_DrawTracers( double frametime, particle_t *cl_active_tracers
 			// TriColor4ub( color.r, color.g, color.b, p->packedColor );
 			_TriColor4f( 1.0f * alpha / 255 / 255 * color.r, 1.0f * alpha / 255 / 255 * color.g, 1.0f * alpha / 255 / 255 * color.b, 1.0f );
 
-
-			TriBegin( TRI_QUADS );
-			TriTexCoord2f( 0.0f, 0.8f );
-			TriVertex3fv( verts[2] );
-			TriTexCoord2f( 1.0f, 0.8f );
-			TriVertex3fv( verts[3] );
-			TriTexCoord2f( 1.0f, 0.0f );
-			TriVertex3fv( verts[1] );
-			TriTexCoord2f( 0.0f, 0.0f );
-			TriVertex3fv( verts[0] );
-			TriEnd();
+			if( !splat || !R_DrawTracerSplat( start, end, gTracerSize[p->type] ))
+				R_DrawTracerQuad( start, end, delta, gTracerSize[p->type] );
 		}
 
 		// evaluate position
@@ -308,3 +511,81 @@ void GAME_EXPORT CL_DrawParticlesExternal( const ref_viewpass_t *rvp, qboolean t
 	// restore internal state
 	RI = oldRI;
 }
+
+/*
+===============
+R_ParticleBench_f
+
+particlebench [count]
+
+draw a fixed particle field into the software framebuffer
+through the splat and the triangle paths and compare timings
+===============
+*/
+void R_ParticleBench_f( void )
+{
+	const int passes = 16;
+	vec3_t    *field;
+	int       count = 4096, side, pass, i;
+	double    start, splat, quad;
+
+	if( ENGINE_GET_PARM( PARM_CONNSTATE ) != ca_active )
+		return;
+
+	if( gEngfuncs.Cmd_Argc() > 1 )
+		count = bound( 1, Q_atoi( gEngfuncs.Cmd_Argv( 1 )), 65536 );
+
+	field = Mem_Malloc( r_temppool, sizeof( *field ) * count );
+	side = (int)sqrt( count ) + 1;
+
+	// square grid facing the viewer, split into a few depth layers
+	// so both near and far size buckets get exercised
+	for( i = 0; i < count; i++ )
+	{
+		float x = (( i % side ) - side * 0.5f ) * 2.0f;
+		float y = (( i / side ) - side * 0.5f ) * 2.0f;
+		float z = 64.0f + ( i & 7 ) * 64.0f;
+
+		VectorMA( RI.vieworg, z, RI.vforward, field[i] );
+		VectorMA( field[i], x * z / 256.0f, RI.vright, field[i] );
+		VectorMA( field[i], y * z / 256.0f, RI.vup, field[i] );
+	}
+
+	R_SetUpWorldTransform();
+	GL_SetRenderMode( kRenderTransAdd );
+	GL_Bind( XASH_TEXTURE0, tr.particleTexture );
+
+	// nothing should occlude the field, next frame rebuilds the z-buffer anyway
+	memset( d_pzbuffer, 0, d_zrowbytes * vid.height );
+
+	start = gEngfuncs.pfnTime();
+	for( pass = 0; pass < passes; pass++ )
+	{
+		for( i = 0; i < count; i++ )
+		{
+			color24 color = tr.palette[i & 255];
+			_TriColor4f( color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, 1.0f );
+			R_DrawSingleParticle( field[i], 1.0f + ( i & 7 ) * 0.25f, true );
+		}
+	}
+	splat = gEngfuncs.pfnTime() - start;
+
+	start = gEngfuncs.pfnTime();
+	for( pass = 0; pass < passes; pass++ )
+	{
+		for( i = 0; i < count; i++ )
+		{
+			color24 color = tr.palette[i & 255];
+			_TriColor4f( color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, 1.0f );
+			R_DrawSingleParticle( field[i], 1.0f + ( i & 7 ) * 0.25f, false );
+		}
+	}
+	quad = gEngfuncs.pfnTime() - start;
+
+	GL_SetRenderMode( kRenderNormal );
+	Mem_Free( field );
+
+	gEngfuncs.Con_Printf( "%i particles x %i passes\n", count, passes );
+	gEngfuncs.Con_Printf( "splat:     %.3f ms (%.1f ns per particle)\n", splat * 1000.0, splat * 1e9 / ( count * passes ));
+	gEngfuncs.Con_Printf( "triangles: %.3f ms (%.1f ns per particle)\n", quad * 1000.0, quad * 1e9 / ( count * passes ));
+}
@@ -25,21 +25,59 @@ GNU General Public License for more details.
 #endif
 #include "const.h"
 #include "com_model.h"
+#include "xash3d_mathlib.h"
 #include "crtlib.h"
 #include "studio.h"
+#include "mdldec.h"
 #include "qc.h"
 #include "smd.h"
 #include "texture.h"
 #include "utils.h"
 #include "version.h"
 #include "settings.h"
-#include "mdldec.h"
 
-char		  destdir[MAX_SYSPATH];
-char		  modelfile[MAX_SYSPATH];
-studiohdr_t	 *model_hdr;
-studiohdr_t	 *texture_hdr;
-studiohdr_t	**anim_hdr;
+#if !XASH_WIN32
+#include <pthread.h>
+#define mutex_create( x )     pthread_mutex_init( &( x ), NULL )
+#define mutex_destroy( x )    pthread_mutex_destroy( &( x ))
+#define mutex_lock( x )       pthread_mutex_lock( &( x ))
+#define mutex_unlock( x )     pthread_mutex_unlock( &( x ))
+#define create_thread( thread, pfn ) !pthread_create( &( thread ), NULL, ( pfn ), NULL )
+#define join_thread( x )      pthread_join(( x ), NULL )
+typedef pthread_mutex_t mutex_t;
+typedef pthread_t thread_t;
+#else // WIN32
+#define mutex_create( x )   InitializeCriticalSection( &( x ))
+#define mutex_destroy( x )  DeleteCriticalSection( &( x ))
+#define mutex_lock( x )     EnterCriticalSection( &( x ))
+#define mutex_unlock( x )   LeaveCriticalSection( &( x ))
+#define create_thread( thread, pfn ) (( thread ) = CreateThread( NULL, 0, ( pfn ), NULL, 0, NULL ))
+#define join_thread( x )    ( WaitForSingleObject(( x ), INFINITE ), CloseHandle(( x )))
+typedef CRITICAL_SECTION mutex_t;
+typedef HANDLE thread_t;
+#endif // !XASH_WIN32
+
+#define MAX_BATCH_THREADS	64
+
+typedef struct mdljob_s
+{
+	char		source[MAX_SYSPATH];
+	char		destdir[MAX_SYSPATH];
+	qboolean	success;
+	double		time;
+} mdljob_t;
+
+static struct
+{
+	mdljob_t	*jobs;
+	int		 numjobs;
+	int		 maxjobs;
+	int		 nextjob;
+	int		 numdone;
+	const char	*targetdir;
+	mutex_t		 lock;
+} batch;
+
 int		  globalsettings;
 
 /*
@@ -77,13 +115,13 @@ static qboolean IsValidName( char *name )
 TextureNameFix
 ============
 */
-static void TextureNameFix( void )
+static void TextureNameFix( mdldec_t *ctx )
 {
 	int			 i, j, len, counter, protected = 0;
 	qboolean		 hasduplicates = false;
-	mstudiotexture_t	*texture = (mstudiotexture_t *)( (byte *)texture_hdr + texture_hdr->textureindex ), *texture1;
+	mstudiotexture_t	*texture = (mstudiotexture_t *)( (byte *)ctx->texture_hdr + ctx->texture_hdr->textureindex ), *texture1;
 
-	for( i = 0; i < texture_hdr->numtextures; ++i, ++texture )
+	for( i = 0; i < ctx->texture_hdr->numtextures; ++i, ++texture )
 	{
 		ExtractFileName( texture->name, sizeof( texture->name ));
 
@@ -94,13 +132,13 @@ static void TextureNameFix( void )
 
 	texture -= i;
 
-	for( i = 0; i < texture_hdr->numtextures; ++i, ++texture )
+	for( i = 0; i < ctx->texture_hdr->numtextures; ++i, ++texture )
 	{
 		counter = 0;
 
-		texture1 = (mstudiotexture_t *)( (byte *)texture_hdr + texture_hdr->textureindex );
+		texture1 = (mstudiotexture_t *)( (byte *)ctx->texture_hdr + ctx->texture_hdr->textureindex );
 
-		for( j = 0; j < texture_hdr->numtextures; ++j, ++texture1 )
+		for( j = 0; j < ctx->texture_hdr->numtextures; ++j, ++texture1 )
 		{
 			if( j != i && !Q_strncmp( texture1->name, texture->name, sizeof( texture1->name)))
 			{
@@ -131,21 +169,21 @@ static void TextureNameFix( void )
 BodypartNameFix
 ============
 */
-static void BodypartNameFix( void )
+static void BodypartNameFix( mdldec_t *ctx )
 {
 	int			 i, j, k, l, len, counter, protected = 0, protected_models = 0;
 	qboolean		 hasduplicates = false;
-	mstudiobodyparts_t	*bodypart = (mstudiobodyparts_t *)( (byte *)model_hdr + model_hdr->bodypartindex );
+	mstudiobodyparts_t	*bodypart = (mstudiobodyparts_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->bodypartindex );
 	mstudiobodyparts_t	*bodypart1;
 	mstudiomodel_t		*model, *model1;
 
-	for( i = 0; i < model_hdr->numbodyparts; ++i, ++bodypart )
+	for( i = 0; i < ctx->model_hdr->numbodyparts; ++i, ++bodypart )
 	{
 		ExtractFileName( bodypart->name, sizeof( bodypart->name ));
 		if( !IsValidName( bodypart->name ))
 			Q_snprintf( bodypart->name, sizeof( bodypart->name ), "MDLDEC_Bodypart%i", ++protected );
 
-		model = (mstudiomodel_t *)( (byte *)model_hdr + bodypart->modelindex );
+		model = (mstudiomodel_t *)( (byte *)ctx->model_hdr + bodypart->modelindex );
 
 		for( j = 0; j < bodypart->nummodels; ++j, ++model )
 		{
@@ -158,19 +196,19 @@ static void BodypartNameFix( void )
 
 	bodypart -= i;
 
-	for( i = 0; i < model_hdr->numbodyparts; ++i, ++bodypart )
+	for( i = 0; i < ctx->model_hdr->numbodyparts; ++i, ++bodypart )
 	{
-		model = (mstudiomodel_t *)( (byte *)model_hdr + bodypart->modelindex );
+		model = (mstudiomodel_t *)( (byte *)ctx->model_hdr + bodypart->modelindex );
 
 		for( j = 0; j < bodypart->nummodels; ++j, ++model )
 		{
 			counter = 0;
 
-			bodypart1 = (mstudiobodyparts_t *)( (byte *)model_hdr + model_hdr->bodypartindex );
+			bodypart1 = (mstudiobodyparts_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->bodypartindex );
 
-			for( k = 0; k < model_hdr->numbodyparts; ++k, ++bodypart1 )
+			for( k = 0; k < ctx->model_hdr->numbodyparts; ++k, ++bodypart1 )
 			{
-				model1 = (mstudiomodel_t *)( (byte *)model_hdr + bodypart1->modelindex );
+				model1 = (mstudiomodel_t *)( (byte *)ctx->model_hdr + bodypart1->modelindex );
 
 				for( l = 0; l < bodypart1->nummodels; ++l, ++model1 )
 				{
@@ -208,13 +246,13 @@ static void BodypartNameFix( void )
 SequenceNameFix
 ============
 */
-static void SequenceNameFix( void )
+static void SequenceNameFix( mdldec_t *ctx )
 {
 	int			 i, j, len, counter, protected = 0;
 	qboolean		 hasduplicates = false;
-	mstudioseqdesc_t	*seqdesc = (mstudioseqdesc_t *)( (byte *)model_hdr + model_hdr->seqindex ), *seqdesc1;
+	mstudioseqdesc_t	*seqdesc = (mstudioseqdesc_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->seqindex ), *seqdesc1;
 
-	for( i = 0; i < model_hdr->numseq; ++i, ++seqdesc )
+	for( i = 0; i < ctx->model_hdr->numseq; ++i, ++seqdesc )
 	{
 		ExtractFileName( seqdesc->label, sizeof( seqdesc->label ));
 		COM_StripExtension( seqdesc->label );
@@ -224,13 +262,13 @@ static void SequenceNameFix( void )
 
 	seqdesc -= i;
 
-	for( i = 0; i < model_hdr->numseq; ++i, ++seqdesc )
+	for( i = 0; i < ctx->model_hdr->numseq; ++i, ++seqdesc )
 	{
 		counter = 0;
 
-		seqdesc1 = (mstudioseqdesc_t *)( (byte *)model_hdr + model_hdr->seqindex );
+		seqdesc1 = (mstudioseqdesc_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->seqindex );
 
-		for( j = 0; j < model_hdr->numseq; ++j, ++seqdesc1 )
+		for( j = 0; j < ctx->model_hdr->numseq; ++j, ++seqdesc1 )
 		{
 			if( j != i && !Q_strncmp( seqdesc1->label, seqdesc->label, sizeof( seqdesc1->label )))
 			{
@@ -261,12 +299,12 @@ static void SequenceNameFix( void )
 BoneNameFix
 ============
 */
-static void BoneNameFix( void )
+static void BoneNameFix( mdldec_t *ctx )
 {
 	int		 i, protected = 0;
-	mstudiobone_t	*bone = (mstudiobone_t *)( (byte *)model_hdr + model_hdr->boneindex );
+	mstudiobone_t	*bone = (mstudiobone_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->boneindex );
 
-	for( i = 0; i < model_hdr->numbones; ++i, ++bone )
+	for( i = 0; i < ctx->model_hdr->numbones; ++i, ++bone )
 	{
 		bone->name[sizeof( bone->name ) - 1] = '\0';
 
@@ -283,7 +321,7 @@ static void BoneNameFix( void )
 LoadMDL
 ============
 */
-static qboolean LoadMDL( const char *modelname )
+static qboolean LoadMDL( mdldec_t *ctx, const char *modelname )
 {
 	int		 i;
 	size_t		 len;
@@ -318,9 +356,9 @@ static qboolean LoadMDL( const char *modelname )
 		return false;
 	}
 
-	model_hdr = (studiohdr_t *)LoadFile( modelname, &filesize );
+	ctx->model_hdr = (studiohdr_t *)LoadFile( modelname, &filesize );
 
-	if( !model_hdr )
+	if( !ctx->model_hdr )
 	{
 		LogPrintf( "ERROR: Can't open %s.", modelname );
 		return false;
@@ -332,7 +370,7 @@ static qboolean LoadMDL( const char *modelname )
 		return false;
 	}
 
-	if( filesize != model_hdr->length )
+	if( filesize != ctx->model_hdr->length )
 	{
 		// Some bad studio model compiler don't write file length
 		if( globalsettings & SETTINGS_NOVALIDATION )
@@ -344,9 +382,9 @@ static qboolean LoadMDL( const char *modelname )
 		}
 	}
 
-	if( memcmp( &model_hdr->ident, id_mdlhdr, sizeof( id_mdlhdr ) ) )
+	if( memcmp( &ctx->model_hdr->ident, id_mdlhdr, sizeof( id_mdlhdr ) ) )
 	{
-		if( !memcmp( &model_hdr->ident, id_seqhdr, sizeof( id_seqhdr ) ) )
+		if( !memcmp( &ctx->model_hdr->ident, id_seqhdr, sizeof( id_seqhdr ) ) )
 			LogPrintf( "ERROR: %s is not a main HL model file.", modelname );
 		else
 			LogPrintf( "ERROR: %s is not a valid HL model file.", modelname );
@@ -354,47 +392,47 @@ static qboolean LoadMDL( const char *modelname )
 		return false;
 	}
 
-	if( model_hdr->version != STUDIO_VERSION )
+	if( ctx->model_hdr->version != STUDIO_VERSION )
 	{
-		LogPrintf( "ERROR: %s has unknown Studio MDL format version %d.", modelname, model_hdr->version );
+		LogPrintf( "ERROR: %s has unknown Studio MDL format version %d.", modelname, ctx->model_hdr->version );
 		return false;
 	}
 
-	if( !model_hdr->numbodyparts )
+	if( !ctx->model_hdr->numbodyparts )
 	{
 		LogPrintf( "ERROR: %s is not a main HL model file.", modelname );
 		return false;
 	}
 
-	if( destdir[0] != '\0' )
+	if( ctx->destdir[0] != '\0' )
 	{
-		if( !MakeFullPath( destdir ))
+		if( !MakeFullPath( ctx->destdir ))
 			return false;
 	}
 	else
-		COM_ExtractFilePath( modelname, destdir );
+		COM_ExtractFilePath( modelname, ctx->destdir );
 
-	if( destdir[0] != '\0' )
-		COM_PathSlashFix( destdir );
+	if( ctx->destdir[0] != '\0' )
+		COM_PathSlashFix( ctx->destdir );
 
 	len -= ( sizeof( ".mdl" ) - 1 ); // path length without extension
 
-	if( !model_hdr->numtextures )
+	if( !ctx->model_hdr->numtextures )
 	{
 		Q_strncpy( texturename, modelname, sizeof( texturename ));
 		Q_strncpy( &texturename[len], "t.mdl", sizeof( texturename ) - len );
 
-		texture_hdr = (studiohdr_t *)LoadFile( texturename, &filesize );
+		ctx->texture_hdr = (studiohdr_t *)LoadFile( texturename, &filesize );
 
-		if( !texture_hdr )
+		if( !ctx->texture_hdr )
 		{
 #if !XASH_WIN32
 			// dirty hack for casesensetive filesystems
 			texturename[len] = 'T';
 
-			texture_hdr = (studiohdr_t *)LoadFile( texturename, &filesize );
+			ctx->texture_hdr = (studiohdr_t *)LoadFile( texturename, &filesize );
 
-			if( !texture_hdr )
+			if( !ctx->texture_hdr )
 #endif
 			{
 				LogPrintf( "ERROR: Can't open external textures file %s.", texturename );
@@ -408,7 +446,7 @@ static qboolean LoadMDL( const char *modelname )
 			return false;
 		}
 
-		if( filesize != texture_hdr->length )
+		if( filesize != ctx->texture_hdr->length )
 		{
 			// Some bad studio model compiler don't write file length
 			if( globalsettings & SETTINGS_NOVALIDATION )
@@ -420,37 +458,37 @@ static qboolean LoadMDL( const char *modelname )
 			}
 		}
 
-		if( memcmp( &texture_hdr->ident, id_mdlhdr, sizeof( id_mdlhdr ) )
-		    || !texture_hdr->numtextures )
+		if( memcmp( &ctx->texture_hdr->ident, id_mdlhdr, sizeof( id_mdlhdr ) )
+		    || !ctx->texture_hdr->numtextures )
 		{
 			LogPrintf( "ERROR: %s is not a valid external textures file.", texturename );
 			return false;
 		}
 	}
 	else
-		texture_hdr = model_hdr;
+		ctx->texture_hdr = ctx->model_hdr;
 
-	anim_hdr = malloc( sizeof( studiohdr_t* ) * model_hdr->numseqgroups );
+	ctx->anim_hdr = calloc( ctx->model_hdr->numseqgroups, sizeof( studiohdr_t* ));
 
-	if( !anim_hdr )
+	if( !ctx->anim_hdr )
 	{
 		LogPutS( "ERROR: Couldn't allocate memory for sequences." );
 		return false;
 	}
 
-	anim_hdr[0] = model_hdr;
+	ctx->anim_hdr[0] = ctx->model_hdr;
 
-	if( model_hdr->numseqgroups > 1 )
+	if( ctx->model_hdr->numseqgroups > 1 )
 	{
 		Q_strncpy( seqgroupname, modelname, sizeof( seqgroupname ));
 
-		for( i = 1; i < model_hdr->numseqgroups; i++ )
+		for( i = 1; i < ctx->model_hdr->numseqgroups; i++ )
 		{
 			Q_snprintf( &seqgroupname[len], sizeof( seqgroupname ) - len, "%02d.mdl", i );
 
-			anim_hdr[i] = (studiohdr_t *)LoadFile( seqgroupname, &filesize );
+			ctx->anim_hdr[i] = (studiohdr_t *)LoadFile( seqgroupname, &filesize );
 
-			if( !anim_hdr[i] )
+			if( !ctx->anim_hdr[i] )
 			{
 				LogPrintf( "ERROR: Can't open sequence file %s.", seqgroupname );
 				return false;
@@ -462,7 +500,7 @@ static qboolean LoadMDL( const char *modelname )
 				return false;
 			}
 
-			if( filesize != anim_hdr[i]->length )
+			if( filesize != ctx->anim_hdr[i]->length )
 			{
 				// Some bad studio model compiler don't write file length
 				if( globalsettings & SETTINGS_NOVALIDATION )
@@ -474,7 +512,7 @@ static qboolean LoadMDL( const char *modelname )
 				}
 			}
 
-			if( memcmp( &anim_hdr[i]->ident, id_seqhdr, sizeof( id_seqhdr ) ) )
+			if( memcmp( &ctx->anim_hdr[i]->ident, id_seqhdr, sizeof( id_seqhdr ) ) )
 			{
 				LogPrintf( "ERROR: %s is not a valid sequence file.", seqgroupname );
 				return false;
@@ -482,31 +520,376 @@ static qboolean LoadMDL( const char *modelname )
 		}
 	}
 
-	COM_FileBase( modelname, modelfile, sizeof( modelfile ));
+	COM_FileBase( modelname, ctx->modelfile, sizeof( ctx->modelfile ));
 
 	// Some validation checks was found in mdldec-golang by Psycrow101
-	if( model_hdr->numhitboxes > model_hdr->numbones * ( MAXSTUDIOSRCBONES / MAXSTUDIOBONES ))
+	if( ctx->model_hdr->numhitboxes > ctx->model_hdr->numbones * ( MAXSTUDIOSRCBONES / MAXSTUDIOBONES ))
 	{
-		LogPrintf( "WARNING: Invalid hitboxes number %d.", model_hdr->numhitboxes );
-		model_hdr->numhitboxes = 0;
+		LogPrintf( "WARNING: Invalid hitboxes number %d.", ctx->model_hdr->numhitboxes );
+		ctx->model_hdr->numhitboxes = 0;
 	}
-	else if( model_hdr->hitboxindex + model_hdr->numhitboxes * ( sizeof( mstudiobbox_t ) + sizeof( mstudiohitboxset_t )) > model_hdr->length )
+	else if( ctx->model_hdr->hitboxindex + ctx->model_hdr->numhitboxes * ( sizeof( mstudiobbox_t ) + sizeof( mstudiohitboxset_t )) > ctx->model_hdr->length )
 	{
-		LogPrintf( "WARNING: Invalid hitboxes offset %d.", model_hdr->hitboxindex );
-		model_hdr->numhitboxes = 0;
+		LogPrintf( "WARNING: Invalid hitboxes offset %d.", ctx->model_hdr->hitboxindex );
+		ctx->model_hdr->numhitboxes = 0;
 	}
 
-	TextureNameFix();
+	TextureNameFix( ctx );
 
-	BodypartNameFix();
+	BodypartNameFix( ctx );
 
-	SequenceNameFix();
+	SequenceNameFix( ctx );
 
-	BoneNameFix();
+	BoneNameFix( ctx );
 
 	return true;
 }
 
+/*
+============
+FreeMDL
+============
+*/
+static void FreeMDL( mdldec_t *ctx )
+{
+	int	i;
+
+	if( ctx->anim_hdr )
+	{
+		for( i = 1; i < ctx->model_hdr->numseqgroups; i++ )
+			free( ctx->anim_hdr[i] );
+
+		free( ctx->anim_hdr );
+	}
+
+	if( ctx->texture_hdr != ctx->model_hdr )
+		free( ctx->texture_hdr );
+
+	free( ctx->model_hdr );
+
+	ctx->model_hdr = ctx->texture_hdr = NULL;
+	ctx->anim_hdr = NULL;
+}
+
+/*
+============
+DecompileMDL
+============
+*/
+static qboolean DecompileMDL( mdldec_t *ctx, const char *modelname )
+{
+	qboolean	success = LoadMDL( ctx, modelname );
+
+	if( success )
+	{
+		WriteQCScript( ctx );
+		WriteSMD( ctx );
+		WriteTextures( ctx );
+	}
+
+	FreeMDL( ctx );
+
+	return success;
+}
+
+/*
+============
+IsMainModel
+
+Directory scans skip external texture and sequence group files.
+============
+*/
+static qboolean IsMainModel( const char *filename )
+{
+	FILE		*fp;
+	studiohdr_t	 hdr;
+	qboolean	 ret = false;
+	const char	 id_mdlhdr[] = {'I', 'D', 'S', 'T'};
+
+	if( Q_stricmp( COM_FileExtension( filename ), "mdl" ))
+		return false;
+
+	fp = fopen( filename, "rb" );
+
+	if( !fp )
+		return false;
+
+	if( fread( &hdr, sizeof( hdr ), 1, fp ) == 1 )
+		ret = !memcmp( &hdr.ident, id_mdlhdr, sizeof( id_mdlhdr )) && hdr.numbodyparts > 0;
+
+	fclose( fp );
+
+	return ret;
+}
+
+/*
+============
+AddBatchJob
+
+reldir is a path relative to the target directory, empty or ending with slash.
+============
+*/
+static qboolean AddBatchJob( const char *source, const char *reldir )
+{
+	mdljob_t	*job;
+	char		 dir[MAX_SYSPATH];
+	char		 name[MAX_SYSPATH];
+	int		 len;
+
+	if( batch.numjobs == batch.maxjobs )
+	{
+		batch.maxjobs = batch.maxjobs ? batch.maxjobs * 2 : 64;
+		batch.jobs = realloc( batch.jobs, sizeof( mdljob_t ) * batch.maxjobs );
+
+		if( !batch.jobs )
+		{
+			LogPutS( "ERROR: Couldn't allocate memory for batch jobs." );
+			return false;
+		}
+	}
+
+	job = &batch.jobs[batch.numjobs];
+	memset( job, 0, sizeof( *job ));
+
+	COM_FileBase( source, name, sizeof( name ));
+
+	// every model gets own directory, so same named SMDs don't collide
+	if( batch.targetdir )
+		len = Q_snprintf( job->destdir, sizeof( job->destdir ), "%s/%s%s/", batch.targetdir, reldir, name );
+	else
+	{
+		COM_ExtractFilePath( source, dir );
+		len = Q_snprintf( job->destdir, sizeof( job->destdir ), dir[0] ? "%s/%s/" : "%s%s/", dir, name );
+	}
+
+	if( len == -1 || Q_strlen( job->destdir ) > MAX_SYSPATH - 2 || Q_strlen( source ) > MAX_SYSPATH - 3 )
+	{
+		LogPrintf( "ERROR: Path of %s is too long, skipped.", source );
+		return false;
+	}
+
+	Q_strncpy( job->source, source, sizeof( job->source ));
+	batch.numjobs++;
+
+	return true;
+}
+
+/*
+============
+AddBatchFile
+
+ListDirectory callback, userdata is the scanned root.
+============
+*/
+static void AddBatchFile( const char *filename, void *userdata )
+{
+	const char	*root = userdata;
+	char		 reldir[MAX_SYSPATH];
+	size_t		 len = Q_strlen( root );
+
+	if( !IsMainModel( filename ))
+		return;
+
+	// keep the layout under root in the target directory
+	COM_ExtractFilePath( filename + len + 1, reldir );
+
+	if( reldir[0] != '\0' )
+		COM_PathSlashFix( reldir );
+
+	AddBatchJob( filename, reldir );
+}
+
+/*
+============
+AddBatchSource
+
+Source is a model, a directory to scan or a list file with one source per line.
+============
+*/
+static qboolean AddBatchSource( const char *source, qboolean fromlist )
+{
+	FILE	*fp;
+	char	 line[MAX_SYSPATH];
+	char	*p;
+	size_t	 len;
+
+	if( IsDirectory( source ))
+	{
+		Q_strncpy( line, source, sizeof( line ));
+
+		// strip trailing slashes so relative paths are computed right
+		for( len = Q_strlen( line ); len > 1 && ( line[len - 1] == '/' || line[len - 1] == '\\' ); len-- )
+			line[len - 1] = '\0';
+
+		if( !ListDirectory( line, AddBatchFile, line ))
+		{
+			LogPrintf( "ERROR: Couldn't read directory %s.", source );
+			return false;
+		}
+
+		return true;
+	}
+
+	if( fromlist || !Q_stricmp( COM_FileExtension( source ), "mdl" ))
+		return AddBatchJob( source, "" );
+
+	fp = fopen( source, "r" );
+
+	if( !fp )
+	{
+		LogPrintf( "ERROR: Can't open %s.", source );
+		return false;
+	}
+
+	while( fgets( line, sizeof( line ), fp ))
+	{
+		COM_RemoveLineFeed( line, sizeof( line ));
+
+		for( p = line; *p == ' ' || *p == '\t'; p++ );
+
+		if( *p == '\0' || *p == '#' || ( p[0] == '/' && p[1] == '/' ))
+			continue;
+
+		AddBatchSource( p, true );
+	}
+
+	fclose( fp );
+
+	return true;
+}
+
+/*
+============
+BatchJobCompare
+============
+*/
+static int BatchJobCompare( const void *a, const void *b )
+{
+	return Q_strcmp( ((const mdljob_t *)a)->source, ((const mdljob_t *)b)->source );
+}
+
+/*
+============
+BatchWorker
+
+Take jobs until queue is empty. Log of every job is printed at once.
+============
+*/
+static void BatchWorker( void )
+{
+	mdljob_t	*job;
+	mdldec_t	 ctx;
+	logbuffer_t	 log;
+	double		 start;
+	int		 i;
+
+	memset( &log, 0, sizeof( log ));
+
+	while( 1 )
+	{
+		mutex_lock( batch.lock );
+		i = batch.nextjob++;
+		mutex_unlock( batch.lock );
+
+		if( i >= batch.numjobs )
+			break;
+
+		job = &batch.jobs[i];
+
+		memset( &ctx, 0, sizeof( ctx ));
+		Q_strncpy( ctx.destdir, job->destdir, sizeof( ctx.destdir ));
+
+		LogSetBuffer( &log );
+		start = GetTimeSeconds();
+		job->success = DecompileMDL( &ctx, job->source );
+		job->time = GetTimeSeconds() - start;
+		LogSetBuffer( NULL );
+
+		mutex_lock( batch.lock );
+		batch.numdone++;
+		LogFlushBuffer( &log );
+		LogPrintf( "[%i/%i] %s: %s, %.1f ms.", batch.numdone, batch.numjobs, job->source,
+			job->success ? "OK" : "FAILED", job->time * 1000.0 );
+		mutex_unlock( batch.lock );
+	}
+}
+
+#if !XASH_WIN32
+static void *BatchThreadStart( void *unused )
+{
+	BatchWorker();
+	return NULL;
+}
+#else
+DWORD WINAPI BatchThreadStart( LPVOID unused )
+{
+	BatchWorker();
+	return 0;
+}
+#endif
+
+/*
+============
+RunBatch
+============
+*/
+static int RunBatch( int numthreads )
+{
+	thread_t	 threads[MAX_BATCH_THREADS];
+	double		 start, jobtime = 0.0;
+	int		 i, started = 0, failed = 0;
+
+	if( !batch.numjobs )
+	{
+		LogPutS( "ERROR: No models found." );
+		return 1;
+	}
+
+	qsort( batch.jobs, batch.numjobs, sizeof( mdljob_t ), BatchJobCompare );
+
+	if( numthreads > batch.numjobs )
+		numthreads = batch.numjobs;
+
+	LogPrintf( "Decompiling %i model%s using %i thread%s.", batch.numjobs, batch.numjobs > 1 ? "s" : "",
+		numthreads, numthreads > 1 ? "s" : "" );
+
+	mutex_create( batch.lock );
+	start = GetTimeSeconds();
+
+	// the calling thread works too
+	for( i = 1; i < numthreads; i++ )
+	{
+		if( !create_thread( threads[started], BatchThreadStart ))
+			break;
+
+		started++;
+	}
+
+	BatchWorker();
+
+	for( i = 0; i < started; i++ )
+		join_thread( threads[i] );
+
+	start = GetTimeSeconds() - start;
+	mutex_destroy( batch.lock );
+
+	for( i = 0; i < batch.numjobs; i++ )
+	{
+		jobtime += batch.jobs[i].time;
+
+		if( !batch.jobs[i].success )
+			failed++;
+	}
+
+	LogPrintf( "Done: %i model%s, %i decompiled, %i failed.", batch.numjobs, batch.numjobs > 1 ? "s" : "",
+		batch.numjobs - failed, failed );
+	LogPrintf( "Time: %.2f s, %.2f s summed over models on %i thread%s.", start, jobtime, started + 1, started ? "s" : "" );
+
+	free( batch.jobs );
+
+	return failed ? 1 : 0;
+}
+
 /*
 ============
 ShowVersion
@@ -528,11 +911,16 @@ static void ShowHelp( const char *app_name )
 {
 	LogPrintf( "usage: %s [-ahlmtuVv] <source_file>", app_name );
 	LogPrintf( "       %s [-ahlmtuVv] <source_file> <target_directory>", app_name );
+	LogPrintf( "       %s [-ahlmtuVv] -b [-j threads] [-o target_directory] <source> [<source> ...]", app_name );
 	LogPutS( "\nnote:" );
 	LogPutS( "\tby default this decompiler aimed to support extended MDL10 format from XashXT/PrimeXT/Paranoia2." );
 	LogPutS( "\tif you use an old GoldSource studio model compiler you may be need to edit .qc-file after decompilation." );
 	LogPutS( "\noptions:" );
 	LogPutS( "\t-a\tplace files with animations to separate directory." );
+	LogPutS( "\t-b\tbatch mode, each source is a .mdl-file, a directory to scan or a list file with one source per line." );
+	LogPutS( "\t\tevery model is decompiled into own subdirectory of the target directory or of its own directory." );
+	LogPutS( "\t-j\tnumber of threads in batch mode, by default number of CPUs." );
+	LogPutS( "\t-o\ttarget directory for batch mode." );
 	LogPutS( "\t-l\tdo not output logs." );
 	LogPutS( "\t-m\tuse GoldSource-compatible motion types." );
 	LogPutS( "\t-t\tplace texture files to separate directory." );
@@ -544,13 +932,19 @@ static void ShowHelp( const char *app_name )
 
 int main( int argc, char *argv[] )
 {
-	int opt, ret = 0 ;
+	int		opt, ret = 0;
+	int		numthreads = 0;
+	qboolean	batchmode = false;
+	mdldec_t	ctx;
 
-	while( ( opt = getopt( argc, argv, "ahlmtuVv" )) != -1 )
+	while( ( opt = getopt( argc, argv, "abhj:lmo:tuVv" )) != -1 )
 	{
 		switch( opt )
 		{
 		case 'a': globalsettings |= SETTINGS_SEPARATEANIMSFOLDER; break;
+		case 'b': batchmode = true; break;
+		case 'j': numthreads = Q_atoi( optarg ); break;
+		case 'o': batch.targetdir = optarg; break;
 		case 't': globalsettings |= SETTINGS_SEPARATETEXTURESFOLDER; break;
 		case 'l': globalsettings |= SETTINGS_NOLOGS; break;
 		case 'm': globalsettings |= SETTINGS_LEGACYMOTION; break;
@@ -575,6 +969,35 @@ int main( int argc, char *argv[] )
 
 	argc -= (optind - 1);
 
+	if( batchmode )
+	{
+		if( argc == 1 )
+		{
+			ShowHelp( argv[0] );
+			ret = 2;
+			goto end;
+		}
+
+		if( numthreads <= 0 )
+			numthreads = GetProcessorCount();
+
+		numthreads = bound( 1, numthreads, MAX_BATCH_THREADS );
+
+		if( !LoadActivityList( argv[0] ))
+		{
+			ret = 1;
+			goto end;
+		}
+
+		for( ; argv[optind]; optind++ )
+			AddBatchSource( argv[optind], false );
+
+		ret = RunBatch( numthreads );
+		goto end;
+	}
+
+	memset( &ctx, 0, sizeof( ctx ));
+
 	if( argc == 1 )
 	{
 		ShowHelp( argv[0] );
@@ -590,19 +1013,15 @@ int main( int argc, char *argv[] )
 			goto end;
 		}
 
-		Q_strncpy( destdir, argv[optind + 1], sizeof( destdir ));
+		Q_strncpy( ctx.destdir, argv[optind + 1], sizeof( ctx.destdir ));
 	}
 
-	if( !(LoadActivityList( argv[0] ) && LoadMDL( argv[optind] )))
+	if( !(LoadActivityList( argv[0] ) && DecompileMDL( &ctx, argv[optind] )))
 	{
 		ret = 1;
 		goto end;
 	}
 
-	WriteQCScript();
-	WriteSMD();
-	WriteTextures();
-
 	LogPutS( "Done." );
 
 end:
@@ -610,4 +1029,3 @@ int main( int argc, char *argv[] )
 
 	return ret;
 }
-
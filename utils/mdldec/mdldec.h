@@ -16,11 +16,17 @@ GNU General Public License for more details.
 #ifndef MDLDEC_H
 #define MDLDEC_H
 
-extern char		  destdir[MAX_SYSPATH];
-extern char		  modelfile[MAX_SYSPATH];
-extern studiohdr_t	 *model_hdr;
-extern studiohdr_t	 *texture_hdr;
-extern studiohdr_t	**anim_hdr;
+// state of a single model decompilation, batch mode runs one per worker
+typedef struct mdldec_s
+{
+	char		  destdir[MAX_SYSPATH];
+	char		  modelfile[MAX_SYSPATH];
+	studiohdr_t	 *model_hdr;
+	studiohdr_t	 *texture_hdr;
+	studiohdr_t	**anim_hdr;
+	matrix3x4	 *bonetransform;
+	matrix3x4	 *worldtransform;
+} mdldec_t;
 
 #endif // MDLDEC_H
 
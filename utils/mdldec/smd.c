@@ -26,17 +26,14 @@ GNU General Public License for more details.
 #include "settings.h"
 #include "smd.h"
 
-static matrix3x4	*bonetransform;
-static matrix3x4	*worldtransform;
-
 /*
 ============
 CreateBoneTransformMatrices
 ============
 */
-static qboolean CreateBoneTransformMatrices( matrix3x4 **matrix )
+static qboolean CreateBoneTransformMatrices( mdldec_t *ctx, matrix3x4 **matrix )
 {
-	*matrix = calloc( model_hdr->numbones, sizeof( matrix3x4 ) );
+	*matrix = calloc( ctx->model_hdr->numbones, sizeof( matrix3x4 ) );
 
 	if( !*matrix )
 	{
@@ -52,25 +49,25 @@ static qboolean CreateBoneTransformMatrices( matrix3x4 **matrix )
 FillBoneTransformMatrices
 ============
 */
-static void FillBoneTransformMatrices( void )
+static void FillBoneTransformMatrices( mdldec_t *ctx )
 {
 	int		 i;
-	mstudiobone_t	*bone = (mstudiobone_t *)( (byte *)model_hdr + model_hdr->boneindex );
+	mstudiobone_t	*bone = (mstudiobone_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->boneindex );
 	matrix3x4	 bonematrix;
 	vec4_t		 q;
 
-	for( i = 0; i < model_hdr->numbones; ++i, ++bone )
+	for( i = 0; i < ctx->model_hdr->numbones; ++i, ++bone )
 	{
 		AngleQuaternion( &bone->value[3], q, true );
 		Matrix3x4_FromOriginQuat( bonematrix, q, bone->value );
 
 		if( bone->parent == -1 )
 		{
-			Matrix3x4_Copy( bonetransform[i], bonematrix );
+			Matrix3x4_Copy( ctx->bonetransform[i], bonematrix );
 			continue;
 		}
 
-		Matrix3x4_ConcatTransforms( bonetransform[i], bonetransform[bone->parent], bonematrix );
+		Matrix3x4_ConcatTransforms( ctx->bonetransform[i], ctx->bonetransform[bone->parent], bonematrix );
 	}
 }
 
@@ -79,13 +76,13 @@ static void FillBoneTransformMatrices( void )
 FillWorldTransformMatrices
 ============
 */
-static void FillWorldTransformMatrices( void )
+static void FillWorldTransformMatrices( mdldec_t *ctx )
 {
 	int			 i;
-	mstudioboneinfo_t	*boneinfo = (mstudioboneinfo_t *)( (byte *)model_hdr + model_hdr->boneindex + model_hdr->numbones * sizeof( mstudiobone_t ) );
+	mstudioboneinfo_t	*boneinfo = (mstudioboneinfo_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->boneindex + ctx->model_hdr->numbones * sizeof( mstudiobone_t ) );
 
-	for( i = 0; i < model_hdr->numbones; ++i, ++boneinfo )
-		Matrix3x4_ConcatTransforms( worldtransform[i], bonetransform[i], boneinfo->poseToBone );
+	for( i = 0; i < ctx->model_hdr->numbones; ++i, ++boneinfo )
+		Matrix3x4_ConcatTransforms( ctx->worldtransform[i], ctx->bonetransform[i], boneinfo->poseToBone );
 }
 
 /*
@@ -177,14 +174,14 @@ static void CalcBonePosition( mstudioanim_t *anim, mstudiobone_t *bone, vec_t *m
 WriteNodes
 ============
 */
-static void WriteNodes( FILE *fp )
+static void WriteNodes( mdldec_t *ctx, FILE *fp )
 {
 	int		 i;
-	mstudiobone_t	*bone = (mstudiobone_t *)( (byte *)model_hdr + model_hdr->boneindex );
+	mstudiobone_t	*bone = (mstudiobone_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->boneindex );
 
 	fputs( "nodes\n", fp );
 
-	for( i = 0; i < model_hdr->numbones; ++i, ++bone )
+	for( i = 0; i < ctx->model_hdr->numbones; ++i, ++bone )
 		fprintf( fp, "%3i \"%s\" %i\n", i, bone->name, bone->parent );
 
 	fputs( "end\n", fp );
@@ -195,15 +192,15 @@ static void WriteNodes( FILE *fp )
 WriteSkeleton
 ============
 */
-static void WriteSkeleton( FILE *fp )
+static void WriteSkeleton( mdldec_t *ctx, FILE *fp )
 {
 	int		 i, j;
-	mstudiobone_t	*bone = (mstudiobone_t *)( (byte *)model_hdr + model_hdr->boneindex );
+	mstudiobone_t	*bone = (mstudiobone_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->boneindex );
 
 	fputs( "skeleton\n", fp );
 	fputs( "time 0\n", fp );
 
-	for( i = 0; i < model_hdr->numbones; ++i, ++bone )
+	for( i = 0; i < ctx->model_hdr->numbones; ++i, ++bone )
 	{
 		fprintf( fp, "%3i", i );
 
@@ -221,7 +218,7 @@ static void WriteSkeleton( FILE *fp )
 WriteTriangleInfo
 ============
 */
-static void WriteTriangleInfo( FILE *fp, mstudiomodel_t *model, mstudiotexture_t *texture, mstudiotrivert_t **triverts, qboolean isevenstrip )
+static void WriteTriangleInfo( mdldec_t *ctx, FILE *fp, mstudiomodel_t *model, mstudiotexture_t *texture, mstudiotrivert_t **triverts, qboolean isevenstrip )
 {
 	int			 i, j, k, l, index;
 	int			 vert_index;
@@ -239,10 +236,10 @@ static void WriteTriangleInfo( FILE *fp, mstudiomodel_t *model, mstudiotexture_t
 	mstudioboneweight_t	*studioboneweights;
 	char			 buffer[64];
 
-	vertbone    = ( (byte *)model_hdr + model->vertinfoindex );
-	studioverts = (vec3_t *)( (byte *)model_hdr + model->vertindex );
-	studionorms = (vec3_t *)( (byte *)model_hdr + model->normindex );
-	studioboneweights = (mstudioboneweight_t *)( (byte *)model_hdr + model->blendvertinfoindex );
+	vertbone    = ( (byte *)ctx->model_hdr + model->vertinfoindex );
+	studioverts = (vec3_t *)( (byte *)ctx->model_hdr + model->vertindex );
+	studionorms = (vec3_t *)( (byte *)ctx->model_hdr + model->normindex );
+	studioboneweights = (mstudioboneweight_t *)( (byte *)ctx->model_hdr + model->blendvertinfoindex );
 
 	Q_strncpy( buffer, texture->name, sizeof( buffer ));
 
@@ -258,7 +255,7 @@ static void WriteTriangleInfo( FILE *fp, mstudiomodel_t *model, mstudiotexture_t
 		norm_index = triverts[index]->normindex;
 		bone_index = vertbone[vert_index];
 
-		if( model_hdr->flags & STUDIO_HAS_BONEWEIGHTS )
+		if( ctx->model_hdr->flags & STUDIO_HAS_BONEWEIGHTS )
 		{
 			valid_bones = 0, totalweight = 0;
 			memset( skinmatrix, 0, sizeof( matrix3x4 ) );
@@ -269,7 +266,7 @@ static void WriteTriangleInfo( FILE *fp, mstudiomodel_t *model, mstudiotexture_t
 
 			for( j = 0; j < valid_bones; ++j )
 			{
-				Matrix3x4_Copy( bonematrix[j], worldtransform[studioboneweights[vert_index].bone[j]] );
+				Matrix3x4_Copy( bonematrix[j], ctx->worldtransform[studioboneweights[vert_index].bone[j]] );
 				weights[j] = studioboneweights[vert_index].weight[j] / 255.0f;
 				totalweight += weights[j];
 			}
@@ -287,7 +284,7 @@ static void WriteTriangleInfo( FILE *fp, mstudiomodel_t *model, mstudiotexture_t
 			pskinmatrix = &skinmatrix;
 		}
 		else
-			pskinmatrix = &bonetransform[bone_index];
+			pskinmatrix = &ctx->bonetransform[bone_index];
 
 		Matrix3x4_VectorTransform( *pskinmatrix, studioverts[vert_index], vert );
 		Matrix3x4_VectorRotate( *pskinmatrix, studionorms[norm_index], norm );
@@ -334,7 +331,7 @@ static void WriteTriangleInfo( FILE *fp, mstudiomodel_t *model, mstudiotexture_t
 		    norm[0], norm[1], norm[2],
 		    u, v );
 
-		if( model_hdr->flags & STUDIO_HAS_BONEWEIGHTS )
+		if( ctx->model_hdr->flags & STUDIO_HAS_BONEWEIGHTS )
 		{
 			fprintf( fp, " %d", valid_bones );
 
@@ -355,10 +352,10 @@ static void WriteTriangleInfo( FILE *fp, mstudiomodel_t *model, mstudiotexture_t
 WriteTriangles
 ============
 */
-static void WriteTriangles( FILE *fp, mstudiomodel_t *model )
+static void WriteTriangles( mdldec_t *ctx, FILE *fp, mstudiomodel_t *model )
 {
 	int			 i, j, k;
-	mstudiomesh_t		*mesh = (mstudiomesh_t *)( (byte *)model_hdr + model->meshindex );
+	mstudiomesh_t		*mesh = (mstudiomesh_t *)( (byte *)ctx->model_hdr + model->meshindex );
 	mstudiotexture_t	*texture;
 	mstudiotrivert_t	*triverts[3];
 	short			*tricmds;
@@ -367,8 +364,8 @@ static void WriteTriangles( FILE *fp, mstudiomodel_t *model )
 
 	for( i = 0; i < model->nummesh; ++i, ++mesh )
 	{
-		tricmds = (short *)( (byte *)model_hdr + mesh->triindex );
-		texture = (mstudiotexture_t *)( (byte *)texture_hdr + texture_hdr->textureindex ) + mesh->skinref;
+		tricmds = (short *)( (byte *)ctx->model_hdr + mesh->triindex );
+		texture = (mstudiotexture_t *)( (byte *)ctx->texture_hdr + ctx->texture_hdr->textureindex ) + mesh->skinref;
 
 		while( ( j = *( tricmds++ ) ) )
 		{
@@ -389,21 +386,21 @@ static void WriteTriangles( FILE *fp, mstudiomodel_t *model )
 					{
 						triverts[1] = (mstudiotrivert_t *)tricmds;
 
-						WriteTriangleInfo( fp, model, texture, triverts, true );
+						WriteTriangleInfo( ctx, fp, model, texture, triverts, true );
 					}
 					else if( k % 2 )
 					{
 						triverts[0] = triverts[2];
 						triverts[2] = (mstudiotrivert_t *)tricmds;
 
-						WriteTriangleInfo( fp, model, texture, triverts, false );
+						WriteTriangleInfo( ctx, fp, model, texture, triverts, false );
 					}
 					else
 					{
 						triverts[0] = triverts[1];
 						triverts[1] = (mstudiotrivert_t *)tricmds;
 
-						WriteTriangleInfo( fp, model, texture, triverts, true );
+						WriteTriangleInfo( ctx, fp, model, texture, triverts, true );
 					}
 				}
 			}
@@ -426,14 +423,14 @@ static void WriteTriangles( FILE *fp, mstudiomodel_t *model )
 					{
 						triverts[1] = (mstudiotrivert_t *)tricmds;
 
-						WriteTriangleInfo( fp, model, texture, triverts, false );
+						WriteTriangleInfo( ctx, fp, model, texture, triverts, false );
 					}
 					else
 					{
 						triverts[2] = triverts[1];
 						triverts[1] = (mstudiotrivert_t *)tricmds;
 
-						WriteTriangleInfo( fp, model, texture, triverts, false );
+						WriteTriangleInfo( ctx, fp, model, texture, triverts, false );
 					}
 				}
 			}
@@ -448,16 +445,16 @@ static void WriteTriangles( FILE *fp, mstudiomodel_t *model )
 WriteFrameInfo
 ============
 */
-static void WriteFrameInfo( FILE *fp, mstudioanim_t *anim, mstudioseqdesc_t *seqdesc, int frame )
+static void WriteFrameInfo( mdldec_t *ctx, FILE *fp, mstudioanim_t *anim, mstudioseqdesc_t *seqdesc, int frame )
 {
 	int			 i, j;
 	float			 scale;
 	vec_t			 motion[6]; // x, y, z, xr, yr, zr
-	mstudiobone_t		*bone = (mstudiobone_t *)( (byte *)model_hdr + model_hdr->boneindex );
+	mstudiobone_t		*bone = (mstudiobone_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->boneindex );
 
 	fprintf( fp, "time %i\n", frame );
 
-	for( i = 0; i < model_hdr->numbones; ++i, ++anim, ++bone )
+	for( i = 0; i < ctx->model_hdr->numbones; ++i, ++anim, ++bone )
 	{
 		CalcBonePosition( anim, bone, motion, frame );
 
@@ -489,18 +486,18 @@ static void WriteFrameInfo( FILE *fp, mstudioanim_t *anim, mstudioseqdesc_t *seq
 WriteAnimations
 ============
 */
-static void WriteAnimations( FILE *fp, mstudioseqdesc_t *seqdesc, int blend )
+static void WriteAnimations( mdldec_t *ctx, FILE *fp, mstudioseqdesc_t *seqdesc, int blend )
 {
 	int		 i;
 	mstudioanim_t	*anim;
 
 	fputs( "skeleton\n", fp );
 
-	anim = (mstudioanim_t *)( (byte *)anim_hdr[seqdesc->seqgroup] + seqdesc->animindex );
-	anim += blend * model_hdr->numbones;
+	anim = (mstudioanim_t *)( (byte *)ctx->anim_hdr[seqdesc->seqgroup] + seqdesc->animindex );
+	anim += blend * ctx->model_hdr->numbones;
 
 	for( i = 0; i < seqdesc->numframes; i++ )
-		WriteFrameInfo( fp, anim, seqdesc, i );
+		WriteFrameInfo( ctx, fp, anim, seqdesc, i );
 
 	fputs( "end\n", fp );
 }
@@ -510,7 +507,7 @@ static void WriteAnimations( FILE *fp, mstudioseqdesc_t *seqdesc, int blend )
 WriteReferences
 ============
 */
-static void WriteReferences( void )
+static void WriteReferences( mdldec_t *ctx )
 {
 	int			 i, j;
 	int			 len;
@@ -519,31 +516,31 @@ static void WriteReferences( void )
 	mstudiobodyparts_t	*bodypart;
 	char			 filename[MAX_SYSPATH];
 
-	if( !CreateBoneTransformMatrices( &bonetransform ) )
+	if( !CreateBoneTransformMatrices( ctx, &ctx->bonetransform ) )
 		return;
 
-	FillBoneTransformMatrices();
+	FillBoneTransformMatrices( ctx );
 
-	if( model_hdr->flags & STUDIO_HAS_BONEINFO )
+	if( ctx->model_hdr->flags & STUDIO_HAS_BONEINFO )
 	{
-		if( !CreateBoneTransformMatrices( &worldtransform ) )
+		if( !CreateBoneTransformMatrices( ctx, &ctx->worldtransform ) )
 			return;
 
-		FillWorldTransformMatrices();
+		FillWorldTransformMatrices( ctx );
 	}
 
-	bodypart = (mstudiobodyparts_t *)( (byte *)model_hdr + model_hdr->bodypartindex );
+	bodypart = (mstudiobodyparts_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->bodypartindex );
 
-	for( i = 0; i < model_hdr->numbodyparts; ++i, ++bodypart )
+	for( i = 0; i < ctx->model_hdr->numbodyparts; ++i, ++bodypart )
 	{
-		model = (mstudiomodel_t *)( (byte *)model_hdr + bodypart->modelindex );
+		model = (mstudiomodel_t *)( (byte *)ctx->model_hdr + bodypart->modelindex );
 
 		for( j = 0; j < bodypart->nummodels; ++j, ++model )
 		{
 			if( !Q_strncmp( model->name, "blank", 5 ) )
 				continue;
 
-			len = Q_snprintf( filename, MAX_SYSPATH, "%s%s.smd", destdir, model->name );
+			len = Q_snprintf( filename, MAX_SYSPATH, "%s%s.smd", ctx->destdir, model->name );
 
 			if( len == -1 )
 			{
@@ -561,9 +558,9 @@ static void WriteReferences( void )
 
 			fputs( "version 1\n", fp );
 
-			WriteNodes( fp );
-			WriteSkeleton( fp );
-			WriteTriangles( fp, model );
+			WriteNodes( ctx, fp );
+			WriteSkeleton( ctx, fp );
+			WriteTriangles( ctx, fp, model );
 
 			fclose( fp );
 
@@ -572,10 +569,10 @@ static void WriteReferences( void )
 	}
 
 _fail:
-	RemoveBoneTransformMatrices( &bonetransform );
+	RemoveBoneTransformMatrices( &ctx->bonetransform );
 
-	if( model_hdr->flags & STUDIO_HAS_BONEINFO )
-		RemoveBoneTransformMatrices( &worldtransform );
+	if( ctx->model_hdr->flags & STUDIO_HAS_BONEINFO )
+		RemoveBoneTransformMatrices( &ctx->worldtransform );
 }
 
 /*
@@ -583,15 +580,15 @@ static void WriteReferences( void )
 WriteSequences
 ============
 */
-static void WriteSequences( void )
+static void WriteSequences( mdldec_t *ctx )
 {
 	int			 i, j;
 	int			 len, namelen, emptyplace;
 	FILE			*fp;
 	char			 path[MAX_SYSPATH];
-	mstudioseqdesc_t	*seqdesc = (mstudioseqdesc_t *)( (byte *)model_hdr + model_hdr->seqindex );
+	mstudioseqdesc_t	*seqdesc = (mstudioseqdesc_t *)( (byte *)ctx->model_hdr + ctx->model_hdr->seqindex );
 
-	len = Q_snprintf( path, MAX_SYSPATH, ( globalsettings & SETTINGS_SEPARATEANIMSFOLDER ) ? "%s" SEQUENCEPATH : "%s", destdir );
+	len = Q_snprintf( path, MAX_SYSPATH, ( globalsettings & SETTINGS_SEPARATEANIMSFOLDER ) ? "%s" SEQUENCEPATH : "%s", ctx->destdir );
 
 	if( len == -1 || !MakeDirectory( path ))
 	{
@@ -601,7 +598,7 @@ static void WriteSequences( void )
 
 	emptyplace = MAX_SYSPATH - len;
 
-	for( i = 0; i < model_hdr->numseq; ++i, ++seqdesc )
+	for( i = 0; i < ctx->model_hdr->numseq; ++i, ++seqdesc )
 	{
 		for( j = 0; j < seqdesc->numblends; j++ )
 		{
@@ -626,8 +623,8 @@ static void WriteSequences( void )
 
 			fputs( "version 1\n", fp );
 
-			WriteNodes( fp );
-			WriteAnimations( fp, seqdesc, j );
+			WriteNodes( ctx, fp );
+			WriteAnimations( ctx, fp, seqdesc, j );
 
 			fclose( fp );
 
@@ -636,9 +633,9 @@ static void WriteSequences( void )
 	}
 }
 
-void WriteSMD( void )
+void WriteSMD( mdldec_t *ctx )
 {
-	WriteReferences();
-	WriteSequences();
+	WriteReferences( ctx );
+	WriteSequences( ctx );
 }
 
@@ -18,7 +18,7 @@ GNU General Public License for more details.
 
 #define SEQUENCEPATH	"anims/"
 
-void	WriteSMD( void );
+void	WriteSMD( mdldec_t *ctx );
 
 #endif // SMD_H
 
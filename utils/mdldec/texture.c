@@ -31,7 +31,7 @@ GNU General Public License for more details.
 WriteBMP
 ============
 */
-static void WriteBMP( FILE *fp, mstudiotexture_t *texture )
+static void WriteBMP( mdldec_t *ctx, FILE *fp, mstudiotexture_t *texture )
 {
 	int		 i;
 	const byte	*p;
@@ -52,7 +52,7 @@ static void WriteBMP( FILE *fp, mstudiotexture_t *texture )
 	bmp_hdr.bitmapDataOffset = sizeof( bmp_hdr ) + sizeof( rgba_palette );
 	bmp_hdr.bitmapHeaderSize = BI_SIZE;
 
-	pic = (byte *)texture_hdr + texture->index;
+	pic = (byte *)ctx->texture_hdr + texture->index;
 	palette = pic + bmp_hdr.bitmapDataSize;
 
 	fwrite( &bmp_hdr, sizeof( bmp_hdr ), 1, fp );
@@ -84,7 +84,7 @@ static void WriteBMP( FILE *fp, mstudiotexture_t *texture )
 WriteTGA
 ============
 */
-static void WriteTGA( FILE *fp, mstudiotexture_t *texture )
+static void WriteTGA( mdldec_t *ctx, FILE *fp, mstudiotexture_t *texture )
 {
 	int              i;
 	const byte      *p;
@@ -99,7 +99,7 @@ static void WriteTGA( FILE *fp, mstudiotexture_t *texture )
 	tga_hdr.width = texture->width;
 	tga_hdr.height = texture->height;
 
-	pic = (byte *)texture_hdr + texture->index;
+	pic = (byte *)ctx->texture_hdr + texture->index;
 	palette = pic + tga_hdr.width * tga_hdr.height;
 
 	fwrite( &tga_hdr, sizeof( tga_hdr ), 1, fp );
@@ -130,14 +130,14 @@ static void WriteTGA( FILE *fp, mstudiotexture_t *texture )
 WriteTextures
 ============
 */
-void WriteTextures( void )
+void WriteTextures( mdldec_t *ctx )
 {
 	int			 i, len, namelen, emptyplace;
 	FILE			*fp;
-	mstudiotexture_t	*texture = (mstudiotexture_t *)( (byte *)texture_hdr + texture_hdr->textureindex );
+	mstudiotexture_t	*texture = (mstudiotexture_t *)( (byte *)ctx->texture_hdr + ctx->texture_hdr->textureindex );
 	char			 path[MAX_SYSPATH];
 
-	len = Q_snprintf( path, MAX_SYSPATH, ( globalsettings & SETTINGS_SEPARATETEXTURESFOLDER ) ? "%s" TEXTUREPATH : "%s", destdir );
+	len = Q_snprintf( path, MAX_SYSPATH, ( globalsettings & SETTINGS_SEPARATETEXTURESFOLDER ) ? "%s" TEXTUREPATH : "%s", ctx->destdir );
 
 	if( len == -1 || !MakeDirectory( path ))
 	{
@@ -147,7 +147,7 @@ void WriteTextures( void )
 
 	emptyplace = MAX_SYSPATH - len;
 
-	for( i = 0; i < texture_hdr->numtextures; ++i, ++texture )
+	for( i = 0; i < ctx->texture_hdr->numtextures; ++i, ++texture )
 	{
 		namelen = Q_strncpy( &path[len], texture->name, emptyplace );
 
@@ -169,9 +169,9 @@ void WriteTextures( void )
 		if( texture->name[0] == '#' ) texture->name[0] = 's';
 
 		if( !Q_stricmp( COM_FileExtension( texture->name ), "tga" ))
-			WriteTGA( fp, texture );
+			WriteTGA( ctx, fp, texture );
 		else
-			WriteBMP( fp, texture );
+			WriteBMP( ctx, fp, texture );
 
 		fclose( fp );
 
@@ -18,7 +18,7 @@ GNU General Public License for more details.
 
 #define TEXTUREPATH	"textures/"
 
-void	WriteTextures( void );
+void	WriteTextures( mdldec_t *ctx );
 
 #endif // TEXTURE_H
 
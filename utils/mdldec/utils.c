@@ -20,10 +20,17 @@ GNU General Public License for more details.
 #include <errno.h>
 #include "xash3d_types.h"
 #include "port.h"
+#if !XASH_WIN32
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 #include "crtlib.h"
 #include "settings.h"
 #include "utils.h"
 
+static THREAD_LOCAL logbuffer_t	*logbuffer;
+
 /*
 ============
 MakeDirectory
@@ -156,6 +163,53 @@ byte *LoadFile( const char *filename, off_t *size )
 	return buf;
 }
 
+/*
+============
+LogOutput
+============
+*/
+static void LogOutput( const char *str )
+{
+	if( Q_strncmp( str, "ERROR:", sizeof( "ERROR:" ) - 1 ))
+		puts( str );
+	else fprintf( stderr, "%s\n", str );
+}
+
+/*
+============
+LogAppend
+
+Store a line in the buffer of the calling thread.
+============
+*/
+static void LogAppend( logbuffer_t *buf, const char *str )
+{
+	size_t	 len = Q_strlen( str ) + 1;
+	size_t	 size;
+	char	*data;
+
+	if( buf->len + len + 1 > buf->size )
+	{
+		size = buf->size ? buf->size * 2 : 4096;
+
+		while( size < buf->len + len + 1 )
+			size *= 2;
+
+		data = realloc( buf->data, size );
+
+		if( !data )
+			return;
+
+		buf->data = data;
+		buf->size = size;
+	}
+
+	memcpy( &buf->data[buf->len], str, len - 1 );
+	buf->data[buf->len + len - 1] = '\n';
+	buf->len += len;
+	buf->data[buf->len] = '\0';
+}
+
 /*
 ============
 LogPutS
@@ -166,9 +220,9 @@ void LogPutS( const char *str )
 	if( ( globalsettings & SETTINGS_NOLOGS ))
 		return;
 
-	if( Q_strncmp( str, "ERROR:", sizeof( "ERROR:" ) - 1 ))
-		puts( str );
-	else fprintf( stderr, "%s\n", str );
+	if( logbuffer )
+		LogAppend( logbuffer, str );
+	else LogOutput( str );
 }
 
 /*
@@ -179,7 +233,7 @@ LogPrintf
 void LogPrintf( const char *szFmt, ... )
 {
 	va_list args;
-	static char buffer[2048];
+	char buffer[2048];
 
 	if( ( globalsettings & SETTINGS_NOLOGS ))
 		return;
@@ -188,8 +242,177 @@ void LogPrintf( const char *szFmt, ... )
         Q_vsnprintf( buffer, sizeof( buffer ), szFmt, args );
 	va_end( args );
 
-	if( Q_strncmp( buffer, "ERROR:", sizeof( "ERROR:" ) - 1 ))
-		puts( buffer );
-	else fprintf( stderr, "%s\n", buffer );
+	if( logbuffer )
+		LogAppend( logbuffer, buffer );
+	else LogOutput( buffer );
 }
 
+/*
+============
+LogSetBuffer
+
+Redirect logs of the calling thread into buf, NULL restores direct output.
+============
+*/
+void LogSetBuffer( logbuffer_t *buf )
+{
+	logbuffer = buf;
+}
+
+/*
+============
+LogFlushBuffer
+
+Print everything collected in buf and release it.
+Caller is responsible for serializing flushes.
+============
+*/
+void LogFlushBuffer( logbuffer_t *buf )
+{
+	char	*line, *end;
+
+	if( buf->data )
+	{
+		for( line = buf->data; *line; line = end + 1 )
+		{
+			end = Q_strchr( line, '\n' );
+			*end = '\0';
+			LogOutput( line );
+		}
+
+		free( buf->data );
+	}
+
+	memset( buf, 0, sizeof( *buf ));
+}
+
+/*
+============
+IsDirectory
+============
+*/
+qboolean IsDirectory( const char *path )
+{
+#if XASH_WIN32
+	DWORD	dwFlags = GetFileAttributes( path );
+
+	return ( dwFlags != INVALID_FILE_ATTRIBUTES ) && ( dwFlags & FILE_ATTRIBUTE_DIRECTORY );
+#else
+	struct stat	buf;
+
+	return !stat( path, &buf ) && S_ISDIR( buf.st_mode );
+#endif
+}
+
+/*
+============
+ListDirectory
+
+Recursively call callback for every regular file under path.
+============
+*/
+qboolean ListDirectory( const char *path, listcallback_t callback, void *userdata )
+{
+	char	filename[MAX_SYSPATH];
+#if XASH_WIN32
+	WIN32_FIND_DATA	 data;
+	HANDLE		 handle;
+
+	if( Q_snprintf( filename, sizeof( filename ), "%s/*", path ) == -1 )
+		return false;
+
+	handle = FindFirstFile( filename, &data );
+
+	if( handle == INVALID_HANDLE_VALUE )
+		return false;
+
+	do
+	{
+		if( data.cFileName[0] == '.' )
+			continue;
+
+		if( Q_snprintf( filename, sizeof( filename ), "%s/%s", path, data.cFileName ) == -1 )
+			continue;
+
+		if( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+			ListDirectory( filename, callback, userdata );
+		else callback( filename, userdata );
+	} while( FindNextFile( handle, &data ));
+
+	FindClose( handle );
+#else
+	DIR		*dir;
+	struct dirent	*entry;
+
+	dir = opendir( path );
+
+	if( !dir )
+		return false;
+
+	while(( entry = readdir( dir )))
+	{
+		if( entry->d_name[0] == '.' )
+			continue;
+
+		if( Q_snprintf( filename, sizeof( filename ), "%s/%s", path, entry->d_name ) == -1 )
+			continue;
+
+		if( IsDirectory( filename ))
+			ListDirectory( filename, callback, userdata );
+		else callback( filename, userdata );
+	}
+
+	closedir( dir );
+#endif
+	return true;
+}
+
+/*
+============
+GetTimeSeconds
+
+Monotonic time, only differences are meaningful.
+============
+*/
+double GetTimeSeconds( void )
+{
+#if XASH_WIN32
+	static LARGE_INTEGER	freq;
+	LARGE_INTEGER		count;
+
+	if( !freq.QuadPart )
+		QueryPerformanceFrequency( &freq );
+
+	QueryPerformanceCounter( &count );
+
+	return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+	struct timespec	ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+/*
+============
+GetProcessorCount
+============
+*/
+int GetProcessorCount( void )
+{
+#if XASH_WIN32
+	SYSTEM_INFO	info;
+
+	GetSystemInfo( &info );
+
+	return info.dwNumberOfProcessors;
+#elif defined( _SC_NPROCESSORS_ONLN )
+	long	count = sysconf( _SC_NPROCESSORS_ONLN );
+
+	return count > 0 ? (int)count : 1;
+#else
+	return 1;
+#endif
+}
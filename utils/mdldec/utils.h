@@ -16,6 +16,22 @@ GNU General Public License for more details.
 #ifndef	UTILS_H
 #define UTILS_H
 
+#if defined( _MSC_VER )
+#define THREAD_LOCAL	__declspec( thread )
+#else
+#define THREAD_LOCAL	__thread
+#endif
+
+// collects log lines of a thread until flushed, so parallel jobs don't interleave
+typedef struct logbuffer_s
+{
+	char	*data;
+	size_t	 len;
+	size_t	 size;
+} logbuffer_t;
+
+typedef void (*listcallback_t)( const char *path, void *userdata );
+
 qboolean	 MakeDirectory( const char *path );
 qboolean	 MakeFullPath( const char *path );
 void		 ExtractFileName( char *name, size_t size );
@@ -23,6 +39,12 @@ off_t		 GetSizeOfFile( FILE *fp );
 byte		*LoadFile( const char *filename, off_t *size );
 void		 LogPutS( const char *str );
 void		 LogPrintf( const char *szFmt, ... );
+void		 LogSetBuffer( logbuffer_t *buf );
+void		 LogFlushBuffer( logbuffer_t *buf );
+qboolean	 IsDirectory( const char *path );
+qboolean	 ListDirectory( const char *path, listcallback_t callback, void *userdata );
+double		 GetTimeSeconds( void );
+int		 GetProcessorCount( void );
 
 #endif // UTILS_H
 